@@ -0,0 +1,463 @@
+/*
+ * This file is part of the Black Magic Debug project.
+ *
+ * Copyright (C) 2026 1BitSquared <info@1bitsquared.com>
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived from
+ *    this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/*
+ * This file implements an evaluator for GDB's agent expression bytecode, as described in
+ * the "Agent Expressions" appendix of "Debugging with GDB". This lets breakpoint conditions
+ * be checked on the probe when the target halts, rather than GDB having to be told about
+ * every hit only to have it resume the target again straight away, and tracepoint actions
+ * to collect the values they need without stopping the target for GDB.
+ *
+ * Values on the stack are 64-bit regardless of the target, as GDB expects.
+ * The floating point, trace state variable and printf operations are not supported.
+ */
+
+#include "general.h"
+#include "agent_expr.h"
+#include "hex_utils.h"
+
+#include <stdlib.h>
+
+/* How many operations an expression may run before it is assumed to be stuck in a loop */
+#define AGENT_EXPR_MAX_STEPS 4096U
+
+typedef enum agent_expr_op {
+	AX_OP_ADD = 0x02U,
+	AX_OP_SUB = 0x03U,
+	AX_OP_MUL = 0x04U,
+	AX_OP_DIV_SIGNED = 0x05U,
+	AX_OP_DIV_UNSIGNED = 0x06U,
+	AX_OP_REM_SIGNED = 0x07U,
+	AX_OP_REM_UNSIGNED = 0x08U,
+	AX_OP_LSH = 0x09U,
+	AX_OP_RSH_SIGNED = 0x0aU,
+	AX_OP_RSH_UNSIGNED = 0x0bU,
+	AX_OP_TRACE = 0x0cU,
+	AX_OP_TRACE_QUICK = 0x0dU,
+	AX_OP_LOG_NOT = 0x0eU,
+	AX_OP_BIT_AND = 0x0fU,
+	AX_OP_BIT_OR = 0x10U,
+	AX_OP_BIT_XOR = 0x11U,
+	AX_OP_BIT_NOT = 0x12U,
+	AX_OP_EQUAL = 0x13U,
+	AX_OP_LESS_SIGNED = 0x14U,
+	AX_OP_LESS_UNSIGNED = 0x15U,
+	AX_OP_EXT = 0x16U,
+	AX_OP_REF8 = 0x17U,
+	AX_OP_REF16 = 0x18U,
+	AX_OP_REF32 = 0x19U,
+	AX_OP_REF64 = 0x1aU,
+	AX_OP_IF_GOTO = 0x20U,
+	AX_OP_GOTO = 0x21U,
+	AX_OP_CONST8 = 0x22U,
+	AX_OP_CONST16 = 0x23U,
+	AX_OP_CONST32 = 0x24U,
+	AX_OP_CONST64 = 0x25U,
+	AX_OP_REG = 0x26U,
+	AX_OP_END = 0x27U,
+	AX_OP_DUP = 0x28U,
+	AX_OP_POP = 0x29U,
+	AX_OP_ZERO_EXT = 0x2aU,
+	AX_OP_SWAP = 0x2bU,
+	AX_OP_TRACEV = 0x2eU,
+	AX_OP_TRACENZ = 0x2fU,
+	AX_OP_TRACE16 = 0x30U,
+	AX_OP_PICK = 0x32U,
+	AX_OP_ROT = 0x33U,
+} agent_expr_op_e;
+
+typedef struct agent_expr_state {
+	target_s *target;
+	const agent_expr_s *expr;
+	agent_expr_collect_f collect;
+	void *context;
+	size_t pc;
+	size_t depth;
+	uint64_t stack[AGENT_EXPR_STACK_DEPTH];
+} agent_expr_state_s;
+
+agent_expr_s *agent_expr_parse(const char *const input, const char **const rest)
+{
+	uint32_t length = 0U;
+	const char *bytecode = NULL;
+	if (!read_hex32(input, &bytecode, &length, ',') || !length || length > AGENT_EXPR_MAX_LENGTH)
+		return NULL;
+	for (size_t idx = 0U; idx < length * 2U; ++idx) {
+		if (!is_hex(bytecode[idx]))
+			return NULL;
+	}
+
+	agent_expr_s *const expr = malloc(sizeof(*expr) + length);
+	if (!expr) { /* malloc failed: heap exhaustion */
+		DEBUG_ERROR("malloc: failed in %s\n", __func__);
+		return NULL;
+	}
+	expr->next = NULL;
+	expr->length = length;
+	unhexify(expr->bytecode, bytecode, length);
+	if (rest)
+		*rest = bytecode + (length * 2U);
+	return expr;
+}
+
+void agent_expr_free(agent_expr_s *expr)
+{
+	while (expr) {
+		agent_expr_s *const next = expr->next;
+		free(expr);
+		expr = next;
+	}
+}
+
+/* Fetch an operand of the given width from the bytecode - these are big endian, whatever the target */
+static bool agent_expr_operand(agent_expr_state_s *const state, const size_t width, uint64_t *const value)
+{
+	if (state->pc + width > state->expr->length)
+		return false;
+	*value = 0U;
+	for (size_t idx = 0U; idx < width; ++idx)
+		*value = (*value << 8U) | state->expr->bytecode[state->pc++];
+	return true;
+}
+
+static bool agent_expr_push(agent_expr_state_s *const state, const uint64_t value)
+{
+	if (state->depth == AGENT_EXPR_STACK_DEPTH)
+		return false;
+	state->stack[state->depth++] = value;
+	return true;
+}
+
+/* Read a value of the given width from target memory, as the target would see it */
+static bool agent_expr_mem_read(target_s *const target, const uint64_t addr, const size_t width, uint64_t *const value)
+{
+	uint8_t data[8U];
+	if (target_mem32_read_cached(target, data, (target_addr_t)addr, width))
+		return false;
+	*value = 0U;
+	for (size_t idx = width; idx > 0U; --idx)
+		*value = (*value << 8U) | data[idx - 1U];
+	return true;
+}
+
+static bool agent_expr_reg_read(target_s *const target, const uint32_t reg, uint64_t *const value)
+{
+	uint8_t data[8U];
+	const size_t width = target_reg_read(target, reg, data, sizeof(data));
+	if (!width)
+		return false;
+	*value = 0U;
+	for (size_t idx = width; idx > 0U; --idx)
+		*value = (*value << 8U) | data[idx - 1U];
+	return true;
+}
+
+/* How much of a nul terminated string to collect for tracenz, including the terminator if it's found in time */
+static size_t agent_expr_string_length(target_s *const target, const uint64_t addr, const size_t max)
+{
+	for (size_t offset = 0U; offset < max; ++offset) {
+		uint8_t value = 0U;
+		if (target_mem32_read_cached(target, &value, (target_addr_t)(addr + offset), 1U))
+			return offset;
+		if (!value)
+			return offset + 1U;
+	}
+	return max;
+}
+
+/* Sign extend the bottom bits of a value out to the full 64 bits of a stack entry */
+static uint64_t agent_expr_sign_extend(const uint64_t value, const uint64_t bits)
+{
+	if (!bits || bits >= 64U)
+		return value;
+	const uint64_t sign = UINT64_C(1) << (bits - 1U);
+	const uint64_t mask = (sign << 1U) - 1U;
+	return ((value & mask) ^ sign) - sign;
+}
+
+/* Run a single operation that takes two values off the stack and pushes a result back */
+static bool agent_expr_binary_op(agent_expr_state_s *const state, const uint8_t op)
+{
+	if (state->depth < 2U)
+		return false;
+	const uint64_t b = state->stack[--state->depth];
+	const uint64_t a = state->stack[state->depth - 1U];
+	uint64_t *const result = &state->stack[state->depth - 1U];
+
+	switch (op) {
+	case AX_OP_ADD:
+		*result = a + b;
+		break;
+	case AX_OP_SUB:
+		*result = a - b;
+		break;
+	case AX_OP_MUL:
+		*result = a * b;
+		break;
+	case AX_OP_DIV_SIGNED:
+	case AX_OP_REM_SIGNED:
+		/* Division by zero is an error, as is the one signed division that overflows */
+		if (!b || ((int64_t)a == INT64_MIN && (int64_t)b == -1))
+			return false;
+		*result = op == AX_OP_DIV_SIGNED ? (uint64_t)((int64_t)a / (int64_t)b) : (uint64_t)((int64_t)a % (int64_t)b);
+		break;
+	case AX_OP_DIV_UNSIGNED:
+	case AX_OP_REM_UNSIGNED:
+		if (!b)
+			return false;
+		*result = op == AX_OP_DIV_UNSIGNED ? a / b : a % b;
+		break;
+	case AX_OP_LSH:
+		*result = b < 64U ? a << b : 0U;
+		break;
+	case AX_OP_RSH_SIGNED:
+		*result = (uint64_t)((int64_t)a >> MIN(b, 63U));
+		break;
+	case AX_OP_RSH_UNSIGNED:
+		*result = b < 64U ? a >> b : 0U;
+		break;
+	case AX_OP_BIT_AND:
+		*result = a & b;
+		break;
+	case AX_OP_BIT_OR:
+		*result = a | b;
+		break;
+	case AX_OP_BIT_XOR:
+		*result = a ^ b;
+		break;
+	case AX_OP_EQUAL:
+		*result = a == b;
+		break;
+	case AX_OP_LESS_SIGNED:
+		*result = (int64_t)a < (int64_t)b;
+		break;
+	case AX_OP_LESS_UNSIGNED:
+		*result = a < b;
+		break;
+	default:
+		return false;
+	}
+	return true;
+}
+
+/* Run the operation at the current position in the expression, returns false on error */
+static bool agent_expr_step(agent_expr_state_s *const state, const uint8_t op)
+{
+	uint64_t *const top = state->depth ? &state->stack[state->depth - 1U] : NULL;
+	uint64_t operand = 0U;
+
+	switch (op) {
+	case AX_OP_ADD:
+	case AX_OP_SUB:
+	case AX_OP_MUL:
+	case AX_OP_DIV_SIGNED:
+	case AX_OP_DIV_UNSIGNED:
+	case AX_OP_REM_SIGNED:
+	case AX_OP_REM_UNSIGNED:
+	case AX_OP_LSH:
+	case AX_OP_RSH_SIGNED:
+	case AX_OP_RSH_UNSIGNED:
+	case AX_OP_BIT_AND:
+	case AX_OP_BIT_OR:
+	case AX_OP_BIT_XOR:
+	case AX_OP_EQUAL:
+	case AX_OP_LESS_SIGNED:
+	case AX_OP_LESS_UNSIGNED:
+		return agent_expr_binary_op(state, op);
+
+	case AX_OP_LOG_NOT:
+		if (!top)
+			return false;
+		*top = !*top;
+		return true;
+	case AX_OP_BIT_NOT:
+		if (!top)
+			return false;
+		*top = ~*top;
+		return true;
+	case AX_OP_EXT:
+	case AX_OP_ZERO_EXT:
+		if (!top || !agent_expr_operand(state, 1U, &operand))
+			return false;
+		if (op == AX_OP_EXT)
+			*top = agent_expr_sign_extend(*top, operand);
+		else if (operand < 64U)
+			*top &= (UINT64_C(1) << operand) - 1U;
+		return true;
+
+	case AX_OP_REF8:
+	case AX_OP_REF16:
+	case AX_OP_REF32:
+	case AX_OP_REF64:
+		/* Each of these reads twice the width of the one before, starting from a byte */
+		if (!top)
+			return false;
+		return agent_expr_mem_read(state->target, *top, 1U << (op - AX_OP_REF8), top);
+
+	case AX_OP_IF_GOTO:
+	case AX_OP_GOTO: {
+		if (!agent_expr_operand(state, 2U, &operand))
+			return false;
+		bool jump = true;
+		if (op == AX_OP_IF_GOTO) {
+			if (!top)
+				return false;
+			jump = *top != 0U;
+			--state->depth;
+		}
+		if (jump) {
+			if (operand >= state->expr->length)
+				return false;
+			state->pc = operand;
+		}
+		return true;
+	}
+
+	case AX_OP_CONST8:
+	case AX_OP_CONST16:
+	case AX_OP_CONST32:
+	case AX_OP_CONST64:
+		return agent_expr_operand(state, 1U << (op - AX_OP_CONST8), &operand) && agent_expr_push(state, operand);
+
+	case AX_OP_REG: {
+		uint64_t value = 0U;
+		return agent_expr_operand(state, 2U, &operand) &&
+			agent_expr_reg_read(state->target, (uint32_t)operand, &value) && agent_expr_push(state, value);
+	}
+
+	case AX_OP_DUP:
+		return top && agent_expr_push(state, *top);
+	case AX_OP_POP:
+		if (!top)
+			return false;
+		--state->depth;
+		return true;
+	case AX_OP_SWAP: {
+		if (state->depth < 2U)
+			return false;
+		const uint64_t b = *top;
+		*top = state->stack[state->depth - 2U];
+		state->stack[state->depth - 2U] = b;
+		return true;
+	}
+	case AX_OP_PICK:
+		if (!agent_expr_operand(state, 1U, &operand) || operand >= state->depth)
+			return false;
+		return agent_expr_push(state, state->stack[state->depth - 1U - operand]);
+	case AX_OP_ROT: {
+		/* a b c => c a b */
+		if (state->depth < 3U)
+			return false;
+		uint64_t *const stack = &state->stack[state->depth - 3U];
+		const uint64_t c = stack[2];
+		stack[2] = stack[1];
+		stack[1] = stack[0];
+		stack[0] = c;
+		return true;
+	}
+
+	/*
+	 * The trace operations only mean something to a tracepoint collecting data, when evaluating
+	 * a condition they leave the stack as they would have, but otherwise do nothing
+	 */
+	case AX_OP_TRACE:
+	case AX_OP_TRACENZ: {
+		/* addr size => */
+		if (state->depth < 2U)
+			return false;
+		state->depth -= 2U;
+		const uint64_t addr = state->stack[state->depth];
+		size_t size = (size_t)state->stack[state->depth + 1U];
+		if (op == AX_OP_TRACENZ)
+			size = agent_expr_string_length(state->target, addr, size);
+		return !state->collect || state->collect(state->context, addr, size);
+	}
+	case AX_OP_TRACE_QUICK:
+	case AX_OP_TRACE16:
+		/* addr => addr */
+		if (!top || !agent_expr_operand(state, op == AX_OP_TRACE_QUICK ? 1U : 2U, &operand))
+			return false;
+		return !state->collect || state->collect(state->context, *top, (size_t)operand);
+	case AX_OP_TRACEV:
+		/* Trace state variables aren't supported, so there's nothing to record */
+		return agent_expr_operand(state, 2U, &operand);
+
+	default:
+		DEBUG_WARN("Unsupported agent expression operation %02x\n", op);
+		return false;
+	}
+}
+
+/* Run the expression through to its end operation, returns false if it fails along the way */
+static bool agent_expr_run(agent_expr_state_s *const state)
+{
+	for (size_t steps = 0U; steps < AGENT_EXPR_MAX_STEPS && state->pc < state->expr->length; ++steps) {
+		const uint8_t op = state->expr->bytecode[state->pc++];
+		if (op == AX_OP_END)
+			return true;
+		if (!agent_expr_step(state, op))
+			return false;
+	}
+	/* Ran off the end of the expression or round in circles for too long */
+	return false;
+}
+
+bool agent_expr_eval(target_s *const target, const agent_expr_s *const expr, uint64_t *const result)
+{
+	agent_expr_state_s state = {
+		.target = target,
+		.expr = expr,
+		.collect = NULL,
+		.context = NULL,
+		.pc = 0U,
+		.depth = 0U,
+	};
+	if (!agent_expr_run(&state) || !state.depth)
+		return false;
+	*result = state.stack[state.depth - 1U];
+	return true;
+}
+
+bool agent_expr_collect(
+	target_s *const target, const agent_expr_s *const expr, const agent_expr_collect_f collect, void *const context)
+{
+	agent_expr_state_s state = {
+		.target = target,
+		.expr = expr,
+		.collect = collect,
+		.context = context,
+		.pc = 0U,
+		.depth = 0U,
+	};
+	/* Actions are run for what they collect, so unlike conditions they don't have to leave a value behind */
+	return agent_expr_run(&state);
+}
@@ -100,35 +100,206 @@ static uint32_t crc32_calc(const uint32_t crc, const uint8_t data)
 	return (crc << 8U) ^ crc32_table[((crc >> 24U) ^ data) & 0xffU];
 }
 
+#if CONFIG_BMDA == 1
+/*
+ * On the host we can afford to spend some memory to make the CRC engine fast enough that it
+ * never shows up next to the cost of reading the target, so we use slicing-by-8 as the portable
+ * engine, and where the host CPU supports it, a carry-less multiply (x86 PCLMULQDQ) or ARMv8
+ * CRC instruction based engine.
+ *
+ * Slicing-by-8 processes 8 bytes per step using 8 tables, where table n gives the CRC contribution
+ * of a byte followed by n zero bytes. Table 0 is crc32_table above, the rest are built on first use.
+ */
+static uint32_t crc32_slice_table[8][256];
+
+static void crc32_slice_table_init(void)
+{
+	for (size_t value = 0; value < 256U; ++value)
+		crc32_slice_table[0][value] = crc32_table[value];
+	for (size_t table = 1; table < 8U; ++table) {
+		for (size_t value = 0; value < 256U; ++value) {
+			const uint32_t prev = crc32_slice_table[table - 1U][value];
+			crc32_slice_table[table][value] = (prev << 8U) ^ crc32_table[prev >> 24U];
+		}
+	}
+}
+
+static uint32_t crc32_slice8(uint32_t crc, const uint8_t *data, size_t len)
+{
+	for (; len >= 8U; data += 8U, len -= 8U) {
+		crc ^= ((uint32_t)data[0] << 24U) | ((uint32_t)data[1] << 16U) | ((uint32_t)data[2] << 8U) | data[3];
+		crc = crc32_slice_table[7][crc >> 24U] ^ crc32_slice_table[6][(crc >> 16U) & 0xffU] ^
+			crc32_slice_table[5][(crc >> 8U) & 0xffU] ^ crc32_slice_table[4][crc & 0xffU] ^
+			crc32_slice_table[3][data[4]] ^ crc32_slice_table[2][data[5]] ^ crc32_slice_table[1][data[6]] ^
+			crc32_slice_table[0][data[7]];
+	}
+	for (; len; ++data, --len)
+		crc = crc32_calc(crc, *data);
+	return crc;
+}
+
+/*
+ * The hardware accelerated engines are all built for the bit-reflected form of the CRC32 polynomial
+ * (as used by Ethernet and zlib), whereas we need the MSb-first MPEG-2 form GDB uses. The two are
+ * related simply: reversing the bits of every input byte and of the CRC state going in and coming out
+ * of the reflected engine gives the MSb-first result.
+ */
+#if defined(__x86_64__) && (defined(__GNUC__) || defined(__clang__))
+#define CRC32_HAS_PCLMUL
+#include <immintrin.h>
+
+#define CRC32_PCLMUL_TARGET __attribute__((target("pclmul,ssse3,sse4.1")))
+
+static uint32_t crc32_bit_reverse(uint32_t value)
+{
+	value = ((value >> 1U) & 0x55555555U) | ((value & 0x55555555U) << 1U);
+	value = ((value >> 2U) & 0x33333333U) | ((value & 0x33333333U) << 2U);
+	value = ((value >> 4U) & 0x0f0f0f0fU) | ((value & 0x0f0f0f0fU) << 4U);
+	return __builtin_bswap32(value);
+}
+
+/* Reverse the bits in each byte of the block by looking each nibble up in a reversal table */
+CRC32_PCLMUL_TARGET static inline __m128i crc32_pclmul_load(const uint8_t *const data)
+{
+	const __m128i nibble_mask = _mm_set1_epi8(0x0f);
+	const __m128i reverse_low = _mm_setr_epi8(0x00, (char)0x80, 0x40, (char)0xc0, 0x20, (char)0xa0, 0x60,
+		(char)0xe0, 0x10, (char)0x90, 0x50, (char)0xd0, 0x30, (char)0xb0, 0x70, (char)0xf0);
+	const __m128i reverse_high =
+		_mm_setr_epi8(0x00, 0x08, 0x04, 0x0c, 0x02, 0x0a, 0x06, 0x0e, 0x01, 0x09, 0x05, 0x0d, 0x03, 0x0b, 0x07, 0x0f);
+	const __m128i block = _mm_loadu_si128((const __m128i *)data);
+	return _mm_or_si128(_mm_shuffle_epi8(reverse_low, _mm_and_si128(block, nibble_mask)),
+		_mm_shuffle_epi8(reverse_high, _mm_and_si128(_mm_srli_epi16(block, 4), nibble_mask)));
+}
+
+/*
+ * Fold 16 bytes at a time through carry-less multiplication, then reduce the 128-bit remainder
+ * down to 32 bits with Barrett reduction. The constants are the usual ones for the reflected
+ * 0x04c11db7 polynomial - x^(128+32) and x^(128-32) mod P for folding, x^64 mod P for the 64 to
+ * 32-bit step, and P and floor(x^64 / P) for the reduction.
+ */
+CRC32_PCLMUL_TARGET static uint32_t crc32_pclmul(uint32_t crc, const uint8_t *data, size_t len)
+{
+	if (len < 16U)
+		return crc32_slice8(crc, data, len);
+
+	const __m128i fold_constants = _mm_set_epi64x(0x0ccaa009eLL, 0x1751997d0LL);
+	const __m128i reduce_constant = _mm_set_epi64x(0, 0x163cd6124LL);
+	const __m128i barrett_constants = _mm_set_epi64x(0x1f7011641LL, 0x1db710641LL);
+	const __m128i mask32 = _mm_setr_epi32(-1, 0, 0, 0);
+
+	__m128i value = _mm_xor_si128(crc32_pclmul_load(data), _mm_cvtsi32_si128((int)crc32_bit_reverse(crc)));
+	data += 16U;
+	len -= 16U;
+	for (; len >= 16U; data += 16U, len -= 16U) {
+		value = _mm_xor_si128(_mm_clmulepi64_si128(value, fold_constants, 0x00),
+			_mm_xor_si128(_mm_clmulepi64_si128(value, fold_constants, 0x11), crc32_pclmul_load(data)));
+	}
+
+	/* Fold 128 bits down to 64 */
+	value = _mm_xor_si128(_mm_clmulepi64_si128(value, fold_constants, 0x10), _mm_srli_si128(value, 8));
+	/* Then 64 down to 32 */
+	value = _mm_xor_si128(
+		_mm_clmulepi64_si128(_mm_and_si128(value, mask32), reduce_constant, 0x00), _mm_srli_si128(value, 4));
+	/* And finally Barrett reduce to get the CRC state */
+	__m128i temp = _mm_clmulepi64_si128(_mm_and_si128(value, mask32), barrett_constants, 0x10);
+	temp = _mm_clmulepi64_si128(_mm_and_si128(temp, mask32), barrett_constants, 0x00);
+	crc = crc32_bit_reverse((uint32_t)_mm_extract_epi32(_mm_xor_si128(value, temp), 1));
+
+	return crc32_slice8(crc, data, len);
+}
+#endif
+
+#if defined(__aarch64__) && defined(__ARM_FEATURE_CRC32)
+#define CRC32_HAS_ARMV8
+#include <arm_acle.h>
+
+static uint32_t crc32_armv8(uint32_t crc, const uint8_t *data, size_t len)
+{
+	uint32_t state = __rbit(crc);
+	for (; len >= 8U; data += 8U, len -= 8U) {
+		uint64_t word;
+		memcpy(&word, data, sizeof(word));
+		/* Byte swapping then reversing the whole word leaves each byte in place but bit reversed */
+		state = __crc32d(state, __rbitll(__builtin_bswap64(word)));
+	}
+	for (; len; ++data, --len)
+		state = __crc32b(state, (uint8_t)(__rbit(*data) >> 24U));
+	return __rbit(state);
+}
+#endif
+
+typedef uint32_t (*crc32_engine_func)(uint32_t crc, const uint8_t *data, size_t len);
+
+static crc32_engine_func crc32_engine_select(void)
+{
+	static crc32_engine_func engine = NULL;
+	if (engine)
+		return engine;
+
+	crc32_slice_table_init();
+	engine = crc32_slice8;
+#if defined(CRC32_HAS_ARMV8)
+	/* Being built with the CRC extension enabled means every CPU we can run on has it */
+	engine = crc32_armv8;
+	DEBUG_INFO("Using ARMv8 CRC32 instructions for CRC calculation\n");
+#elif defined(CRC32_HAS_PCLMUL)
+	__builtin_cpu_init();
+	if (__builtin_cpu_supports("pclmul") && __builtin_cpu_supports("ssse3") && __builtin_cpu_supports("sse4.1")) {
+		engine = crc32_pclmul;
+		DEBUG_INFO("Using PCLMULQDQ for CRC calculation\n");
+	}
+#endif
+	return engine;
+}
+#endif
+
 static bool generic_crc32(target_s *const target, uint32_t *const result, const uint32_t base, const size_t len)
 {
 	uint32_t crc = 0xffffffffU;
 #if CONFIG_BMDA == 1
 	/*
 	 * Reading a 2 MByte on a H743 takes about 80 s@128, 28s @ 1k,
-	 * 22 s @ 4k and 21 s @ 64k
+	 * 22 s @ 4k and 21 s @ 64k. The read size is independent of how the CRC engine
+	 * consumes the data, so read in as large chunks as the link can make use of.
 	 */
-	uint8_t bytes[4096U];
+	const crc32_engine_func crc32_engine = crc32_engine_select();
+	const size_t bytes_size = 65536U;
+	uint8_t *const bytes = malloc(bytes_size);
+	if (!bytes) { /* malloc failed: heap exhaustion */
+		DEBUG_ERROR("malloc: failed in %s\n", __func__);
+		return false;
+	}
 #else
 	uint8_t bytes[128U];
+	const size_t bytes_size = sizeof(bytes);
 #endif
 
 	uint32_t last_time = platform_time_ms();
-	for (size_t offset = 0; offset < len; offset += sizeof(bytes)) {
+	for (size_t offset = 0; offset < len; offset += bytes_size) {
 		const uint32_t actual_time = platform_time_ms();
 		if (actual_time > last_time + 1000U) {
 			last_time = actual_time;
 			gdb_if_putchar(0, true);
 		}
-		const size_t read_len = MIN(sizeof(bytes), len - offset);
+		const size_t read_len = MIN(bytes_size, len - offset);
 		if (target_mem32_read(target, bytes, base + offset, (read_len + 3U) & ~3U)) {
 			DEBUG_ERROR("%s: error around address 0x%08" PRIx32 "\n", __func__, (uint32_t)(base + offset));
+#if CONFIG_BMDA == 1
+			free(bytes);
+#endif
 			return false;
 		}
 
+#if CONFIG_BMDA == 1
+		crc = crc32_engine(crc, bytes, read_len);
+#else
 		for (size_t i = 0; i < read_len; i++)
 			crc = crc32_calc(crc, bytes[i]);
+#endif
 	}
+#if CONFIG_BMDA == 1
+	free(bytes);
+#endif
 	*result = crc;
 	return true;
 }
@@ -190,14 +361,19 @@ bool bmd_crc32(target_s *const target, uint32_t *const result, const uint32_t ba
 #ifndef DEBUG_INFO_IS_NOOP
 	const uint32_t start_time = platform_time_ms();
 #endif
+	/* If the target can do the calculation itself, that beats pulling all the data over to us to do it */
+	bool status = target_mem32_crc32(target, result, base, len);
+	const char *func = "target_mem32_crc32";
+	if (!status) {
 #if !defined(STM32F0) && !defined(STM32F1) && !defined(STM32F2) && !defined(STM32F3) && !defined(STM32F4) && \
 	!defined(STM32F7) && !defined(STM32L0) && !defined(STM32L1) && !defined(STM32G0) && !defined(STM32G4)
-	const bool status = generic_crc32(target, result, base, len);
-	const char *const func = "generic_crc32";
+		status = generic_crc32(target, result, base, len);
+		func = "generic_crc32";
 #else
-	const bool status = stm32_crc32(target, result, base, len);
-	const char *const func = "stm32_crc32";
+		status = stm32_crc32(target, result, base, len);
+		func = "stm32_crc32";
 #endif
+	}
 #ifndef DEBUG_INFO_IS_NOOP
 	/* "generic_crc32: 0x08000110+75272 -> 1353ms, 54 KiB/s" */
 	/* "stm32_crc32: 0x08000110+75272 -> 237ms, 310 KiB/s" */
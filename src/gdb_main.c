@@ -40,6 +40,9 @@
 #include "command.h"
 #include "crc32.h"
 #include "morse.h"
+#include "rtos.h"
+#include "agent_expr.h"
+#include "tracepoint.h"
 #ifdef ENABLE_RTT
 #include "rtt.h"
 #endif
@@ -58,6 +61,20 @@
 #define GDB_QSUPPORTED_NOACKMODE
 #endif
 
+#ifdef ENABLE_CONDITIONAL_BREAKPOINTS
+/* Conditions on breakpoints can be evaluated here, saving GDB a round trip for every hit */
+#define GDB_QSUPPORTED_CONDITIONAL_BREAKPOINTS ";ConditionalBreakpoints+"
+#else
+#define GDB_QSUPPORTED_CONDITIONAL_BREAKPOINTS
+#endif
+
+#ifdef ENABLE_TRACEPOINTS
+/* Tracepoints can have conditions, and their actions can use the tracenz operation and resize the trace buffer */
+#define GDB_QSUPPORTED_TRACEPOINTS ";ConditionalTracepoints+;tracenz+;QTBuffer:size+"
+#else
+#define GDB_QSUPPORTED_TRACEPOINTS
+#endif
+
 #include <stdlib.h>
 
 typedef enum gdb_signal {
@@ -67,6 +84,15 @@ typedef enum gdb_signal {
 	GDB_SIGLOST = 29,
 } gdb_signal_e;
 
+/* Enough space for the expedited registers of any target in a stop reply */
+#define GDB_EXPEDITE_BUFFER_SIZE 96U
+/* Enough space for a whole stop reply, including the expedited registers */
+#define GDB_STOP_REPLY_BUFFER_SIZE (GDB_EXPEDITE_BUFFER_SIZE + 32U)
+/* Size of the replies to qfThreadInfo and qsThreadInfo */
+#define GDB_THREAD_INFO_BUFFER_SIZE 256U
+/* How long a range step may keep stepping for before letting the main loop have a look for GDB packets */
+#define GDB_RANGE_STEP_SLICE_MS 20U
+
 #define ERROR_IF_NO_TARGET()         \
 	if (!cur_target) {               \
 		gdb_put_packet_error(0xffU); \
@@ -82,17 +108,123 @@ target_s *cur_target;
 target_s *last_target;
 bool gdb_target_running = false;
 static bool gdb_needs_detach_notify = false;
+/*
+ * Whether GDB has put us in non-stop mode. In this mode resuming and halting the target are acknowledged
+ * straight away, GDB can keep talking to us while the target runs, and stops are reported asynchronously
+ * as %Stop notifications which GDB acknowledges with vStopped
+ */
+bool gdb_non_stop = false;
+/* The thread GDB has selected for register access with 'Hg', 0 meaning whichever is running */
+static uint32_t gdb_general_thread = 0U;
+/* The address range of a 'vCont;r' range step in progress, the range being empty when there isn't one */
+static target_addr_t gdb_range_step_start = 0U;
+static target_addr_t gdb_range_step_end = 0U;
+/* Whether GDB has asked for the running target to be stopped, which ends any range step in progress */
+static bool gdb_halt_requested = false;
+/* How far through the thread list qfThreadInfo/qsThreadInfo has got */
+static size_t gdb_thread_info_index = 0U;
+
+#ifdef ENABLE_CONDITIONAL_BREAKPOINTS
+/*
+ * A breakpoint GDB has given conditions for. When it is hit the conditions are evaluated here on
+ * the probe, and unless one of them is true the target is set running again without GDB ever hearing
+ * about it - saving the round trips GDB would otherwise need to check the condition itself.
+ */
+typedef struct gdb_breakpoint_cond gdb_breakpoint_cond_s;
+
+struct gdb_breakpoint_cond {
+	gdb_breakpoint_cond_s *next;
+	const target_s *target;
+	target_breakwatch_e type;
+	target_addr_t addr;
+	size_t len;
+	agent_expr_s *conditions;
+};
+
+static gdb_breakpoint_cond_s *gdb_breakpoint_conds = NULL;
+#endif
 
 static void handle_q_packet(const gdb_packet_s *packet);
 static void handle_v_packet(const gdb_packet_s *packet);
 static void handle_z_packet(const gdb_packet_s *packet);
 static void handle_kill_target(void);
+static void gdb_report_halt_reason(void);
+#ifdef ENABLE_CONDITIONAL_BREAKPOINTS
+static void gdb_breakpoint_conds_drop(const target_s *target);
+#endif
+
+/* Whether GDB has selected an RTOS thread other than the running one for register access */
+static bool gdb_thread_switched_out(void)
+{
+	return gdb_general_thread && gdb_general_thread != rtos_current_thread(cur_target);
+}
+
+/*
+ * Read target memory on GDB's behalf. While the target is halted this goes via the target memory cache,
+ * but if the target is running (and allows memory access while doing so) the memory is live and must be read directly
+ */
+static bool gdb_mem_read(void *const dest, const target_addr_t src, const size_t len)
+{
+	/* While GDB is looking at a trace frame, memory is what was collected in it */
+	if (tracepoint_frame_selected())
+		return tracepoint_frame_mem_read(cur_target, dest, src, len);
+	if (gdb_target_running)
+		return target_mem32_read(cur_target, dest, src, len);
+	return target_mem32_read_cached(cur_target, dest, src, len);
+}
+
+#if CONFIG_BMDA == 1
+/*
+ * In multi-target server mode every target gets a GDB session of its own. Each session's state lives
+ * here while another session is being serviced, and is swapped in to the globals above when it is its turn.
+ * The controller must be the first member so the target callbacks can get back to the session it belongs to
+ */
+typedef struct gdb_session {
+	target_controller_s controller;
+	target_s *cur_target;
+	target_s *last_target;
+	bool target_running;
+	bool needs_detach_notify;
+	bool noackmode;
+	bool non_stop;
+	uint32_t general_thread;
+	target_addr_t range_step_start;
+	target_addr_t range_step_end;
+	bool halt_requested;
+} gdb_session_s;
+
+static gdb_session_s *gdb_sessions = NULL;
+static size_t gdb_sessions_count = 0U;
+static gdb_session_s *gdb_session = NULL;
+#endif
 
 static void gdb_target_destroy_callback(target_controller_s *tc, target_s *t)
 {
+#if CONFIG_BMDA == 1
+	/* If the target belongs to a session that's not the active one, update that session's saved state */
+	if (gdb_session && tc != &gdb_session->controller) {
+		gdb_session_s *const session = (gdb_session_s *)tc;
+		if (session->cur_target == t) {
+			session->cur_target = NULL;
+			session->target_running = false;
+			session->needs_detach_notify = true;
+		}
+		if (session->last_target == t)
+			session->last_target = NULL;
+#ifdef ENABLE_RTOS
+		rtos_target_destroyed(t);
+#endif
+#ifdef ENABLE_CONDITIONAL_BREAKPOINTS
+		gdb_breakpoint_conds_drop(t);
+#endif
+		tracepoint_target_destroyed(t);
+		return;
+	}
+#else
 	(void)tc;
+#endif
 	if (cur_target == t) {
-		gdb_put_notification_str("%Stop:W00");
+		gdb_put_notification_str("Stop:W00");
 		gdb_out("You are now detached from the previous target.\n");
 		cur_target = NULL;
 		gdb_needs_detach_notify = true;
@@ -100,6 +232,26 @@ static void gdb_target_destroy_callback(target_controller_s *tc, target_s *t)
 
 	if (last_target == t)
 		last_target = NULL;
+#ifdef ENABLE_RTOS
+	rtos_target_destroyed(t);
+#endif
+#ifdef ENABLE_CONDITIONAL_BREAKPOINTS
+	gdb_breakpoint_conds_drop(t);
+#endif
+	tracepoint_target_destroyed(t);
+}
+
+void gdb_forget_targets(void)
+{
+	/*
+	 * Targets that are not attached have no controller to get the destroy callback through,
+	 * so the targets remembered for reattaching have to be cleared here instead
+	 */
+	last_target = NULL;
+#if CONFIG_BMDA == 1
+	for (size_t idx = 0U; idx < gdb_sessions_count; ++idx)
+		gdb_sessions[idx].last_target = NULL;
+#endif
 }
 
 static void gdb_target_printf(target_controller_s *tc, const char *fmt, va_list ap)
@@ -113,6 +265,16 @@ target_controller_s gdb_controller = {
 	.printf = gdb_target_printf,
 };
 
+/* The controller to attach targets with - that of the active session if there is one */
+static target_controller_s *gdb_active_controller(void)
+{
+#if CONFIG_BMDA == 1
+	if (gdb_session)
+		return &gdb_session->controller;
+#endif
+	return &gdb_controller;
+}
+
 /* execute gdb remote command stored in 'pbuf'. returns immediately, no busy waiting. */
 int32_t gdb_main_loop(target_controller_s *const tc, const gdb_packet_s *const packet, const bool in_syscall)
 {
@@ -125,9 +287,15 @@ int32_t gdb_main_loop(target_controller_s *const tc, const gdb_packet_s *const p
 	case 'g': { /* 'g': Read general registers */
 		ERROR_IF_NO_TARGET();
 		const size_t reg_size = target_regs_size(cur_target);
-		if (reg_size) {
+		if (reg_size && tracepoint_frame_selected()) {
+			char *const hex = alloca((reg_size * 2U) + 1U);
+			tracepoint_frame_regs_read(cur_target, hex);
+			gdb_put_packet_str(hex);
+		} else if (reg_size) {
 			uint8_t *gp_regs = alloca(reg_size);
-			target_regs_read(cur_target, gp_regs);
+			/* Threads switched out by an RTOS have their registers on their stacks, the rest are the CPU's */
+			if (!gdb_general_thread || !rtos_thread_regs_read(cur_target, gdb_general_thread, gp_regs))
+				target_regs_read(cur_target, gp_regs);
 			gdb_put_packet_hex(gp_regs, reg_size);
 		} else {
 			/**
@@ -145,13 +313,14 @@ int32_t gdb_main_loop(target_controller_s *const tc, const gdb_packet_s *const p
 		uint32_t addr, len;
 		ERROR_IF_NO_TARGET();
 		if (read_hex32(packet->data + 1, &rest, &addr, ',') && read_hex32(rest, NULL, &len, READ_HEX_NO_FOLLOW)) {
-			if (len > GDB_PACKET_BUFFER_SIZE / 2U) {
+			const size_t buffer_size = gdb_packet_buffer_size();
+			if (len > buffer_size / 2U) {
 				gdb_put_packet_error(2U);
 				break;
 			}
 			DEBUG_GDB("m packet: addr = %" PRIx32 ", len = %" PRIx32 "\n", addr, len);
-			char *mem = gdb_packet_buffer() + GDB_PACKET_BUFFER_SIZE / 2U;
-			if (target_mem32_read(cur_target, mem, addr, len))
+			char *mem = gdb_packet_buffer() + buffer_size / 2U;
+			if (gdb_mem_read(mem, addr, len))
 				gdb_put_packet_error(1U);
 			else
 				gdb_put_packet_hex(mem, len);
@@ -159,8 +328,32 @@ int32_t gdb_main_loop(target_controller_s *const tc, const gdb_packet_s *const p
 			gdb_put_packet_error(0xffU);
 		break;
 	}
+	case 'x': { /* 'x addr,len': Read len bytes from addr as binary data */
+		uint32_t addr, len;
+		ERROR_IF_NO_TARGET();
+		if (read_hex32(packet->data + 1, &rest, &addr, ',') && read_hex32(rest, NULL, &len, READ_HEX_NO_FOLLOW)) {
+			/* The reply is a 'b' followed by the raw data, escaping is done during transmission */
+			if (len > gdb_packet_buffer_size() - 1U) {
+				gdb_put_packet_error(2U);
+				break;
+			}
+			DEBUG_GDB("x packet: addr = %" PRIx32 ", len = %" PRIx32 "\n", addr, len);
+			char *mem = gdb_packet_buffer();
+			if (gdb_mem_read(mem, addr, len))
+				gdb_put_packet_error(1U);
+			else
+				gdb_put_packet("b", 1U, mem, len, false);
+		} else
+			gdb_put_packet_error(0xffU);
+		break;
+	}
 	case 'G': { /* 'G XX': Write general registers */
 		ERROR_IF_NO_TARGET();
+		/* Writing back the registers of a thread that is switched out is not supported */
+		if (gdb_thread_switched_out()) {
+			gdb_put_packet_error(1U);
+			break;
+		}
 		const size_t reg_size = target_regs_size(cur_target);
 		if (reg_size) {
 			uint8_t *gp_regs = alloca(reg_size);
@@ -192,15 +385,27 @@ int32_t gdb_main_loop(target_controller_s *const tc, const gdb_packet_s *const p
 	}
 	/*
 	 * '[m|M|g|G|c][thread-id]' : Set the thread ID for the given subsequent operation
-	 * (we don't actually care which as we only care about the TID for whether to send OK or an error)
+	 * (only register accesses ('g') care, all threads resume and stop together so 'c' is just checked)
 	 */
 	case 'H': {
 		uint32_t thread_id = 0;
-		/*
-		 * Since we don't care about the operation just skip it but check there is at least 3 characters
-		 * in the packet.
-		 */
-		if (packet->size >= 3 && read_hex32(packet->data + 2, NULL, &thread_id, READ_HEX_NO_FOLLOW) && thread_id <= 1)
+		/* Thread IDs of '-1' (all threads) and '0' (any thread) both mean whichever is running for us */
+		const bool any_thread = packet->size >= 4U && packet->data[2] == '-' && packet->data[3] == '1';
+		if (packet->size < 3U ||
+			(!any_thread && !read_hex32(packet->data + 2, NULL, &thread_id, READ_HEX_NO_FOLLOW)) ||
+			(thread_id && cur_target && !rtos_thread_exists(cur_target, thread_id))) {
+			gdb_put_packet_error(1U);
+			break;
+		}
+		if (packet->data[1] == 'g')
+			gdb_general_thread = thread_id;
+		gdb_put_packet_ok();
+		break;
+	}
+	case 'T': { /* 'T thread-id': Check if the thread is alive */
+		uint32_t thread_id = 0;
+		if (cur_target && read_hex32(packet->data + 1, NULL, &thread_id, READ_HEX_NO_FOLLOW) &&
+			rtos_thread_exists(cur_target, thread_id))
 			gdb_put_packet_ok();
 		else
 			gdb_put_packet_error(1U);
@@ -229,6 +434,12 @@ int32_t gdb_main_loop(target_controller_s *const tc, const gdb_packet_s *const p
 			break;
 		}
 
+		/* In non-stop mode the reply is the stop reply of a halted thread, or OK if there are none */
+		if (gdb_non_stop) {
+			gdb_report_halt_reason();
+			break;
+		}
+
 		/*
 		 * The target is running, so there is no response to give.
 		 * The calling function will poll the state of the target
@@ -236,6 +447,7 @@ int32_t gdb_main_loop(target_controller_s *const tc, const gdb_packet_s *const p
 		 * is not NULL and `gdb_target_running` is true.
 		 */
 		gdb_target_running = true;
+		platform_poll_resumed();
 		break;
 	}
 
@@ -246,7 +458,20 @@ int32_t gdb_main_loop(target_controller_s *const tc, const gdb_packet_s *const p
 			uint32_t reg;
 			if (!read_hex32(packet->data + 1, NULL, &reg, READ_HEX_NO_FOLLOW))
 				gdb_put_packet_error(0xffU);
-			else {
+			else if (tracepoint_frame_selected()) {
+				char hex[17U];
+				tracepoint_frame_reg_read(cur_target, reg, hex, sizeof(hex));
+				gdb_put_packet_str(hex);
+			} else if (gdb_thread_switched_out()) {
+				/* Pick the register out of the thread's unstacked register set */
+				const size_t reg_size = target_regs_size(cur_target);
+				uint32_t *const regs = alloca(reg_size);
+				if (rtos_thread_regs_read(cur_target, gdb_general_thread, regs) &&
+					reg < reg_size / sizeof(uint32_t))
+					gdb_put_packet_hex(&regs[reg], sizeof(uint32_t));
+				else
+					gdb_put_packet_error(0xffU);
+			} else {
 				uint8_t val[8];
 				const size_t length = target_reg_read(cur_target, reg, val, sizeof(val));
 				if (length != 0)
@@ -268,7 +493,9 @@ int32_t gdb_main_loop(target_controller_s *const tc, const gdb_packet_s *const p
 	}
 	case 'P': { /* Write single register */
 		ERROR_IF_NO_TARGET();
-		if (cur_target->reg_write) {
+		if (gdb_thread_switched_out())
+			gdb_put_packet_error(0xffU);
+		else if (cur_target->reg_write) {
 			/*
 			 * P packets are in the form P[reg]=<value> where [reg] is a hexadecimal-encoded register number
 			 * and <value> is a hexadecimal encoded value to write to the register. Seeing a register and
@@ -335,8 +562,10 @@ int32_t gdb_main_loop(target_controller_s *const tc, const gdb_packet_s *const p
 		}
 		if (packet->data[0] == 'D')
 			gdb_put_packet_ok();
-		else /* packet->data[0] == '\x04' */
+		else { /* packet->data[0] == '\x04' */
 			gdb_set_noackmode(false);
+			gdb_non_stop = false;
+		}
 		break;
 
 	case 'k': /* Kill the target */
@@ -348,7 +577,7 @@ int32_t gdb_main_loop(target_controller_s *const tc, const gdb_packet_s *const p
 		if (cur_target)
 			target_reset(cur_target);
 		else if (last_target) {
-			cur_target = target_attach(last_target, &gdb_controller);
+			cur_target = target_attach(last_target, gdb_active_controller());
 			if (cur_target)
 				morse(NULL, false);
 			target_reset(cur_target);
@@ -421,6 +650,8 @@ static void exec_q_rcmd(const char *packet, const size_t length)
 	unhexify(data, packet, datalen);
 	data[datalen] = 0; /* add terminating null */
 
+	/* Monitor commands can do almost anything to the target, so don't trust any cached memory after one */
+	target_mem_cache_invalidate();
 	const int result = command_process(cur_target, data);
 	if (result < 0)
 		gdb_put_packet_empty();
@@ -432,29 +663,30 @@ static void exec_q_rcmd(const char *packet, const size_t length)
 	}
 }
 
-static void handle_q_string_reply(const char *reply, const char *param)
+/* Reply with the requested chunk of a qXfer object, returning true once the transfer is over */
+static bool handle_q_string_reply(const char *reply, const size_t reply_length, const char *param)
 {
-	const size_t reply_length = strlen(reply);
 	uint32_t addr = 0;
 	uint32_t len = 0;
 	const char *rest = NULL;
 
 	if (!read_hex32(param, &rest, &addr, ',') || !read_hex32(rest, NULL, &len, READ_HEX_NO_FOLLOW)) {
 		gdb_put_packet_error(1U);
-		return;
+		return true;
 	}
 	if (addr > reply_length) {
 		gdb_put_packet_error(1U);
-		return;
+		return true;
 	}
 	if (addr == reply_length) {
 		gdb_put_packet_str("l");
-		return;
+		return true;
 	}
 	size_t output_len = reply_length - addr;
 	if (output_len > len)
 		output_len = len;
 	gdb_put_packet("m", 1U, reply + addr, output_len, false);
+	return false;
 }
 
 static void exec_q_supported(const char *packet, const size_t length)
@@ -478,9 +710,10 @@ static void exec_q_supported(const char *packet, const size_t length)
 	 * according to the GDB source code (as of version 15.2) it should be a hexadecimal encoded number
 	 * to be parsed by strtoul() with a base of 16.
 	 */
-	gdb_putpacket_str_f("PacketSize=%x;qXfer:memory-map:read+;qXfer:features:read+;"
-						"vContSupported+" GDB_QSUPPORTED_NOACKMODE,
-		GDB_PACKET_BUFFER_SIZE);
+	gdb_putpacket_str_f("PacketSize=%" PRIx32 ";qXfer:memory-map:read+;qXfer:features:read+;"
+						"vContSupported+;binary-upload+;QNonStop+" GDB_QSUPPORTED_CONDITIONAL_BREAKPOINTS
+							GDB_QSUPPORTED_NOACKMODE GDB_QSUPPORTED_TRACEPOINTS,
+		(uint32_t)gdb_packet_buffer_size());
 
 	/*
 	 * If an acknowledgement was received in response while in NoAckMode, then NoAckMode is probably
@@ -505,9 +738,21 @@ static void exec_q_memory_map(const char *packet, const size_t length)
 		gdb_put_packet_error(1U);
 		return;
 	}
-	char buf[1024];
-	target_mem_map(target, buf, sizeof(buf)); /* Fixme: Check size!*/
-	handle_q_string_reply(buf, packet);
+	/* The map is built on the first request and then served from the target's copy for the rest of the chunks */
+	size_t map_length = 0U;
+	const char *const map = target_mem_map(target, &map_length);
+	if (!map) {
+		gdb_put_packet_error(1U);
+		return;
+	}
+	const bool complete = handle_q_string_reply(map, map_length, packet);
+#if CONFIG_BMDA == 0
+	/* The firmware can't spare the RAM to keep the map around, so only holds on to it until GDB has read it all */
+	if (complete)
+		target_xml_release(target);
+#else
+	(void)complete;
+#endif
 }
 
 static void exec_q_feature_read(const char *packet, const size_t length)
@@ -522,12 +767,16 @@ static void exec_q_feature_read(const char *packet, const size_t length)
 		gdb_put_packet_error(1U);
 		return;
 	}
-	const char *const description = target_regs_description(target);
-	handle_q_string_reply(description ? description : "", packet);
-#pragma GCC diagnostic push
-#pragma GCC diagnostic ignored "-Wcast-qual"
-	free((void *)description);
-#pragma GCC diagnostic pop
+	/* Likewise the description is only built once, which matters for large ones such as RISC-V's with its CSRs */
+	size_t description_length = 0U;
+	const char *const description = target_regs_description(target, &description_length);
+	const bool complete = handle_q_string_reply(description ? description : "", description_length, packet);
+#if CONFIG_BMDA == 0
+	if (complete)
+		target_xml_release(target);
+#else
+	(void)complete;
+#endif
 }
 
 static void exec_q_crc(const char *packet, const size_t length)
@@ -549,15 +798,49 @@ static void exec_q_crc(const char *packet, const size_t length)
 	}
 }
 
+/* 'qSearch:memory:addr;len;pattern' searches target memory, with the pattern as binary data */
+static void exec_q_search_memory(const char *packet, const size_t length)
+{
+	uint32_t addr = 0U;
+	uint32_t search_len = 0U;
+	const char *pattern = NULL;
+	if (!read_hex32(packet, &pattern, &addr, ';') || !read_hex32(pattern, &pattern, &search_len, ';')) {
+		gdb_put_packet_error(1U);
+		return;
+	}
+	const size_t pattern_len = length - (size_t)(pattern - packet);
+	if (!cur_target || !pattern_len) {
+		gdb_put_packet_error(1U);
+		return;
+	}
+	if (pattern_len > search_len) {
+		gdb_put_packet_str("0");
+		return;
+	}
+
+	target_addr_t found = 0U;
+	const int result =
+		target_mem32_search(cur_target, addr, search_len, (const uint8_t *)pattern, pattern_len, &found);
+	if (result < 0)
+		gdb_put_packet_error(3U);
+	else if (result)
+		gdb_putpacket_str_f("1,%" PRIx32, found);
+	else
+		gdb_put_packet_str("0");
+}
+
 /*
- * qC queries are for the current thread. We don't support threads but GDB 11 and 12 require this,
- * so we always answer that the current thread is thread 1.
+ * qC queries are for the current thread. Without an RTOS, GDB 11 and 12 still require this
+ * so we answer that the current thread is thread 1, the CPU.
  */
 static void exec_q_c(const char *packet, const size_t length)
 {
 	(void)packet;
 	(void)length;
-	gdb_put_packet_str("QC1");
+	if (cur_target)
+		gdb_putpacket_str_f("QC%" PRIx32, rtos_current_thread(cur_target));
+	else
+		gdb_put_packet_str("QC1");
 }
 
 /*
@@ -570,10 +853,51 @@ static void exec_q_c(const char *packet, const size_t length)
 static void exec_q_thread_info(const char *packet, const size_t length)
 {
 	(void)length;
-	if (packet[-11] == 'f' && cur_target)
-		gdb_put_packet_str("m1");
-	else
+	if (packet[-11] == 'f')
+		gdb_thread_info_index = 0U;
+	if (!cur_target) {
 		gdb_put_packet_str("l");
+		return;
+	}
+
+	/* Send as many thread IDs as fit in a reply, qsThreadInfo picks up from where this one left off */
+	char reply[GDB_THREAD_INFO_BUFFER_SIZE];
+	size_t offset = 0U;
+	uint32_t thread_id = 0U;
+	while (offset + 10U < sizeof(reply) && rtos_thread_id(cur_target, gdb_thread_info_index, &thread_id)) {
+		offset += (size_t)snprintf(
+			reply + offset, sizeof(reply) - offset, "%c%" PRIx32, offset ? ',' : 'm', thread_id);
+		++gdb_thread_info_index;
+	}
+	gdb_put_packet_str(offset ? reply : "l");
+}
+
+/* 'qThreadExtraInfo,id' - a description of the thread for `info threads` */
+static void exec_q_thread_extra_info(const char *packet, const size_t length)
+{
+	(void)length;
+	uint32_t thread_id = 0U;
+	char description[RTOS_THREAD_NAME_LEN + 16U];
+	if (cur_target && read_hex32(packet, NULL, &thread_id, READ_HEX_NO_FOLLOW) &&
+		rtos_thread_describe(cur_target, thread_id, description, sizeof(description)))
+		gdb_put_packet_hex(description, strlen(description));
+	else
+		gdb_put_packet_empty();
+}
+
+/* 'qSymbol:...' - GDB offering to (or answering our requests to) look up symbols, used to find an RTOS */
+static void exec_q_symbol(const char *packet, const size_t length)
+{
+#ifdef ENABLE_RTOS
+	if (cur_target) {
+		rtos_symbol_lookup(cur_target, packet, length);
+		return;
+	}
+#else
+	(void)packet;
+	(void)length;
+#endif
+	gdb_put_packet_ok();
 }
 
 /*
@@ -623,16 +947,49 @@ static void exec_q_attached(const char *packet, const size_t length)
 		gdb_put_packet_str("0"); /* It does tolelrate reset */
 }
 
+static void exec_q_non_stop(const char *packet, const size_t length)
+{
+	(void)length;
+	/* 'QNonStop:1' enables non-stop mode, 'QNonStop:0' goes back to all-stop mode */
+	if (packet[0] != '0' && packet[0] != '1') {
+		gdb_put_packet_error(1U);
+		return;
+	}
+	gdb_non_stop = packet[0] == '1';
+	DEBUG_GDB("%s non-stop mode\n", gdb_non_stop ? "Enabling" : "Disabling");
+	gdb_put_packet_ok();
+}
+
+#ifdef ENABLE_TRACEPOINTS
+static void exec_q_trace_set(const char *packet, const size_t length)
+{
+	tracepoint_set_packet(cur_target, packet, length);
+}
+
+static void exec_q_trace_query(const char *packet, const size_t length)
+{
+	tracepoint_query_packet(cur_target, packet, length);
+}
+#endif
+
 static const cmd_executer_s q_commands[] = {
 	{"qRcmd,", exec_q_rcmd},
 	{"qSupported", exec_q_supported},
 	{"qXfer:memory-map:read::", exec_q_memory_map},
 	{"qXfer:features:read:target.xml:", exec_q_feature_read},
 	{"qCRC:", exec_q_crc},
+	{"qSearch:memory:", exec_q_search_memory},
 	{"qC", exec_q_c},
 	{"qfThreadInfo", exec_q_thread_info},
 	{"qsThreadInfo", exec_q_thread_info},
+	{"qThreadExtraInfo,", exec_q_thread_extra_info},
+	{"qSymbol:", exec_q_symbol},
 	{"QStartNoAckMode", exec_q_noackmode},
+	{"QNonStop:", exec_q_non_stop},
+#ifdef ENABLE_TRACEPOINTS
+	{"QT", exec_q_trace_set},
+	{"qT", exec_q_trace_query},
+#endif
 	{"qAttached", exec_q_attached},
 	{NULL, NULL},
 };
@@ -662,11 +1019,11 @@ static void exec_v_attach(const char *const packet, const size_t length)
 	uint32_t addr;
 	if (read_hex32(packet, NULL, &addr, READ_HEX_NO_FOLLOW)) {
 		/* Attach to remote target processor */
-		cur_target = target_attach_n(addr, &gdb_controller);
+		cur_target = target_attach_n(addr, gdb_active_controller());
 		if (cur_target) {
 			morse(NULL, false);
 			/*
-			 * We don't actually support threads, but GDB 11 and 12 can't work without
+			 * Even without an RTOS to provide threads, GDB 11 and 12 can't work without
 			 * us saying we attached to thread 1.. see the following for the low-down of this:
 			 * https://sourceware.org/bugzilla/show_bug.cgi?id=28405
 			 * https://sourceware.org/bugzilla/show_bug.cgi?id=28874
@@ -674,7 +1031,8 @@ static void exec_v_attach(const char *const packet, const size_t length)
 			 * https://sourceware.org/pipermail/gdb-patches/2022-April/188058.html
 			 * https://sourceware.org/pipermail/gdb-patches/2022-July/190869.html
 			 */
-			gdb_putpacket_str_f("T%02Xthread:1;", GDB_SIGTRAP);
+			gdb_general_thread = 0U;
+			gdb_putpacket_str_f("T%02Xthread:%" PRIx32 ";", GDB_SIGTRAP, rtos_current_thread(cur_target));
 		} else
 			gdb_put_packet_error(1U);
 
@@ -742,7 +1100,7 @@ static void exec_v_run(const char *packet, const size_t length)
 		target_reset(cur_target);
 		gdb_put_packet_str("T05");
 	} else if (last_target) {
-		cur_target = target_attach(last_target, &gdb_controller);
+		cur_target = target_attach(last_target, gdb_active_controller());
 
 		/* If we were able to attach to the target again */
 		if (cur_target) {
@@ -771,9 +1129,10 @@ static void exec_v_cont(const char *packet, const size_t length)
 		 * See https://github.com/bminor/binutils-gdb/blob/de2efa143e3652d69c278dd1eb10a856593917c0/gdb/remote.c#L6526
 		 * for more details.
 		 *
-		 * TODO: Support the 't' (stop) action needed for non-stop debug so GDB can request a halt.
+		 * The 't' (stop) action is how GDB requests a halt in non-stop mode, and 'r' (range step) lets
+		 * GDB step over a whole source line with one packet rather than one per instruction.
 		 */
-		gdb_put_packet_str("vCont;c;C;s;S;t");
+		gdb_put_packet_str("vCont;c;C;s;S;t;r");
 		return;
 	}
 
@@ -783,23 +1142,50 @@ static void exec_v_cont(const char *packet, const size_t length)
 		return;
 	}
 
+	/*
+	 * We only have the one thread, so only the first action matters and any thread-id on it is ignored.
+	 * In non-stop mode every action gets an immediate OK, with the resulting stop reported later as a notification
+	 */
 	bool single_step = false;
+	gdb_range_step_start = 0U;
+	gdb_range_step_end = 0U;
 	switch (packet[1]) {
+	case 'r': { /* 'r start,end': Step until the PC leaves [start, end) */
+		uint32_t start = 0U;
+		uint32_t end = 0U;
+		const char *rest = NULL;
+		if (!read_hex32(packet + 2U, &rest, &start, ',') || !read_hex32(rest, &rest, &end, READ_HEX_NO_FOLLOW) ||
+			(*rest && *rest != ':' && *rest != ';')) {
+			gdb_put_packet_error(1U);
+			return;
+		}
+		/* The first step is taken regardless, gdb_poll_target() then keeps going while the PC stays in range */
+		gdb_range_step_start = start;
+		gdb_range_step_end = end;
+		BMD_FALLTHROUGH
+	}
 	case 's': /* 's': Single step */
+	case 'S': /* 'S sig': Single step with signal */
 		single_step = true;
 		BMD_FALLTHROUGH
 	case 'c': /* 'c': Continue */
 	case 'C': /* 'C sig': Continue with signal */
-		if (!cur_target) {
-			gdb_put_packet_str("X1D");
-			break;
-		}
-
 		target_halt_resume(cur_target, single_step);
 		SET_RUN_STATE(true);
 		gdb_target_running = true;
+		platform_poll_resumed();
+		if (gdb_non_stop)
+			gdb_put_packet_ok();
+		break;
+	case 't': /* 't': Stop */
+		/* Only a running target needs stopping, a stopped one has already been reported */
+		if (gdb_target_running)
+			gdb_halt_target();
+		gdb_put_packet_ok();
 		break;
 	default:
+		if (gdb_non_stop)
+			gdb_put_packet_error(1U);
 		break;
 	}
 }
@@ -898,6 +1284,101 @@ static void handle_v_packet(const gdb_packet_s *const packet)
 	gdb_put_packet_empty();
 }
 
+#ifdef ENABLE_CONDITIONAL_BREAKPOINTS
+static gdb_breakpoint_cond_s **gdb_breakpoint_cond_find(
+	const target_s *const target, const target_breakwatch_e type, const target_addr_t addr)
+{
+	gdb_breakpoint_cond_s **entry = &gdb_breakpoint_conds;
+	for (; *entry; entry = &(*entry)->next) {
+		if ((*entry)->target == target && (*entry)->type == type && (*entry)->addr == addr)
+			break;
+	}
+	return entry;
+}
+
+/* Replace the conditions on a breakpoint, taking ownership of them - no conditions removes the entry */
+static void gdb_breakpoint_conds_set(const target_s *const target, const target_breakwatch_e type,
+	const target_addr_t addr, const size_t len, agent_expr_s *const conditions)
+{
+	gdb_breakpoint_cond_s **const entry = gdb_breakpoint_cond_find(target, type, addr);
+	gdb_breakpoint_cond_s *breakpoint = *entry;
+	if (breakpoint) {
+		agent_expr_free(breakpoint->conditions);
+		if (!conditions) {
+			*entry = breakpoint->next;
+			free(breakpoint);
+			return;
+		}
+	} else {
+		if (!conditions)
+			return;
+		breakpoint = malloc(sizeof(*breakpoint));
+		if (!breakpoint) { /* malloc failed: heap exhaustion */
+			DEBUG_ERROR("malloc: failed in %s\n", __func__);
+			agent_expr_free(conditions);
+			return;
+		}
+		breakpoint->next = NULL;
+		breakpoint->target = target;
+		breakpoint->type = type;
+		breakpoint->addr = addr;
+		*entry = breakpoint;
+	}
+	breakpoint->len = len;
+	breakpoint->conditions = conditions;
+}
+
+static void gdb_breakpoint_conds_drop(const target_s *const target)
+{
+	for (gdb_breakpoint_cond_s **entry = &gdb_breakpoint_conds; *entry;) {
+		gdb_breakpoint_cond_s *const breakpoint = *entry;
+		if (breakpoint->target == target) {
+			*entry = breakpoint->next;
+			agent_expr_free(breakpoint->conditions);
+			free(breakpoint);
+		} else
+			entry = &breakpoint->next;
+	}
+}
+
+/*
+ * Parse the cond_list of a Z0/Z1 packet - a run of "Xlen,bytecode" agent expressions, any one
+ * of which being true means the breakpoint should be reported. Returns false if the list is malformed.
+ */
+static bool gdb_breakpoint_conds_parse(const char *rest, agent_expr_s **const conditions)
+{
+	agent_expr_s **tail = conditions;
+	while (*rest) {
+		if (*rest == ';') {
+			++rest;
+			continue;
+		}
+		/* We don't advertise BreakpointCommands, so anything other than a condition is a mistake */
+		if (*rest != 'X')
+			break;
+		*tail = agent_expr_parse(rest + 1U, &rest);
+		if (!*tail)
+			break;
+		tail = &(*tail)->next;
+	}
+	if (!*rest)
+		return true;
+	agent_expr_free(*conditions);
+	*conditions = NULL;
+	return false;
+}
+
+static bool gdb_breakpoint_exists(
+	const target_s *const target, const target_breakwatch_e type, const target_addr_t addr, const size_t len)
+{
+	for (const breakwatch_s *breakwatch = target->bw_list; breakwatch; breakwatch = breakwatch->next) {
+		if (breakwatch->type == type && breakwatch->addr == addr && breakwatch->size == len)
+			return true;
+	}
+	return false;
+}
+#endif
+
 static void handle_z_packet(const gdb_packet_s *const packet)
 {
 	uint32_t type;
@@ -906,12 +1387,39 @@ static void handle_z_packet(const gdb_packet_s *const packet)
 	const char *rest = NULL;
 
 	if (read_dec32(packet->data + 1U, &rest, &type, ',') && read_hex32(rest, &rest, &addr, ',') &&
-		read_dec32(rest, NULL, &len, READ_HEX_NO_FOLLOW)) {
+		read_dec32(rest, &rest, &len, READ_HEX_NO_FOLLOW)) {
+		if (!cur_target) {
+			gdb_put_packet_error(0xffU);
+			return;
+		}
 		int ret = 0;
-		if (packet->data[0] == 'Z')
+		if (packet->data[0] == 'Z') {
+#ifdef ENABLE_CONDITIONAL_BREAKPOINTS
+			agent_expr_s *conditions = NULL;
+			if (!gdb_breakpoint_conds_parse(rest, &conditions)) {
+				gdb_put_packet_error(1U);
+				return;
+			}
+			/*
+			 * GDB updates the conditions on a breakpoint by sending the Z packet for it again,
+			 * in which case there's nothing to do to the target and only the conditions change
+			 */
+			if (!gdb_breakpoint_exists(cur_target, type, addr, len))
+				ret = target_breakwatch_set(cur_target, type, addr, len);
+			if (ret == 0 && (type == TARGET_BREAK_SOFT || type == TARGET_BREAK_HARD))
+				gdb_breakpoint_conds_set(cur_target, type, addr, len, conditions);
+			else
+				agent_expr_free(conditions);
+#else
 			ret = target_breakwatch_set(cur_target, type, addr, len);
-		else
+#endif
+		} else {
 			ret = target_breakwatch_clear(cur_target, type, addr, len);
+#ifdef ENABLE_CONDITIONAL_BREAKPOINTS
+			if (ret == 0)
+				gdb_breakpoint_conds_set(cur_target, type, addr, len, NULL);
+#endif
+		}
 
 		/* If the target handler was unable to set/clear the break/watch-point, return an error */
 		if (ret < 0)
@@ -928,25 +1436,291 @@ static void handle_z_packet(const gdb_packet_s *const packet)
 
 void gdb_main(const gdb_packet_s *const packet)
 {
-	gdb_main_loop(&gdb_controller, packet, false);
+	gdb_main_loop(gdb_active_controller(), packet, false);
+}
+
+#if CONFIG_BMDA == 1
+static void gdb_session_bind(const size_t index, target_s *const target, void *const context)
+{
+	(void)context;
+	/* target_foreach() counts from 1 */
+	if (index <= gdb_sessions_count)
+		gdb_sessions[index - 1U].last_target = target;
+}
+
+size_t gdb_sessions_init(void)
+{
+	/* Count the targets first - with no sessions allocated yet this doesn't bind anything */
+	const size_t targets = target_foreach(gdb_session_bind, NULL);
+	if (!targets)
+		return 0U;
+	gdb_sessions_count = MIN(targets, GDB_IF_MAX_SESSIONS);
+	if (gdb_sessions_count < targets)
+		DEBUG_WARN("Only serving the first %zu of %zu targets\n", gdb_sessions_count, targets);
+
+	gdb_sessions = calloc(gdb_sessions_count, sizeof(*gdb_sessions));
+	if (!gdb_sessions) { /* calloc failed: heap exhaustion */
+		DEBUG_ERROR("calloc: failed in %s\n", __func__);
+		gdb_sessions_count = 0U;
+		return 0U;
+	}
+	for (size_t idx = 0U; idx < gdb_sessions_count; ++idx) {
+		gdb_sessions[idx].controller.destroy_callback = gdb_target_destroy_callback;
+		gdb_sessions[idx].controller.printf = gdb_target_printf;
+	}
+	/* Bind each session to its target, by way of the target it will attach to on connection */
+	target_foreach(gdb_session_bind, NULL);
+
+	gdb_session = gdb_sessions;
+	cur_target = NULL;
+	last_target = gdb_session->last_target;
+	gdb_target_running = false;
+	return gdb_sessions_count;
 }
 
-/* Request halt on the active target */
+size_t gdb_session_count(void)
+{
+	return gdb_sessions_count;
+}
+
+void gdb_session_switch(const size_t index)
+{
+	if (index >= gdb_sessions_count || gdb_session == &gdb_sessions[index])
+		return;
+	/* Put away the state of the outgoing session.. */
+	gdb_session->cur_target = cur_target;
+	gdb_session->last_target = last_target;
+	gdb_session->target_running = gdb_target_running;
+	gdb_session->needs_detach_notify = gdb_needs_detach_notify;
+	gdb_session->noackmode = gdb_noackmode();
+	gdb_session->non_stop = gdb_non_stop;
+	gdb_session->general_thread = gdb_general_thread;
+	gdb_session->range_step_start = gdb_range_step_start;
+	gdb_session->range_step_end = gdb_range_step_end;
+	gdb_session->halt_requested = gdb_halt_requested;
+	/* ..and bring in that of the new one */
+	gdb_session = &gdb_sessions[index];
+	cur_target = gdb_session->cur_target;
+	last_target = gdb_session->last_target;
+	gdb_target_running = gdb_session->target_running;
+	gdb_needs_detach_notify = gdb_session->needs_detach_notify;
+	gdb_set_noackmode(gdb_session->noackmode);
+	gdb_non_stop = gdb_session->non_stop;
+	gdb_general_thread = gdb_session->general_thread;
+	gdb_range_step_start = gdb_session->range_step_start;
+	gdb_range_step_end = gdb_session->range_step_end;
+	gdb_halt_requested = gdb_session->halt_requested;
+	gdb_if_session_select(index);
+}
+
+void gdb_session_connected(void)
+{
+	/* Give the new GDB a chance to handshake rather than treating its packets as a request to halt */
+	gdb_target_running = false;
+	gdb_needs_detach_notify = false;
+	gdb_non_stop = false;
+	gdb_range_step_start = 0U;
+	gdb_range_step_end = 0U;
+	gdb_halt_requested = false;
+	/* Hand it the session's target, so it doesn't have to go through scanning and attaching itself */
+	if (!cur_target && last_target) {
+		cur_target = target_attach(last_target, gdb_active_controller());
+		if (cur_target)
+			morse(NULL, false);
+	}
+}
+#endif
+
+/* Request halt on the active target, noting that GDB asked for it so that it's reported as such */
 void gdb_halt_target(void)
 {
-	if (cur_target)
+	if (cur_target) {
+		gdb_halt_requested = true;
 		target_halt_request(cur_target);
-	else
+	} else
 		/* Report "target exited" if no target */
 		gdb_put_packet_str("W00");
 }
 
+/* Build the stop reply describing why the target halted */
+static void gdb_format_stop_reply(
+	char *const reply, const size_t size, const target_halt_reason_e reason, const target_addr64_t watch)
+{
+	if (reason == TARGET_HALT_ERROR) {
+		snprintf(reply, size, "X%02X", GDB_SIGLOST);
+		return;
+	}
+
+	/*
+	 * Expedite the registers GDB needs straight after a stop (pc, sp, etc) in the stop reply
+	 * so it doesn't have to go and ask for them one at a time
+	 */
+	char expedited[GDB_EXPEDITE_BUFFER_SIZE];
+	target_regs_expedite(cur_target, expedited, sizeof(expedited));
+
+	/* The thread that stopped is whichever the RTOS (if any) had running, and GDB's selection resets to it */
+#ifdef ENABLE_RTOS
+	rtos_target_halted(cur_target);
+#endif
+	const uint32_t thread_id = rtos_current_thread(cur_target);
+	gdb_general_thread = 0U;
+
+	/* Translate reason to GDB signal */
+	switch (reason) {
+	case TARGET_HALT_REQUEST:
+		/* A halt asked for with vCont;t in non-stop mode must be reported as signal 0 */
+		snprintf(reply, size, "T%02Xthread:%" PRIx32 ";%s", gdb_non_stop ? 0U : GDB_SIGINT, thread_id, expedited);
+		break;
+	case TARGET_HALT_WATCHPOINT:
+		snprintf(reply, size, "T%02Xwatch:%0" PRIX32 "%08" PRIX32 ";%s", GDB_SIGTRAP, (uint32_t)(watch >> 32U),
+			(uint32_t)watch, expedited);
+		break;
+	case TARGET_HALT_FAULT:
+		snprintf(reply, size, "T%02Xthread:%" PRIx32 ";%s", GDB_SIGSEGV, thread_id, expedited);
+		break;
+	default:
+		snprintf(reply, size, "T%02Xthread:%" PRIx32 ";%s", GDB_SIGTRAP, thread_id, expedited);
+	}
+}
+
+/* Send a stop reply - as a reply to the pending resume in all-stop mode, or as a notification in non-stop mode */
+static void gdb_put_stop_reply(const char *const reply)
+{
+	if (!gdb_non_stop) {
+		gdb_put_packet_str(reply);
+		return;
+	}
+	char notification[GDB_STOP_REPLY_BUFFER_SIZE + 5U];
+	snprintf(notification, sizeof(notification), "Stop:%s", reply);
+	gdb_put_notification_str(notification);
+}
+
+/* Reply to '?' in non-stop mode, this must not wait for the target to stop if it is running */
+static void gdb_report_halt_reason(void)
+{
+	target_addr64_t watch = 0U;
+	const target_halt_reason_e reason =
+		gdb_target_running ? TARGET_HALT_RUNNING : target_halt_poll(cur_target, &watch);
+	if (reason == TARGET_HALT_RUNNING) {
+		gdb_put_packet_ok();
+		return;
+	}
+	char reply[GDB_STOP_REPLY_BUFFER_SIZE];
+	gdb_format_stop_reply(reply, sizeof(reply), reason, watch);
+	gdb_put_packet_str(reply);
+}
+
+#ifdef ENABLE_CONDITIONAL_BREAKPOINTS
+/*
+ * Check the conditions on the breakpoint the target just stopped on. Returns true if the stop should be
+ * reported to GDB - which is the case if the breakpoint has no conditions here, any of them is true,
+ * or they can't be evaluated (in which case GDB gets to decide, as it would have without us)
+ */
+static bool gdb_breakpoint_conds_met(gdb_breakpoint_cond_s **const hit)
+{
+	*hit = NULL;
+	if (!gdb_breakpoint_conds)
+		return true;
+	target_addr64_t pc = 0U;
+	if (!target_pc_read(cur_target, &pc))
+		return true;
+	gdb_breakpoint_cond_s *breakpoint = *gdb_breakpoint_cond_find(cur_target, TARGET_BREAK_HARD, pc);
+	if (!breakpoint)
+		breakpoint = *gdb_breakpoint_cond_find(cur_target, TARGET_BREAK_SOFT, pc);
+	if (!breakpoint)
+		return true;
+	*hit = breakpoint;
+
+	for (const agent_expr_s *condition = breakpoint->conditions; condition; condition = condition->next) {
+		uint64_t result = 0U;
+		if (!agent_expr_eval(cur_target, condition, &result) || result)
+			return true;
+	}
+	return false;
+}
+#endif
+
+/*
+ * Get the target going again from a breakpoint GDB need not hear about. The breakpoint has to be
+ * lifted while the instruction under it is stepped, otherwise resuming would just hit it again straight away.
+ * Returns the reason the target halted if it did so for anything other than the step.
+ */
+static target_halt_reason_e gdb_breakpoint_resume(
+	const target_breakwatch_e type, const target_addr_t addr, const size_t len)
+{
+	target_breakwatch_clear(cur_target, type, addr, len);
+	target_halt_resume(cur_target, true);
+
+	platform_timeout_s timeout;
+	platform_timeout_set(&timeout, 1000);
+	target_addr64_t watch = 0U;
+	target_halt_reason_e reason = TARGET_HALT_RUNNING;
+	while (reason == TARGET_HALT_RUNNING && !platform_timeout_is_expired(&timeout))
+		reason = target_halt_poll(cur_target, &watch);
+	/* If the step never finished (the core may be waiting on something), stop it so GDB can be told about it */
+	const bool step_timed_out = reason == TARGET_HALT_RUNNING;
+	if (step_timed_out) {
+		DEBUG_WARN("Timed out stepping off breakpoint at 0x%08" PRIx32 "\n", addr);
+		target_halt_request(cur_target);
+		platform_timeout_set(&timeout, 1000);
+		while (reason == TARGET_HALT_RUNNING && !platform_timeout_is_expired(&timeout))
+			reason = target_halt_poll(cur_target, &watch);
+	}
+
+	if (target_breakwatch_set(cur_target, type, addr, len) != 0) {
+		DEBUG_WARN("Failed to re-arm breakpoint at 0x%08" PRIx32 "\n", addr);
+		/* GDB gets told about the stop to sort things out */
+		return TARGET_HALT_BREAKPOINT;
+	}
+	if (step_timed_out)
+		return reason == TARGET_HALT_RUNNING ? TARGET_HALT_ERROR : TARGET_HALT_REQUEST;
+	if (reason == TARGET_HALT_ERROR || reason == TARGET_HALT_FAULT || reason == TARGET_HALT_WATCHPOINT)
+		return reason;
+	target_halt_resume(cur_target, false);
+	return TARGET_HALT_RUNNING;
+}
+
+/*
+ * Keep a range step going while the target stops inside the range. Stepping carries on here for a short
+ * time slice rather than one step per poll, so the target only goes back to the main loop (which may pick
+ * up a request to halt) every so often. Returns the reason the target halted once the PC has left the range
+ * or it stopped for some other reason, or TARGET_HALT_RUNNING if it's still working through the range.
+ * Neither the DWT nor the FPB can match on the PC leaving a range, so this has to be done by stepping.
+ */
+static target_halt_reason_e gdb_range_step(target_halt_reason_e reason, target_addr64_t *const watch)
+{
+	platform_timeout_s timeout;
+	platform_timeout_set(&timeout, GDB_RANGE_STEP_SLICE_MS);
+	while (reason == TARGET_HALT_STEPPING) {
+		/* GDB wants the target stopped (^C), so end the range here and let it know it was interrupted */
+		if (gdb_halt_requested) {
+			reason = TARGET_HALT_REQUEST;
+			break;
+		}
+		target_addr64_t pc = 0U;
+		if (!target_pc_read(cur_target, &pc) || pc < gdb_range_step_start || pc >= gdb_range_step_end)
+			break;
+		target_halt_resume(cur_target, true);
+		/* Out of time, let the main loop have a look in - the next poll picks up with this step */
+		if (platform_timeout_is_expired(&timeout))
+			return TARGET_HALT_RUNNING;
+		reason = TARGET_HALT_RUNNING;
+		while (reason == TARGET_HALT_RUNNING && !platform_timeout_is_expired(&timeout))
+			reason = target_halt_poll(cur_target, watch);
+		if (reason == TARGET_HALT_RUNNING)
+			return reason;
+	}
+	gdb_range_step_start = 0U;
+	gdb_range_step_end = 0U;
+	return reason;
+}
+
 /* Poll the running target to see if it halted yet */
 void gdb_poll_target(void)
 {
 	if (!cur_target) {
 		/* Report "target exited" if no target */
-		gdb_put_packet_str("W00");
+		gdb_put_stop_reply("W00");
 		return;
 	}
 
@@ -955,28 +1729,53 @@ void gdb_poll_target(void)
 	target_halt_reason_e reason = target_halt_poll(cur_target, &watch);
 	if (!reason)
 		return;
+	/* Whether it stays halted or gets resumed below, the halt poll back-off starts over */
+	platform_poll_resumed();
+
+	/* If a range step is in progress, keep stepping while the target stays inside the range */
+	if (gdb_range_step_end > gdb_range_step_start) {
+		reason = gdb_range_step(reason, &watch);
+		if (!reason)
+			return;
+	}
+
+	/* Whether the target stopped on a breakpoint GDB gave conditions for, which makes it not a tracepoint */
+	bool conditional_breakpoint = false;
+#ifdef ENABLE_CONDITIONAL_BREAKPOINTS
+	/* If the breakpoint hit has conditions and none of them are true, carry on without bothering GDB */
+	gdb_breakpoint_cond_s *breakpoint = NULL;
+	if (reason == TARGET_HALT_BREAKPOINT && !gdb_breakpoint_conds_met(&breakpoint)) {
+		reason = gdb_breakpoint_resume(breakpoint->type, breakpoint->addr, breakpoint->len);
+		if (!reason)
+			return;
+	}
+	conditional_breakpoint = breakpoint != NULL;
+#endif
+
+	/* Likewise for tracepoints, which collect their frame and go straight back to running */
+	target_addr_t tracepoint_addr = 0U;
+	size_t tracepoint_kind = 0U;
+	bool resume_over = false;
+	if (reason == TARGET_HALT_BREAKPOINT && !conditional_breakpoint &&
+		tracepoint_hit(cur_target, &tracepoint_addr, &tracepoint_kind, &resume_over)) {
+		if (!resume_over) {
+			/* The experiment has just stopped, so its breakpoint is gone and there's nothing to step over */
+			target_halt_resume(cur_target, false);
+			return;
+		}
+		reason = gdb_breakpoint_resume(TARGET_BREAK_HARD, tracepoint_addr, tracepoint_kind);
+		if (!reason)
+			return;
+	}
 
 	/* switch polling off */
 	gdb_target_running = false;
+	gdb_halt_requested = false;
 	SET_RUN_STATE(0);
 
-	/* Translate reason to GDB signal */
-	switch (reason) {
-	case TARGET_HALT_ERROR:
-		gdb_putpacket_str_f("X%02X", GDB_SIGLOST);
+	char reply[GDB_STOP_REPLY_BUFFER_SIZE];
+	gdb_format_stop_reply(reply, sizeof(reply), reason, watch);
+	gdb_put_stop_reply(reply);
+	if (reason == TARGET_HALT_ERROR)
 		morse("TARGET LOST.", true);
-		break;
-	case TARGET_HALT_REQUEST:
-		gdb_putpacket_str_f("T%02Xthread:1;", GDB_SIGINT);
-		break;
-	case TARGET_HALT_WATCHPOINT:
-		gdb_putpacket_str_f(
-			"T%02Xwatch:%0" PRIX32 "%08" PRIX32 ";", GDB_SIGTRAP, (uint32_t)(watch >> 32U), (uint32_t)watch);
-		break;
-	case TARGET_HALT_FAULT:
-		gdb_putpacket_str_f("T%02Xthread:1;", GDB_SIGSEGV);
-		break;
-	default:
-		gdb_putpacket_str_f("T%02Xthread:1;", GDB_SIGTRAP);
-	}
 }
@@ -43,6 +43,51 @@ static bool noackmode = false;
 
 #ifdef EXTERNAL_PACKET_BUFFER
 extern gdb_packet_s *gdb_full_packet_buffer(void);
+#elif CONFIG_BMDA == 1
+static gdb_packet_s packet_buffer;
+static size_t packet_buffer_size = 0U;
+
+bool gdb_packet_buffer_alloc(const size_t size)
+{
+	/* The buffer must be able to hold at least what the firmware can, and no more than we tell GDB is sane */
+	if (size < GDB_PACKET_BUFFER_SIZE || size > GDB_PACKET_BUFFER_SIZE_MAX) {
+		DEBUG_ERROR("GDB packet size must be between %u and %u bytes, got %zu\n", GDB_PACKET_BUFFER_SIZE,
+			GDB_PACKET_BUFFER_SIZE_MAX, size);
+		return false;
+	}
+
+	/* Allocate one extra byte so the packet can always be null terminated */
+	char *const data = realloc(packet_buffer.data, size + 1U);
+	if (!data) {
+		DEBUG_ERROR("Failed to allocate %zu bytes for the GDB packet buffer\n", size + 1U);
+		return false;
+	}
+	packet_buffer.data = data;
+	packet_buffer.size = 0U;
+	packet_buffer_size = size;
+	DEBUG_INFO("Using a GDB packet size of %zu bytes\n", size);
+	return true;
+}
+
+static inline gdb_packet_s *gdb_full_packet_buffer(void)
+{
+	/* If nothing has sized the buffer yet, fall back to the default size */
+	if (!packet_buffer.data && !gdb_packet_buffer_alloc(GDB_PACKET_BUFFER_SIZE_DEFAULT))
+		exit(1);
+	return &packet_buffer;
+}
+
+char *gdb_packet_buffer(void)
+{
+	/* Return the heap allocated packet data buffer */
+	return gdb_full_packet_buffer()->data;
+}
+
+size_t gdb_packet_buffer_size(void)
+{
+	gdb_full_packet_buffer();
+	return packet_buffer_size;
+}
 #else
 /* This has to be aligned so the remote protocol can re-use it without causing Problems */
 static gdb_packet_s BMD_ALIGN_DEF(8) packet_buffer;
@@ -83,18 +128,22 @@ bool gdb_noackmode(void)
  * This is not directly related to BMD, but as it's hard to find this information
  * and it is extremely useful for debugging, we included it here for reference.
  */
-static void gdb_packet_debug(const char *const func, const gdb_packet_s *const packet)
+static void gdb_packet_debug(const char *const func, const char *const data, const size_t size, const bool hex_data)
 {
-	/* Log packet for debugging */
-	DEBUG_GDB("%s: ", func);
-	for (size_t i = 0; i < packet->size; i++) {
-		const char value = packet->data[i];
-		if (value >= ' ' && value < '\x7f')
+	/* Log packet for debugging, a NULL func logs only the data so a packet can be logged in pieces */
+	if (func)
+		DEBUG_GDB("%s: ", func);
+	for (size_t i = 0; i < size; i++) {
+		const char value = data[i];
+		if (hex_data)
+			DEBUG_GDB("%02X", (uint8_t)value);
+		else if (value >= ' ' && value < '\x7f')
 			DEBUG_GDB("%c", value);
 		else
 			DEBUG_GDB("\\x%02X", (uint8_t)value);
 	}
-	DEBUG_GDB("\n");
+	if (func)
+		DEBUG_GDB("\n");
 }
 #endif
 
@@ -119,6 +168,30 @@ static uint8_t gdb_packet_checksum(const gdb_packet_s *const packet)
 	return checksum;
 }
 
+#if CONFIG_BMDA == 0
+static packet_state_e consume_remote_binary_packet(char *const packet, const size_t size)
+{
+	/* Binary remote packets give the length of their payload up front as a little-endian 16-bit value */
+	const uint8_t length_low = (uint8_t)gdb_if_getchar();
+	const uint8_t length_high = (uint8_t)gdb_if_getchar();
+	const size_t length = length_low | ((size_t)length_high << 8U);
+	/* Capture the payload by count, as any byte value can appear in it, dropping what won't fit */
+	for (size_t offset = 0; offset < length; ++offset) {
+		const char rx_char = gdb_if_getchar();
+		if (offset < size)
+			packet[offset] = rx_char;
+	}
+	/* If the payload is not followed by an end of message marker, we've lost sync, so drop the packet */
+	if (gdb_if_getchar() == REMOTE_EOM)
+		/* Handle the packet, an empty payload gets a length error back if it was too big for the buffer */
+		remote_binary_packet_process((uint8_t *)packet, length <= size ? length : 0U);
+
+	/* Restart packet capture */
+	packet[0] = '\0';
+	return PACKET_IDLE;
+}
+#endif
+
 packet_state_e consume_remote_packet(char *const packet, const size_t size)
 {
 #if CONFIG_BMDA == 0
@@ -155,6 +228,12 @@ packet_state_e consume_remote_packet(char *const packet, const size_t size)
 			/* A 'real' gdb packet, best stop squatting now */
 			return PACKET_GDB_CAPTURE;
 
+		case REMOTE_BINARY_PACKET:
+			/* A binary packet marker straight after the start of message switches to capturing that instead */
+			if (offset == 0U)
+				return consume_remote_binary_packet(packet, size);
+			BMD_FALLTHROUGH
+
 		default:
 			if (offset < size)
 				packet[offset++] = rx_char;
@@ -174,14 +253,20 @@ packet_state_e consume_remote_packet(char *const packet, const size_t size)
 #endif
 }
 
-gdb_packet_s *gdb_packet_receive(void)
+static gdb_packet_s *gdb_packet_receive_from(packet_state_e state)
 {
-	packet_state_e state = PACKET_IDLE; /* State of the packet capture */
 	uint8_t rx_checksum = 0;
 	gdb_packet_s *packet = gdb_full_packet_buffer();
+	packet->size = 0;
+	packet->notification = false;
 
 	while (true) {
+#if CONFIG_BMDA == 0
+		/* Between packets, let the remote protocol's halt watch run while we wait */
+		const char rx_char = state == PACKET_IDLE ? remote_halt_watch_getchar() : gdb_if_getchar();
+#else
 		const char rx_char = gdb_if_getchar();
+#endif
 
 		switch (state) {
 		case PACKET_IDLE:
@@ -199,7 +284,7 @@ gdb_packet_s *gdb_packet_receive(void)
 				 * Let consume_remote_packet handle this
 				 * returns PACKET_IDLE or PACKET_GDB_CAPTURE if it detects the start of a GDB packet
 				 */
-				state = consume_remote_packet(packet->data, GDB_PACKET_BUFFER_SIZE);
+				state = consume_remote_packet(packet->data, gdb_packet_buffer_size());
 				packet->size = 0;
 			}
 #endif
@@ -271,7 +356,7 @@ gdb_packet_s *gdb_packet_receive(void)
 
 #ifndef DEBUG_GDB_IS_NOOP
 			/* Log packet for debugging */
-			gdb_packet_debug(__func__, packet);
+			gdb_packet_debug(__func__, packet->data, packet->size, false);
 #endif
 
 			/* Return captured packet */
@@ -283,12 +368,23 @@ gdb_packet_s *gdb_packet_receive(void)
 			break;
 		}
 
-		if (packet->size >= GDB_PACKET_BUFFER_SIZE)
+		if (packet->size >= gdb_packet_buffer_size())
 			/* Buffer overflow, restart packet capture */
 			state = PACKET_IDLE;
 	}
 }
 
+gdb_packet_s *gdb_packet_receive(void)
+{
+	return gdb_packet_receive_from(PACKET_IDLE);
+}
+
+gdb_packet_s *gdb_packet_receive_started(void)
+{
+	/* The caller has already consumed the packet start character, so go straight to capturing the data */
+	return gdb_packet_receive_from(PACKET_GDB_CAPTURE);
+}
+
 void gdb_packet_ack(const bool ack)
 {
 	/* Send ACK/NACK */
@@ -304,95 +400,168 @@ bool gdb_packet_get_ack(const uint32_t timeout)
 	return ack;
 }
 
-static inline void gdb_if_putchar_escaped(const char value)
+static inline void gdb_packet_encode_raw(gdb_packet_encoder_s *const encoder, const char value)
+{
+	/* Write a character exactly as given, accumulating it into the checksum */
+	gdb_if_putchar(value, false);
+	encoder->checksum += (uint8_t)value;
+}
+
+/*
+ * Write out the pending run of characters
+ * See https://sourceware.org/gdb/current/onlinedocs/gdb.html/Overview.html#Binary-Data
+ *
+ * A run is encoded as the character followed by '*' and a printable count character whose value
+ * minus 29 is the number of additional repeats. The encoding takes two characters so it only pays
+ * off for at least 3 repeats, and repeat counts of 6 and 7 would encode as '#' and '$' which are not
+ * allowed, so those encode only 5 of them and let the remainder go out as a new run.
+ */
+static void gdb_packet_encode_flush_run(gdb_packet_encoder_s *const encoder)
 {
-	/* Escape reserved characters */
+	size_t remaining = encoder->run_length;
+	while (remaining) {
+		gdb_packet_encode_raw(encoder, encoder->run_char);
+		--remaining;
+
+		size_t repeats = MIN(remaining, GDB_PACKET_RUNLENGTH_MAX);
+		if (repeats == 6U || repeats == 7U)
+			repeats = 5U;
+		if (repeats < GDB_PACKET_RUNLENGTH_MIN)
+			continue;
+		gdb_packet_encode_raw(encoder, GDB_PACKET_RUNLENGTH_START);
+		gdb_packet_encode_raw(encoder, (char)(repeats + GDB_PACKET_RUNLENGTH_BIAS));
+		remaining -= repeats;
+	}
+	encoder->run_length = 0U;
+}
+
+static inline void gdb_packet_encode_char(gdb_packet_encoder_s *const encoder, const char value)
+{
+	/* Extend the pending run if this character continues it */
+	if (encoder->run_length && value == encoder->run_char) {
+		++encoder->run_length;
+		return;
+	}
+	gdb_packet_encode_flush_run(encoder);
+
+	/* Reserved characters are escaped and never run-length encoded */
 	if (gdb_packet_is_reserved(value)) {
-		gdb_if_putchar(GDB_PACKET_ESCAPE, false);
-		gdb_if_putchar((char)((uint8_t)value ^ GDB_PACKET_ESCAPE_XOR), false);
+		gdb_packet_encode_raw(encoder, GDB_PACKET_ESCAPE);
+		gdb_packet_encode_raw(encoder, (char)((uint8_t)value ^ GDB_PACKET_ESCAPE_XOR));
 	} else {
-		gdb_if_putchar(value, false);
+		encoder->run_char = value;
+		encoder->run_length = 1U;
 	}
 }
 
-void gdb_packet_send(const gdb_packet_s *const packet)
+void gdb_packet_encode_begin(gdb_packet_encoder_s *const encoder, const bool notification)
 {
-	/* Calculate checksum first to avoid re-calculation */
-	const uint8_t checksum = gdb_packet_checksum(packet);
+	encoder->checksum = 0U;
+	encoder->run_char = '\0';
+	encoder->run_length = 0U;
+	encoder->notification = notification;
+	/* Write start of packet, this is not part of the checksum */
+	gdb_if_putchar(notification ? GDB_PACKET_NOTIFICATION_START : GDB_PACKET_START, false);
+}
 
-	/* Attempt packet transmission up to retries */
-	for (size_t attempt = 0U; attempt < GDB_PACKET_RETRIES; attempt++) {
-		/* Write start of packet */
-		gdb_if_putchar(packet->notification ? GDB_PACKET_NOTIFICATION_START : GDB_PACKET_START, false);
+void gdb_packet_encode_data(gdb_packet_encoder_s *const encoder, const void *const data, const size_t size)
+{
+	const char *const values = (const char *)data;
+	for (size_t offset = 0U; offset < size; ++offset)
+		gdb_packet_encode_char(encoder, values[offset]);
+}
 
-		/* Write packet data */
-		for (size_t i = 0; i < packet->size; i++)
-			gdb_if_putchar_escaped(packet->data[i]);
+void gdb_packet_encode_hex(gdb_packet_encoder_s *const encoder, const void *const data, const size_t size)
+{
+	/* Hex encode straight into the output, saving a pass through the packet buffer */
+	const uint8_t *const values = (const uint8_t *)data;
+	for (size_t offset = 0U; offset < size; ++offset) {
+		gdb_packet_encode_char(encoder, hex_digit(values[offset] >> 4U));
+		gdb_packet_encode_char(encoder, hex_digit(values[offset] & 0xfU));
+	}
+}
+
+bool gdb_packet_encode_end(gdb_packet_encoder_s *const encoder)
+{
+	gdb_packet_encode_flush_run(encoder);
+	const uint8_t checksum = encoder->checksum;
+
+	/* Write end of packet */
+	gdb_if_putchar(GDB_PACKET_END, false);
 
-		/* Write end of packet */
-		gdb_if_putchar(GDB_PACKET_END, false);
+	/* Write checksum and flush the buffer */
+	gdb_if_putchar(hex_digit(checksum >> 4U), false);
+	gdb_if_putchar(hex_digit(checksum & 0xfU), true);
 
-		/* Write checksum and flush the buffer */
-		gdb_if_putchar(hex_digit(checksum >> 4U), false);
-		gdb_if_putchar(hex_digit(checksum & 0xfU), true);
+	/* Wait for ACK/NACK on standard packets */
+	return encoder->notification || noackmode || gdb_packet_get_ack(2000U);
+}
+
+void gdb_packet_send(const gdb_packet_s *const packet)
+{
+	gdb_packet_encoder_s encoder;
+	/* Attempt packet transmission up to retries */
+	for (size_t attempt = 0U; attempt < GDB_PACKET_RETRIES; attempt++) {
+		gdb_packet_encode_begin(&encoder, packet->notification);
+		gdb_packet_encode_data(&encoder, packet->data, packet->size);
+		const bool acknowledged = gdb_packet_encode_end(&encoder);
 
 #ifndef DEBUG_GDB_IS_NOOP
 		/* Log packet for debugging */
-		gdb_packet_debug(__func__, packet);
+		gdb_packet_debug(__func__, packet->data, packet->size, false);
 #endif
 
-		/* Wait for ACK/NACK on standard packets */
-		if (packet->notification || noackmode || gdb_packet_get_ack(2000U))
+		if (acknowledged)
 			break;
 	}
 }
 
 void gdb_put_packet(const char *preamble, size_t preamble_size, const char *data, size_t data_size, bool hex_data)
 {
-	gdb_packet_s *packet = gdb_full_packet_buffer();
-
-	/*
-	 * Create a packet using the internal packet buffer
-	 * This destroys the previous packet in the buffer
-	 * any packets obtained from gdb_packet_receive() will be invalidated
-	 */
-	packet->notification = false;
-	packet->size = 0;
-
 	/*
-	 * Copy the preamble and data into the packet buffer, limited by the buffer size
+	 * Limit the preamble and data to what fits in a packet
 	 *
-	 * This considers GDB_PACKET_BUFFER_SIZE to be the maximum size of the packet
+	 * This considers gdb_packet_buffer_size() to be the maximum size of the packet
 	 * But it does not take into consideration the extra space needed for escaping
 	 * This is safe because the escaping is done during the actual packet transmission
 	 * but it will result in a packet larger than what we told GDB we could handle
 	 */
-	if (preamble != NULL && preamble_size > 0) {
-		preamble_size = MIN(preamble_size, GDB_PACKET_BUFFER_SIZE);
-		memcpy(packet->data, preamble, preamble_size);
-		packet->size = preamble_size;
-	}
+	const size_t buffer_size = gdb_packet_buffer_size();
+	if (preamble == NULL)
+		preamble_size = 0U;
+	preamble_size = MIN(preamble_size, buffer_size);
+	if (data == NULL)
+		data_size = 0U;
+	/* Hex data doubles in size */
+	const size_t remaining_size = buffer_size - preamble_size;
+	data_size = MIN(data_size, hex_data ? remaining_size / 2U : remaining_size);
 
-	/* Add the data to the packet buffer and transform it if needed */
-	if (data != NULL && data_size > 0) {
-		/* Hex data doubles in size */
+	/*
+	 * The packet is encoded straight from the caller's buffers rather than being assembled in the
+	 * packet buffer first, which also leaves any packet obtained from gdb_packet_receive() intact.
+	 * The source buffers stay valid for the whole call, so any retransmission just re-encodes them.
+	 */
+	gdb_packet_encoder_s encoder;
+	for (size_t attempt = 0U; attempt < GDB_PACKET_RETRIES; attempt++) {
+		gdb_packet_encode_begin(&encoder, false);
+		gdb_packet_encode_data(&encoder, preamble, preamble_size);
 		if (hex_data)
-			data_size *= 2U;
+			gdb_packet_encode_hex(&encoder, data, data_size);
+		else
+			gdb_packet_encode_data(&encoder, data, data_size);
+		const bool acknowledged = gdb_packet_encode_end(&encoder);
 
-		/* Limit the data size to the remaining space in the packet buffer */
-		const size_t remaining_size = GDB_PACKET_BUFFER_SIZE - packet->size;
-		data_size = MIN(data_size, remaining_size);
+#ifndef DEBUG_GDB_IS_NOOP
+		/* Log packet for debugging */
+		DEBUG_GDB("%s: ", __func__);
+		gdb_packet_debug(NULL, preamble, preamble_size, false);
+		gdb_packet_debug(NULL, data, data_size, hex_data);
+		DEBUG_GDB("\n");
+#endif
 
-		/* Copy the data into the packet buffer */
-		if (hex_data)
-			hexify(packet->data + packet->size, data, data_size / 2U);
-		else
-			memcpy(packet->data + packet->size, data, data_size);
-		packet->size += data_size;
+		if (acknowledged)
+			break;
 	}
-
-	/* Transmit the packet */
-	gdb_packet_send(packet);
 }
 
 void gdb_putpacket_str_f(const char *const fmt, ...)
@@ -407,18 +576,18 @@ void gdb_putpacket_str_f(const char *const fmt, ...)
 
 	/*
 	 * Format the string directly into the packet buffer
-	 * This considers GDB_PACKET_BUFFER_SIZE to be the maximum size of the string
+	 * This considers gdb_packet_buffer_size() to be the maximum size of the string
 	 * But it does not take into consideration the extra space needed for escaping
 	 * This is safe because the escaping is done during the actual packet transmission
 	 * but it will result in a packet larger than what we told GDB we could handle
 	 */
 	va_list ap;
 	va_start(ap, fmt);
-	vsnprintf(packet->data, sizeof(packet->data), fmt, ap);
+	vsnprintf(packet->data, gdb_packet_buffer_size() + 1U, fmt, ap);
 	va_end(ap);
 
 	/* Get the size of the formatted string */
-	packet->size = strnlen(packet->data, GDB_PACKET_BUFFER_SIZE);
+	packet->size = strnlen(packet->data, gdb_packet_buffer_size());
 
 	/* Transmit the packet */
 	gdb_packet_send(packet);
@@ -434,7 +603,7 @@ void gdb_put_notification_str(const char *const str)
 	 */
 	packet->notification = true;
 
-	packet->size = strnlen(str, GDB_PACKET_BUFFER_SIZE);
+	packet->size = strnlen(str, gdb_packet_buffer_size());
 	memcpy(packet->data, str, packet->size);
 
 	/* Transmit the packet */
@@ -25,13 +25,12 @@
 #include "general.h"
 #include "hex_utils.h"
 
+static const char hex_digits[16] = "0123456789ABCDEF";
+
 char hex_digit(const uint8_t value)
 {
-	char digit = (char)value;
-	if (value > 9U)
-		digit += 'A' - '0' - 10U;
-	digit += '0';
-	return digit;
+	/* A table lookup avoids the branch, which matters as this sits in the packet encoding hot path */
+	return hex_digits[value & 0xfU];
 }
 
 char *hexify(char *const dst, const void *const buf, const size_t size)
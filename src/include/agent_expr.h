@@ -0,0 +1,79 @@
+/*
+ * This file is part of the Black Magic Debug project.
+ *
+ * Copyright (C) 2026 1BitSquared <info@1bitsquared.com>
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived from
+ *    this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef INCLUDE_AGENT_EXPR_H
+#define INCLUDE_AGENT_EXPR_H
+
+#include "target.h"
+
+/* Longest agent expression accepted from GDB, in bytes of bytecode */
+#define AGENT_EXPR_MAX_LENGTH 256U
+/* Deepest the evaluation stack is allowed to get */
+#define AGENT_EXPR_STACK_DEPTH 32U
+
+/*
+ * A GDB agent expression - a little stack machine program GDB compiles breakpoint conditions
+ * (and tracepoint actions) into so they can be run on the probe without a round trip to GDB.
+ * Expressions are kept as singly linked lists, as a breakpoint can have several conditions.
+ */
+typedef struct agent_expr agent_expr_s;
+
+struct agent_expr {
+	agent_expr_s *next;
+	size_t length;
+	uint8_t bytecode[];
+};
+
+/*
+ * Parse an expression in the "len,bytes" form GDB sends them in, where len is the length of
+ * the bytecode in hex and bytes is the bytecode itself, hex encoded. On success, rest is
+ * pointed at the first character after the expression.
+ */
+agent_expr_s *agent_expr_parse(const char *input, const char **rest);
+/* Free a whole list of expressions */
+void agent_expr_free(agent_expr_s *expr);
+
+/*
+ * Run an expression against the halted target, leaving the value on top of the stack when
+ * it ends in result. Returns false if the expression could not be run to completion.
+ */
+bool agent_expr_eval(target_s *target, const agent_expr_s *expr, uint64_t *result);
+
+/* Called by the trace operations to record a block of target memory when an expression is run as a tracepoint action */
+typedef bool (*agent_expr_collect_f)(void *context, target_addr64_t addr, size_t len);
+/*
+ * Run an expression as a tracepoint action, where the trace operations collect memory via the callback
+ * given rather than being skipped over. Returns false if the expression could not be run to completion.
+ */
+bool agent_expr_collect(target_s *target, const agent_expr_s *expr, agent_expr_collect_f collect, void *context);
+
+#endif /* INCLUDE_AGENT_EXPR_H */
@@ -34,4 +34,24 @@ char gdb_if_getchar_to(uint32_t timeout);
 void gdb_if_putchar(char c, bool flush);
 void gdb_if_flush(bool force);
 
+#if CONFIG_BMDA == 1
+/* Multi-target server mode support - one GDB server port (session) per target */
+#define GDB_IF_MAX_SESSIONS 16U
+
+typedef enum gdb_if_event {
+	GDB_IF_EVENT_NONE,
+	GDB_IF_EVENT_CONNECTED,
+	GDB_IF_EVENT_DATA,
+} gdb_if_event_e;
+
+int gdb_if_init_sessions(size_t count);
+/* Select which session the other gdb_if_* calls act on */
+void gdb_if_session_select(size_t index);
+/*
+ * Wait up to timeout milliseconds (or forever if negative) for something to happen on any of the sessions,
+ * filling in events (one per session) and returning how many of them need attention
+ */
+size_t gdb_if_wait(int timeout, gdb_if_event_e *events);
+#endif
+
 #endif /* INCLUDE_GDB_IF_H */
@@ -26,9 +26,24 @@
 
 extern bool gdb_target_running;
 extern target_s *cur_target;
+extern bool gdb_non_stop;
 
 void gdb_poll_target(void);
+/* Request the running target be halted on GDB's behalf (^C) */
+void gdb_halt_target(void);
 void gdb_main(const gdb_packet_s *packet);
 int32_t gdb_main_loop(target_controller_s *tc, const gdb_packet_s *packet, bool in_syscall);
+/* Drop every reference GDB holds to targets it isn't attached to, as the target list is being freed */
+void gdb_forget_targets(void);
+
+#if CONFIG_BMDA == 1
+/* Multi-target server mode - set up a GDB session per target found, returning how many there are */
+size_t gdb_sessions_init(void);
+size_t gdb_session_count(void);
+/* Swap the given session's state in, making it the one gdb_main() and friends act on */
+void gdb_session_switch(size_t index);
+/* Let the active session know a GDB just connected to it */
+void gdb_session_connected(void);
+#endif
 
 #endif /* INCLUDE_GDB_MAIN_H */
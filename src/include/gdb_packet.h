@@ -31,6 +31,15 @@
 #define GDB_PACKET_BUFFER_SIZE 1024U
 #endif
 
+#if CONFIG_BMDA == 1
+/*
+ * BMDA allocates its packet buffer at startup, with GDB_PACKET_BUFFER_SIZE as the
+ * minimum size, these define the default and the largest size it may be configured to
+ */
+#define GDB_PACKET_BUFFER_SIZE_DEFAULT 16384U
+#define GDB_PACKET_BUFFER_SIZE_MAX     65536U
+#endif
+
 /* Limit out packet string size to the maximum packet size before hexifying */
 #define GDB_OUT_PACKET_MAX_SIZE ((GDB_PACKET_BUFFER_SIZE - 1U) / 2U)
 
@@ -43,6 +52,11 @@
 #define GDB_PACKET_NOTIFICATION_START '%'
 #define GDB_PACKET_ESCAPE_XOR         (0x20U)
 
+/* Run-length encoding, the count character is the number of extra repeats plus this bias */
+#define GDB_PACKET_RUNLENGTH_BIAS 29U
+#define GDB_PACKET_RUNLENGTH_MIN  3U  /* Shortest run worth encoding, as the encoding takes two characters */
+#define GDB_PACKET_RUNLENGTH_MAX  97U /* Longest run that keeps the count character printable ('~') */
+
 #define GDB_PACKET_RETRIES 3U /* Number of times to retry sending a packet */
 
 #if defined(__MINGW32__) || defined(__MINGW64__) || defined(__CYGWIN__)
@@ -57,23 +71,49 @@
  * GDB packet structure
  * This is used to store the packet data during transmission and reception
  * This will be statically allocated and aligned to 8 bytes to allow the remote protocol to re-use it
+ * (BMDA instead allocates the data buffer on the heap, sized at startup by gdb_packet_buffer_alloc())
  * A single packet instance exists in the system and is re-used for all packet operations
  * This means transmiting a packet will invalidate any previously obtained packets
  * Do not use this structure directly or you might risk runing out of memory
  */
 typedef struct gdb_packet {
+#if CONFIG_BMDA == 1
+	char *data; /* Packet data, gdb_packet_buffer_size() + 1 bytes */
+#else
 	/* Data must be first to ensure alignment */
 	char data[GDB_PACKET_BUFFER_SIZE + 1U]; /* Packet data */
-	size_t size;                            /* Packet data size */
-	bool notification;                      /* Notification packet */
+#endif
+	size_t size;       /* Packet data size */
+	bool notification; /* Notification packet */
 } gdb_packet_s;
 
 /* GDB packet transmission configuration */
 void gdb_set_noackmode(bool enable);
 bool gdb_noackmode(void);
 
+/*
+ * Single-pass GDB packet encoder
+ * This run-length encodes, escapes and checksums data as it is fed in, writing the result
+ * straight out through gdb_if_putchar() without staging it in the packet buffer.
+ * gdb_packet_encode_end() returns whether the packet was acknowledged (or needs no acknowledgement),
+ * if it returns false the caller should encode the packet again to retransmit it.
+ */
+typedef struct gdb_packet_encoder {
+	size_t run_length; /* Number of run_char characters pending output */
+	char run_char;     /* Character the pending run consists of */
+	uint8_t checksum;  /* Checksum of the encoded data written so far */
+	bool notification; /* Notification packet */
+} gdb_packet_encoder_s;
+
+void gdb_packet_encode_begin(gdb_packet_encoder_s *encoder, bool notification);
+void gdb_packet_encode_data(gdb_packet_encoder_s *encoder, const void *data, size_t size);
+void gdb_packet_encode_hex(gdb_packet_encoder_s *encoder, const void *data, size_t size);
+bool gdb_packet_encode_end(gdb_packet_encoder_s *encoder);
+
 /* Raw GDB packet transmission */
 gdb_packet_s *gdb_packet_receive(void);
+/* Receive the rest of a packet whose start character ('$') the caller has already read */
+gdb_packet_s *gdb_packet_receive_started(void);
 void gdb_packet_send(const gdb_packet_s *packet);
 
 void gdb_packet_ack(bool ack);
@@ -81,6 +121,16 @@ bool gdb_packet_get_ack(uint32_t timeout);
 
 char *gdb_packet_buffer(void);
 
+#if CONFIG_BMDA == 1
+bool gdb_packet_buffer_alloc(size_t size);
+size_t gdb_packet_buffer_size(void);
+#else
+static inline size_t gdb_packet_buffer_size(void)
+{
+	return GDB_PACKET_BUFFER_SIZE;
+}
+#endif
+
 /* Convenience wrappers */
 void gdb_put_packet(const char *preamble, size_t preamble_size, const char *data, size_t data_size, bool hex_data);
 
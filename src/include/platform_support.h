@@ -34,14 +34,33 @@
 
 #if CONFIG_BMDA == 1
 void platform_init(int argc, char **argv);
-void platform_pace_poll(void);
+/*
+ * Poll scheduling for while the target runs: halt polls back off exponentially from the configured minimum
+ * interval to the maximum, until platform_poll_resumed() is called when the target is next resumed.
+ * platform_poll_wait_time() gives how long the main loop may block waiting on GDB before a poll is due.
+ * platform_poll_wake_fd() gives a file descriptor to also wait on, which wakes the loop for a poll early, or -1.
+ */
+void platform_poll_resumed(void);
+bool platform_poll_halt_due(void);
+uint32_t platform_poll_wait_time(void);
+int platform_poll_wake_fd(void);
 
 #define BMD_CONST_FUNC
 #else
 void platform_init(void);
 
-static inline void platform_pace_poll(void)
+static inline void platform_poll_resumed(void)
+{
+}
+
+static inline bool platform_poll_halt_due(void)
+{
+	return true;
+}
+
+static inline uint32_t platform_poll_wait_time(void)
 {
+	return 0U;
 }
 
 #define BMD_CONST_FUNC __attribute__((const))
@@ -0,0 +1,110 @@
+/*
+ * This file is part of the Black Magic Debug project.
+ *
+ * Copyright (C) 2026 1BitSquared <info@1bitsquared.com>
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived from
+ *    this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef INCLUDE_RTOS_H
+#define INCLUDE_RTOS_H
+
+#include "target.h"
+
+/* Thread ID reported for the CPU itself when no RTOS is running on the target */
+#define RTOS_THREAD_ID_CPU 1U
+
+/* Largest number of threads that will be reported, and the longest thread name kept */
+#define RTOS_MAX_THREADS     64U
+#define RTOS_THREAD_NAME_LEN 16U
+
+#ifdef ENABLE_RTOS
+/*
+ * Handle a qSymbol packet (given without the "qSymbol:" prefix), which is how GDB tells us it can
+ * look up symbols and then feeds us their values one at a time. Once all the symbols an RTOS needs
+ * have been seen, that RTOS's threads are presented to GDB in place of the single CPU thread.
+ */
+void rtos_symbol_lookup(target_s *target, const char *packet, size_t length);
+/* Let the RTOS layer know the target just halted, so the thread list must be re-read */
+void rtos_target_halted(target_s *target);
+/* Drop any RTOS state held for the target */
+void rtos_target_destroyed(const target_s *target);
+
+/* The thread that is running on the CPU (RTOS_THREAD_ID_CPU if there is no RTOS) */
+uint32_t rtos_current_thread(target_s *target);
+/* Walk the thread list - returns false once index runs past the end of the list */
+bool rtos_thread_id(target_s *target, size_t index, uint32_t *thread_id);
+bool rtos_thread_exists(target_s *target, uint32_t thread_id);
+/* A human readable description of the thread, for qThreadExtraInfo */
+bool rtos_thread_describe(target_s *target, uint32_t thread_id, char *buffer, size_t buffer_size);
+/*
+ * Read the registers (in the same layout as target_regs_read()) of a thread that is not running,
+ * by unstacking the context the RTOS saved when it switched the thread out
+ */
+bool rtos_thread_regs_read(target_s *target, uint32_t thread_id, void *data);
+
+#else
+/* Without RTOS support, the CPU is the only thread there is */
+static inline uint32_t rtos_current_thread(target_s *const target)
+{
+	(void)target;
+	return RTOS_THREAD_ID_CPU;
+}
+
+static inline bool rtos_thread_id(target_s *const target, const size_t index, uint32_t *const thread_id)
+{
+	(void)target;
+	*thread_id = RTOS_THREAD_ID_CPU;
+	return index == 0U;
+}
+
+static inline bool rtos_thread_exists(target_s *const target, const uint32_t thread_id)
+{
+	(void)target;
+	return thread_id == RTOS_THREAD_ID_CPU;
+}
+
+static inline bool rtos_thread_describe(
+	target_s *const target, const uint32_t thread_id, char *const buffer, const size_t buffer_size)
+{
+	(void)target;
+	(void)thread_id;
+	(void)buffer;
+	(void)buffer_size;
+	return false;
+}
+
+static inline bool rtos_thread_regs_read(target_s *const target, const uint32_t thread_id, void *const data)
+{
+	(void)target;
+	(void)thread_id;
+	(void)data;
+	return false;
+}
+#endif
+
+#endif /* INCLUDE_RTOS_H */
@@ -61,5 +61,7 @@ typedef struct rtt_channel {
 extern rtt_channel_s rtt_channel[MAX_RTT_CHAN];
 
 void poll_rtt(target_s *cur_target);
+/* Time in ms until poll_rtt() next wants to access the target */
+uint32_t rtt_poll_wait_time(void);
 
 #endif /* INCLUDE_RTT_H */
@@ -60,6 +60,8 @@ bool onboard_flash_scan(void);
 size_t target_foreach(void (*callback)(size_t index, target_s *target, void *context), void *context);
 target_s *target_list_get_last(void);
 void target_list_free(void);
+/* Register a function to be called once the target list has been freed, for dropping references to the targets */
+void target_list_set_free_callback(void (*callback)(void));
 
 target_s *target_new(void);
 
@@ -69,12 +71,19 @@ target_s *target_attach_n(size_t n, target_controller_s *controller);
 void target_detach(target_s *target);
 
 /* Memory access functions */
-bool target_mem_map(target_s *target, char *buf, size_t len);
+const char *target_mem_map(target_s *target, size_t *length);
 bool target_mem32_read(target_s *target, void *dest, target_addr_t src, size_t len);
 bool target_mem64_read(target_s *target, void *dest, target_addr64_t src, size_t len);
 bool target_mem32_write(target_s *target, target_addr_t dest, const void *src, size_t len);
 bool target_mem64_write(target_s *target, target_addr64_t dest, const void *src, size_t len);
 bool target_mem_access_needs_halt(target_s *target);
+bool target_mem32_crc32(target_s *target, uint32_t *result, target_addr_t base, size_t len);
+/* Search memory for a pattern, returns 1 and where it is if found, 0 if not, or -1 if the memory can't be read */
+int target_mem32_search(target_s *target, target_addr_t start, uint32_t length, const uint8_t *pattern,
+	size_t pattern_len, target_addr_t *found);
+/* Cached memory access for reads made on a debugger's behalf while the target is halted */
+bool target_mem32_read_cached(target_s *target, void *dest, target_addr_t src, size_t len);
+void target_mem_cache_invalidate(void);
 /* Flash memory access functions */
 bool target_flash_erase(target_s *target, target_addr_t addr, size_t len);
 bool target_flash_write(target_s *target, target_addr_t dest, const void *src, size_t len);
@@ -83,11 +92,15 @@ bool target_flash_mass_erase(target_s *target);
 
 /* Register access functions */
 size_t target_regs_size(target_s *target);
-const char *target_regs_description(target_s *target);
+const char *target_regs_description(target_s *target, size_t *length);
+/* Free the memory map and target description built for GDB, they are rebuilt if asked for again */
+void target_xml_release(target_s *target);
 void target_regs_read(target_s *target, void *data);
 void target_regs_write(target_s *target, const void *data);
 size_t target_reg_read(target_s *target, uint32_t reg, void *data, size_t max);
 size_t target_reg_write(target_s *target, uint32_t reg, const void *data, size_t size);
+size_t target_regs_expedite(target_s *target, char *buffer, size_t buffer_size);
+bool target_pc_read(target_s *target, target_addr64_t *pc);
 
 /* Halt/resume functions */
 typedef enum target_halt_reason {
@@ -124,6 +137,8 @@ typedef enum target_breakwatch {
 
 int target_breakwatch_set(target_s *target, target_breakwatch_e type, target_addr_t addr, size_t len);
 int target_breakwatch_clear(target_s *target, target_breakwatch_e type, target_addr_t addr, size_t len);
+/* The breakpoint kind GDB would use for the instruction at the given address */
+size_t target_breakpoint_kind(target_s *target, target_addr_t addr);
 
 /* Command interpreter */
 void target_command_help(target_s *target);
@@ -0,0 +1,128 @@
+/*
+ * This file is part of the Black Magic Debug project.
+ *
+ * Copyright (C) 2026 1BitSquared <info@1bitsquared.com>
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived from
+ *    this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef INCLUDE_TRACEPOINT_H
+#define INCLUDE_TRACEPOINT_H
+
+#include "target.h"
+
+/*
+ * Default size of the buffer trace frames are collected into. Probes have little RAM to spare so
+ * get a small one unless the platform says otherwise, while BMDA can afford to keep a lot of frames.
+ */
+#ifndef TRACEPOINT_BUFFER_SIZE
+#if CONFIG_BMDA == 1
+#define TRACEPOINT_BUFFER_SIZE (1024U * 1024U)
+#else
+#define TRACEPOINT_BUFFER_SIZE 4096U
+#endif
+#endif
+
+#ifdef ENABLE_TRACEPOINTS
+/*
+ * Handle a tracepoint set (QT*) or query (qT*) packet, given without the prefix. These replies are
+ * all sent from here, which is what lets GDB define tracepoints, run the trace experiment and look
+ * through the frames collected.
+ */
+void tracepoint_set_packet(target_s *target, const char *packet, size_t length);
+void tracepoint_query_packet(target_s *target, const char *packet, size_t length);
+
+/*
+ * Let the trace experiment know the target halted on a breakpoint, collecting a trace frame if it's one of
+ * ours. Returns true if it was a tracepoint, in which case resume says whether the breakpoint is still
+ * planted and must be stepped over - the experiment may have just stopped, taking its breakpoints with it.
+ * The address and kind of the breakpoint are returned for stepping over it.
+ */
+bool tracepoint_hit(target_s *target, target_addr_t *addr, size_t *kind, bool *resume_over);
+/* Drop the trace experiment if it belongs to the target */
+void tracepoint_target_destroyed(const target_s *target);
+
+/* Whether GDB is looking at a trace frame, in which case register and memory reads come from it */
+bool tracepoint_frame_selected(void);
+/*
+ * Read the registers collected in the selected frame as hex, with 'x's in place of any that were not.
+ * The buffer for all of them must be twice target_regs_size() plus one for the terminating nul.
+ */
+void tracepoint_frame_regs_read(target_s *target, char *hex);
+/* Read a single register from the selected frame as hex, in the same way */
+void tracepoint_frame_reg_read(target_s *target, uint32_t reg, char *hex, size_t hex_size);
+/* Read memory in the selected frame, returns true on error as target_mem32_read() does */
+bool tracepoint_frame_mem_read(target_s *target, void *dest, target_addr_t src, size_t len);
+
+#else
+static inline bool tracepoint_hit(
+	target_s *const target, target_addr_t *const addr, size_t *const kind, bool *const resume_over)
+{
+	(void)target;
+	(void)addr;
+	(void)kind;
+	(void)resume_over;
+	return false;
+}
+
+static inline void tracepoint_target_destroyed(const target_s *const target)
+{
+	(void)target;
+}
+
+static inline bool tracepoint_frame_selected(void)
+{
+	return false;
+}
+
+static inline void tracepoint_frame_regs_read(target_s *const target, char *const hex)
+{
+	(void)target;
+	(void)hex;
+}
+
+static inline void tracepoint_frame_reg_read(
+	target_s *const target, const uint32_t reg, char *const hex, const size_t hex_size)
+{
+	(void)target;
+	(void)reg;
+	(void)hex;
+	(void)hex_size;
+}
+
+static inline bool tracepoint_frame_mem_read(
+	target_s *const target, void *const dest, const target_addr_t src, const size_t len)
+{
+	(void)target;
+	(void)dest;
+	(void)src;
+	(void)len;
+	return true;
+}
+#endif
+
+#endif /* INCLUDE_TRACEPOINT_H */
@@ -37,20 +37,24 @@ static void bmp_poll_loop(void)
 {
 	SET_IDLE_STATE(false);
 	while (gdb_target_running && cur_target) {
-		gdb_poll_target();
+		if (platform_poll_halt_due())
+			gdb_poll_target();
 
 		// Check again, as `gdb_poll_target()` may
 		// alter these variables.
 		if (!gdb_target_running || !cur_target)
 			break;
-		char c = gdb_if_getchar_to(0);
+		/* Sleep on the GDB connection until either GDB talks to us or the next poll of the target is due */
+		char c = gdb_if_getchar_to(platform_poll_wait_time());
 		if (c == '\x03' || c == '\x04')
-			target_halt_request(cur_target);
+			gdb_halt_target();
+		/* In non-stop mode GDB may keep talking to us while the target runs */
+		else if (c == GDB_PACKET_START && gdb_non_stop)
+			gdb_main(gdb_packet_receive_started());
 #ifdef ENABLE_RTT
 		else if (rtt_enabled)
 			poll_rtt(cur_target);
 #endif
-		platform_pace_poll();
 	}
 
 	SET_IDLE_STATE(true);
@@ -62,18 +66,69 @@ static void bmp_poll_loop(void)
 }
 
 #if CONFIG_BMDA == 1
+/*
+ * Multi-target server mode: every target has its own GDB session on its own port, so rather than blocking
+ * on a single connection, go round the sessions polling running targets for halts and handling whatever
+ * each connected GDB has sent us. Only one session is swapped in at a time, while it is being serviced.
+ */
+static void bmda_session_poll_loop(void)
+{
+	const size_t sessions = gdb_session_count();
+	const bool halt_poll_due = platform_poll_halt_due();
+	bool targets_running = false;
+	for (size_t idx = 0U; idx < sessions; ++idx) {
+		gdb_session_switch(idx);
+		if (!gdb_target_running || !cur_target)
+			continue;
+		if (halt_poll_due)
+			gdb_poll_target();
+		if (gdb_target_running && cur_target)
+			targets_running = true;
+	}
+
+	/* Sleep until a GDB needs us, or until the next halt poll is due if there are running targets */
+	const int timeout = targets_running ? (int)MIN(platform_poll_wait_time(), (uint32_t)INT32_MAX) : -1;
+	gdb_if_event_e events[GDB_IF_MAX_SESSIONS];
+	const size_t ready = gdb_if_wait(timeout, events);
+	if (!ready)
+		return;
+
+	for (size_t idx = 0U; idx < sessions; ++idx) {
+		if (events[idx] == GDB_IF_EVENT_NONE)
+			continue;
+		gdb_session_switch(idx);
+		if (events[idx] == GDB_IF_EVENT_CONNECTED)
+			gdb_session_connected();
+		else if (gdb_target_running && cur_target) {
+			const char c = gdb_if_getchar_to(0);
+			if (c == '\x03' || c == '\x04')
+				gdb_halt_target();
+			else if (c == GDB_PACKET_START && gdb_non_stop)
+				gdb_main(gdb_packet_receive_started());
+		} else
+			gdb_main(gdb_packet_receive());
+	}
+}
+
 int main(int argc, char **argv)
 {
+	target_list_set_free_callback(gdb_forget_targets);
 	platform_init(argc, argv);
 #else
 int main(void)
 {
+	target_list_set_free_callback(gdb_forget_targets);
 	platform_init();
 #endif
 
 	while (true) {
 		TRY (EXCEPTION_ALL) {
-			bmp_poll_loop();
+#if CONFIG_BMDA == 1
+			if (gdb_session_count())
+				bmda_session_poll_loop();
+			else
+#endif
+				bmp_poll_loop();
 		}
 		CATCH () {
 		default:
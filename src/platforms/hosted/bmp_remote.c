@@ -33,6 +33,7 @@
 #include "remote/protocol_v2.h"
 #include "remote/protocol_v3.h"
 #include "remote/protocol_v4.h"
+#include "remote/protocol_v5.h"
 
 #ifndef _MSC_VER
 #include <sys/time.h>
@@ -41,6 +42,20 @@
 #include "adiv5.h"
 
 bmp_remote_protocol_s remote_funcs;
+remote_halt_watch_s remote_halt_watch;
+
+int platform_buffer_read(void *const data, const size_t size)
+{
+	const char *const buffer = (const char *)data;
+	while (true) {
+		const int length = platform_buffer_read_response(data, size);
+		if (length < 1 || buffer[0] != REMOTE_RESP_HALT)
+			return length;
+		/* A halt watch firing can cross paths with a request, so note it down and keep looking for the response */
+		remote_halt_watch.armed = false;
+		remote_halt_watch.fired = true;
+	}
+}
 
 uint64_t remote_decode_response(const char *const response, const size_t digits)
 {
@@ -104,6 +119,10 @@ bool remote_init(const bool power_up)
 			if (!remote_v4_init())
 				return false;
 			break;
+		case 5:
+			if (!remote_v5_init())
+				return false;
+			break;
 		default:
 			DEBUG_ERROR("Unknown remote protocol version %" PRIu64 ", aborting\n", version);
 			return false;
@@ -218,6 +237,9 @@ void remote_adiv5_dp_init(adiv5_debug_port_s *const dp)
 
 void remote_adiv6_dp_init(adiv5_debug_port_s *const dp)
 {
+	/* The halt watch and batches only know how to address ADIv5 APs */
+	dp->halt_watch = NULL;
+	dp->batch_run = NULL;
 	/* Try to initialise ADIv6 acceleration */
 	if (remote_funcs.adiv6_init)
 		remote_funcs.adiv6_init(dp);
@@ -271,3 +293,41 @@ uint8_t remote_spi_xfer(spi_bus_e bus, uint8_t value)
 	DEBUG_ERROR("SPI protocol unsupported by probe, please upgrade your firmware");
 	return UINT8_MAX;
 }
+
+void remote_spi_read(const spi_bus_e bus, const uint8_t device, const uint16_t command, const target_addr32_t address,
+	void *const buffer, const size_t length)
+{
+	if (remote_funcs.spi_read)
+		remote_funcs.spi_read(bus, device, command, address, buffer, length);
+	else {
+		DEBUG_ERROR("SPI protocol unsupported by probe, please upgrade your firmware");
+		memset(buffer, 0, length);
+	}
+}
+
+void remote_spi_write(const spi_bus_e bus, const uint8_t device, const uint16_t command, const target_addr32_t address,
+	const void *const buffer, const size_t length)
+{
+	if (remote_funcs.spi_write)
+		remote_funcs.spi_write(bus, device, command, address, buffer, length);
+	else
+		DEBUG_ERROR("SPI protocol unsupported by probe, please upgrade your firmware");
+}
+
+void remote_spi_run_command(
+	const spi_bus_e bus, const uint8_t device, const uint16_t command, const target_addr32_t address)
+{
+	if (remote_funcs.spi_run_command)
+		remote_funcs.spi_run_command(bus, device, command, address);
+	else
+		DEBUG_ERROR("SPI protocol unsupported by probe, please upgrade your firmware");
+}
+
+bool remote_spi_program_page(const spi_bus_e bus, const uint8_t device, const uint16_t command,
+	const target_addr32_t address, const void *const buffer, const size_t length)
+{
+	if (remote_funcs.spi_program_page)
+		return remote_funcs.spi_program_page(bus, device, command, address, buffer, length);
+	DEBUG_ERROR("SPI protocol unsupported by probe, please upgrade your firmware");
+	return false;
+}
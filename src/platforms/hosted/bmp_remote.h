@@ -36,6 +36,14 @@
 
 #define REMOTE_MAX_MSG_SIZE 1024U
 
+typedef struct remote_halt_watch {
+	bool armed;
+	bool fired;
+	uint8_t dev_index;
+	uint8_t apsel;
+	target_addr64_t address;
+} remote_halt_watch_s;
+
 typedef struct bmp_remote_protocol {
 	bool (*swd_init)(void);
 	bool (*jtag_init)(void);
@@ -50,12 +58,28 @@ typedef struct bmp_remote_protocol {
 	bool (*spi_deinit)(spi_bus_e bus);
 	bool (*spi_chip_select)(uint8_t device_select);
 	uint8_t (*spi_xfer)(spi_bus_e bus, uint8_t value);
+	void (*spi_read)(
+		spi_bus_e bus, uint8_t device, uint16_t command, target_addr32_t address, void *buffer, size_t length);
+	void (*spi_write)(
+		spi_bus_e bus, uint8_t device, uint16_t command, target_addr32_t address, const void *buffer, size_t length);
+	void (*spi_run_command)(spi_bus_e bus, uint8_t device, uint16_t command, target_addr32_t address);
+	bool (*spi_program_page)(
+		spi_bus_e bus, uint8_t device, uint16_t command, target_addr32_t address, const void *buffer, size_t length);
 } bmp_remote_protocol_s;
 
 extern bmp_remote_protocol_s remote_funcs;
+/* State of the probe-side halt watch, see remote_v4_adiv5_halt_watch() */
+extern remote_halt_watch_s remote_halt_watch;
 
 bool platform_buffer_write(const void *data, size_t size);
+/* Read the response to a request, skipping over any unsolicited halt events from the probe */
 int platform_buffer_read(void *data, size_t size);
+/* Read the next response from the probe, whatever it is */
+int platform_buffer_read_response(void *data, size_t size);
+/* Check, without waiting, if the probe has sent us anything */
+bool platform_buffer_pending(void);
+/* The file descriptor of the link to the probe, for waiting on, or -1 if it can't be waited on */
+int platform_buffer_fd(void);
 
 bool remote_init(bool power_up);
 bool remote_swd_init(void);
@@ -79,6 +103,13 @@ bool remote_spi_deinit(spi_bus_e bus);
 
 bool remote_spi_chip_select(uint8_t device_select);
 uint8_t remote_spi_xfer(spi_bus_e bus, uint8_t value);
+void remote_spi_read(
+	spi_bus_e bus, uint8_t device, uint16_t command, target_addr32_t address, void *buffer, size_t length);
+void remote_spi_write(
+	spi_bus_e bus, uint8_t device, uint16_t command, target_addr32_t address, const void *buffer, size_t length);
+void remote_spi_run_command(spi_bus_e bus, uint8_t device, uint16_t command, target_addr32_t address);
+bool remote_spi_program_page(
+	spi_bus_e bus, uint8_t device, uint16_t command, target_addr32_t address, const void *buffer, size_t length);
 
 uint64_t remote_decode_response(const char *response, size_t digits);
 
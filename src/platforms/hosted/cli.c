@@ -145,7 +145,7 @@ static void cl_help(char **argv)
 	/* clang-format off */
 	DEBUG_INFO("\n"
 			   "Usage: %s [-h | -l | [-v BITMASK] [-O] [-d PATH | -P NUMBER | -s SERIAL | -c TYPE]\n"
-			   "\t[-n NUMBER] [-j | -A] [-C] [-t | -T] [-e] [-p] [-R[h]] [-H] [-M STRING ...]\n"
+			   "\t[-n NUMBER] [-j | -A] [-C] [-t | -T] [-e] [-p] [-R[h]] [-H] [-G] [-B SIZE] [-M STRING ...]\n"
 			   "\t[-f | -m] [-E | -w | -V | -r] [-a ADDR] [-S number] [file]]\n"
 			   "\n"
 			   "The default is to start a debug server at localhost:2000\n\n"
@@ -167,7 +167,7 @@ static void cl_help(char **argv)
 			   GPIOD_PROBE_SELECTION_HELP
 			   "\n"
 			   "General configuration options: [-n NUMBER] [-j] [-C] [-t | -T] [-e] [-p] [-R[h]]\n"
-			   "\t\t[-H] [-M STRING ...]\n"
+			   "\t\t[-H] [-G] [-B SIZE] [-M STRING ...]\n"
 			   "\t-n, --number     Select the target device at the given position in the\n"
 			   "\t                   scan chain (use the -t option to get a scan chain listing)\n"
 			   "\t-j, --jtag       Use JTAG instead of SWD\n"
@@ -175,6 +175,7 @@ static void cl_help(char **argv)
 			   "\t-C, --hw-reset   Connect to target under hardware reset\n"
 			   "\t-F, --fast-poll  Poll the target for execution status at maximum speed at\n"
 			   "\t                  the expense of increased CPU and USB resource utilisation.\n"
+			   "\t-i, --halt-poll  Halt poll interval MIN[,MAX] in ms (default 1,32)\n"
 			   "\t-t, --list-chain Perform a chain scan and display information about the\n"
 			   "\t                   connected devices\n"
 			   "\t-T, --timing     Perform continues read- or write-back of a value to allow\n"
@@ -185,6 +186,11 @@ static void cl_help(char **argv)
 			   "\t-R, --reset      Reset the device. If followed by 'h', this will be done using\n"
 			   "\t                   the hardware reset line instead of over the debug link\n"
 			   "\t-H, --high-level Do not use the high level command API (bmp-remote)\n"
+			   "\t-G, --multi-target\n"
+			   "\t                 Serve each target found at startup on its own port\n"
+			   "\t                   from 2000 up, each with its own GDB session\n"
+			   "\t-B, --packet-size\n"
+			   "\t                 Maximum GDB packet size in bytes, 1k to 64k (default 16k)\n"
 			   "\t-M, --monitor    Run target-specific monitor commands. This option\n"
 			   "\t                   can be repeated for as many commands you wish to run.\n"
 			   "\t                   If the command contains spaces, use quotes around the\n"
@@ -223,6 +229,7 @@ static const getopt_option_s long_options[] = {
 	{"serial", required_argument, NULL, 's'},
 	{"ftdi-type", required_argument, NULL, 'c'},
 	{"fast-poll", no_argument, NULL, 'F'},
+	{"halt-poll", required_argument, NULL, 'i'},
 	{"number", required_argument, NULL, 'n'},
 	{"jtag", no_argument, NULL, 'j'},
 	{"auto-scan", no_argument, NULL, 'A'},
@@ -233,6 +240,8 @@ static const getopt_option_s long_options[] = {
 	{"power", no_argument, NULL, 'p'},
 	{"reset", optional_argument, NULL, 'R'},
 	{"high-level", no_argument, NULL, 'H'},
+	{"multi-target", no_argument, NULL, 'G'},
+	{"packet-size", required_argument, NULL, 'B'},
 	{"monitor", required_argument, NULL, 'M'},
 	{"freq", required_argument, NULL, 'f'},
 	{"multi-drop", required_argument, NULL, 'm'},
@@ -249,6 +258,10 @@ static const getopt_option_s long_options[] = {
 	{NULL, 0, NULL, 0},
 };
 
+/* Default halt poll interval range in ms, see platform_poll_halt_due() */
+#define HALT_POLL_MIN_MS 1U
+#define HALT_POLL_MAX_MS 32U
+
 #ifdef ENABLE_GPIOD
 #define GPIOD_ARG_STR "g:"
 #else
@@ -263,9 +276,11 @@ void cl_init(bmda_cli_options_s *opt, int argc, char **argv)
 	opt->opt_max_frequency = 0;
 	opt->opt_scanmode = BMP_SCAN_SWD;
 	opt->opt_mode = BMP_MODE_DEBUG;
+	opt->opt_halt_poll_min_ms = HALT_POLL_MIN_MS;
+	opt->opt_halt_poll_max_ms = HALT_POLL_MAX_MS;
 	while (true) {
-		const int option =
-			getopt_long(argc, argv, "eEFhHv:Od:f:s:I:c:Cln:m:M:wVtTa:S:jApP:rR::k" GPIOD_ARG_STR, long_options, NULL);
+		const int option = getopt_long(
+			argc, argv, "eEFi:GhHB:v:Od:f:s:I:c:Cln:m:M:wVtTa:S:jApP:rR::k" GPIOD_ARG_STR, long_options, NULL);
 		if (option == -1)
 			break;
 
@@ -285,6 +300,14 @@ void cl_init(bmda_cli_options_s *opt, int argc, char **argv)
 		case 'H':
 			opt->opt_no_hl = true;
 			break;
+		case 'B':
+			if (optarg) {
+				char *endptr;
+				opt->opt_packet_size = strtoul(optarg, &endptr, 0);
+				if (endptr && (endptr[0] == 'k' || endptr[0] == 'K'))
+					opt->opt_packet_size *= 1024U;
+			}
+			break;
 		case 'v':
 			if (optarg) {
 				const char *end = optarg + strlen(optarg);
@@ -320,7 +343,22 @@ void cl_init(bmda_cli_options_s *opt, int argc, char **argv)
 				opt->opt_device = optarg;
 			break;
 		case 'F':
-			opt->fast_poll = true;
+			opt->opt_halt_poll_min_ms = 0U;
+			opt->opt_halt_poll_max_ms = 0U;
+			break;
+		case 'i':
+			if (optarg) {
+				char *rest = NULL;
+				opt->opt_halt_poll_min_ms = strtoul(optarg, &rest, 0);
+				opt->opt_halt_poll_max_ms = *rest == ',' ? strtoul(rest + 1U, &rest, 0) : opt->opt_halt_poll_min_ms;
+				if (*rest || opt->opt_halt_poll_max_ms < opt->opt_halt_poll_min_ms) {
+					DEBUG_ERROR("Invalid halt poll interval '%s', expected MIN[,MAX] with MIN <= MAX\n", optarg);
+					exit(1);
+				}
+			}
+			break;
+		case 'G':
+			opt->opt_multi_target = true;
 			break;
 		case 'f':
 			if (optarg) {
@@ -53,7 +53,7 @@ typedef struct bmda_cli_options {
 	bool opt_list_only;
 	bool opt_connect_under_reset;
 	bool external_resistor_swd;
-	bool fast_poll;
+	bool opt_multi_target;
 	bool opt_no_hl;
 	char *opt_flash_file;
 	char *opt_device;
@@ -67,12 +67,16 @@ typedef struct bmda_cli_options {
 	uint32_t opt_flash_start;
 	uint32_t opt_max_frequency;
 	size_t opt_flash_size;
+	size_t opt_packet_size;
+	uint32_t opt_halt_poll_min_ms;
+	uint32_t opt_halt_poll_max_ms;
 	char *opt_gpio_map;
 	bool opt_cmsisdap_allow_fallback;
 } bmda_cli_options_s;
 
 void cl_init(bmda_cli_options_s *opt, int argc, char **argv);
 int cl_execute(bmda_cli_options_s *opt);
+bool scan_for_targets(const bmda_cli_options_s *opt);
 bool serial_open(const bmda_cli_options_s *opt, const char *serial);
 void serial_close(void);
 
@@ -47,7 +47,7 @@ typedef signed int ssize_t;
 #include <arpa/inet.h>
 #include <netinet/in.h>
 #include <netinet/tcp.h>
-#include <sys/select.h>
+#include <poll.h>
 #include <fcntl.h>
 
 typedef int32_t socket_t;
@@ -73,6 +73,8 @@ typedef int32_t socket_t;
 #define DEFAULT_PORT 2000U
 static const uint16_t default_port = DEFAULT_PORT;
 static const uint16_t max_port = (DEFAULT_PORT + 4U);
+/* In multi-target server mode, how far past the default port we'll go looking for free ones */
+static const uint16_t max_session_port = (DEFAULT_PORT + 64U);
 
 #if defined(_WIN32) || defined(__CYGWIN__)
 const int op_would_block = WSAEWOULDBLOCK;
@@ -87,13 +89,43 @@ static inline int closesocket(const int s)
 }
 #endif
 
-static socket_t gdb_if_serv = INVALID_SOCKET;
-static socket_t gdb_if_conn = INVALID_SOCKET;
 bool shutdown_bmda = false;
 
 #define GDB_BUFFER_LEN 2048U
-static size_t gdb_buffer_used = 0U;
-static char gdb_buffer[GDB_BUFFER_LEN];
+/*
+ * Received data is read from the socket in as large a chunk as is available and then handed
+ * out a character at a time from the rx buffer, so a whole packet costs a single recv() rather than one per byte
+ */
+#define GDB_RX_BUFFER_LEN 16384U
+
+/* State for one GDB server port - the listening socket, the connection on it if any, and its buffers */
+typedef struct gdb_if_session {
+	socket_t serv;
+	socket_t conn;
+	size_t tx_used;
+	char tx_buffer[GDB_BUFFER_LEN];
+	size_t rx_begin;
+	size_t rx_end;
+	char rx_buffer[GDB_RX_BUFFER_LEN];
+} gdb_if_session_s;
+
+/*
+ * Normally only the first session is used. In multi-target server mode there's one per target, and
+ * the scheduler selects which of them the gdb_if_* calls below act on
+ */
+static gdb_if_session_s gdb_if_sessions[GDB_IF_MAX_SESSIONS] = {
+	{.serv = INVALID_SOCKET, .conn = INVALID_SOCKET},
+};
+static gdb_if_session_s *gdb_if_active = gdb_if_sessions;
+static size_t gdb_if_session_count = 1U;
+static bool gdb_if_multi_session = false;
+
+/* Result of waiting on the connection for more data */
+typedef enum gdb_if_rx_result {
+	GDB_IF_RX_DATA,
+	GDB_IF_RX_TIMEOUT,
+	GDB_IF_RX_CLOSED,
+} gdb_if_rx_result_e;
 
 typedef struct sockaddr sockaddr_s;
 typedef struct sockaddr_in sockaddr_in_s;
@@ -103,8 +135,11 @@ typedef struct addrinfo addrinfo_s;
 
 #if defined(_WIN32) || defined(__CYGWIN__)
 typedef ADDRESS_FAMILY sa_family_t;
+typedef WSAPOLLFD pollfd_s;
 /* This can strictly be any integral value as long as it's not 0. */
 #define O_NONBLOCK 1
+#else
+typedef struct pollfd pollfd_s;
 #endif
 
 static inline size_t family_to_size(const sa_family_t family)
@@ -229,49 +264,87 @@ static void socket_set_flags(const socket_t socket, const int flags)
 #endif
 }
 
-int gdb_if_init(void)
+/* Wait up to timeout milliseconds (or forever if negative) for the socket to become ready for the given events */
+static int socket_poll(const socket_t socket, const short events, const int timeout)
+{
+	pollfd_s poll_fd = {
+		.fd = socket,
+		.events = events,
+	};
+	while (true) {
+#if defined(_WIN32) || defined(__CYGWIN__)
+		const int result = WSAPoll(&poll_fd, 1U, timeout);
+#else
+		const int result = poll(&poll_fd, 1U, timeout);
+#endif
+		if (result < 0 && socket_error() == op_needs_retry)
+			continue;
+		if (result <= 0)
+			return result;
+		return poll_fd.revents;
+	}
+}
+
+static bool gdb_if_startup(void)
 {
 #if defined(_WIN32) || defined(__CYGWIN__)
 	WSADATA wsa_data = {0};
 	const int result = WSAStartup(MAKEWORD(2, 2), &wsa_data);
 	if (result != NO_ERROR) {
 		DEBUG_ERROR("WSAStartup failed with error: %d\n", result);
-		return -1;
+		return false;
 	}
 #endif
-	for (uint16_t port = default_port; port < max_port; ++port) {
-		const sockaddr_storage_s addr = sockaddr_prepare(port);
-		if (addr.ss_family == AF_UNSPEC) {
-			DEBUG_ERROR("Failed to get a suitable socket address\n");
-			return -1;
-		}
+	return true;
+}
 
-		gdb_if_serv = socket(addr.ss_family, SOCK_STREAM, IPPROTO_TCP);
-		if (gdb_if_serv == INVALID_SOCKET) {
-			display_socket_error(socket_error(), gdb_if_serv, "socket returned");
-			continue;
-		}
+/* Try to set up a listening socket on the given port, returning INVALID_SOCKET if that fails */
+static socket_t gdb_if_listen(const uint16_t port)
+{
+	const sockaddr_storage_s addr = sockaddr_prepare(port);
+	if (addr.ss_family == AF_UNSPEC) {
+		DEBUG_ERROR("Failed to get a suitable socket address\n");
+		return INVALID_SOCKET;
+	}
 
-		if (!socket_set_int_opt(gdb_if_serv, SOL_SOCKET, SO_REUSEADDR, 1) ||
-			!socket_set_int_opt(gdb_if_serv, IPPROTO_TCP, TCP_NODELAY, 1))
-			continue;
+	const socket_t serv = socket(addr.ss_family, SOCK_STREAM, IPPROTO_TCP);
+	if (serv == INVALID_SOCKET) {
+		display_socket_error(socket_error(), serv, "socket returned");
+		return INVALID_SOCKET;
+	}
 
-		if (addr.ss_family == AF_INET6) {
-			DEBUG_INFO("Setting V6ONLY to off for dual stack listening.\n");
-			if (!socket_set_int_opt(gdb_if_serv, IPPROTO_IPV6, IPV6_V6ONLY, 0))
-				DEBUG_WARN("Listening on IPv6 only.\n");
-		}
+	if (!socket_set_int_opt(serv, SOL_SOCKET, SO_REUSEADDR, 1) ||
+		!socket_set_int_opt(serv, IPPROTO_TCP, TCP_NODELAY, 1))
+		return INVALID_SOCKET;
 
-		if (bind(gdb_if_serv, (const sockaddr_s *)&addr, family_to_size(addr.ss_family)) == -1) {
-			handle_error(gdb_if_serv, "binding socket");
-			continue;
-		}
+	if (addr.ss_family == AF_INET6) {
+		DEBUG_INFO("Setting V6ONLY to off for dual stack listening.\n");
+		if (!socket_set_int_opt(serv, IPPROTO_IPV6, IPV6_V6ONLY, 0))
+			DEBUG_WARN("Listening on IPv6 only.\n");
+	}
 
-		if (listen(gdb_if_serv, 1) == -1) {
-			handle_error(gdb_if_serv, "listening on socket");
-			continue;
-		}
+	if (bind(serv, (const sockaddr_s *)&addr, family_to_size(addr.ss_family)) == -1) {
+		handle_error(serv, "binding socket");
+		return INVALID_SOCKET;
+	}
+
+	if (listen(serv, 1) == -1) {
+		handle_error(serv, "listening on socket");
+		return INVALID_SOCKET;
+	}
+	/* Make sure a connection dropped between polling and accepting it can't block us */
+	socket_set_flags(serv, socket_get_flags(serv) | O_NONBLOCK);
+	return serv;
+}
 
+int gdb_if_init(void)
+{
+	if (!gdb_if_startup())
+		return -1;
+	for (uint16_t port = default_port; port < max_port; ++port) {
+		gdb_if_active->serv = gdb_if_listen(port);
+		if (gdb_if_active->serv == INVALID_SOCKET)
+			continue;
 		DEBUG_WARN("Listening on TCP port: %d\n", port);
 		return 0;
 	}
@@ -280,82 +353,235 @@ int gdb_if_init(void)
 	return -1;
 }
 
-char gdb_if_getchar(void)
+int gdb_if_init_sessions(const size_t count)
 {
-	if (gdb_if_conn == INVALID_SOCKET) {
-		if (shutdown_bmda)
-			return '\x04';
-		const int flags = socket_get_flags(gdb_if_serv);
-		socket_set_flags(gdb_if_serv, flags | O_NONBLOCK);
-		gdb_if_conn = INVALID_SOCKET;
-		while (gdb_if_conn == INVALID_SOCKET) {
-			gdb_if_conn = accept(gdb_if_serv, NULL, NULL);
-			if (gdb_if_conn == INVALID_SOCKET) {
-				const int error = socket_error();
-				if (error == op_would_block) {
-					SET_IDLE_STATE(1);
-					platform_delay(100);
-				} else {
-					display_socket_error(error, gdb_if_serv, "accepting connection from socket");
-					exit(1);
-				}
-				continue;
-			}
+	if (!count || count > GDB_IF_MAX_SESSIONS || !gdb_if_startup())
+		return -1;
+	/* Hand out ports in order from the usual one, skipping over any that are already taken */
+	uint16_t port = default_port;
+	for (size_t idx = 0U; idx < count; ++idx) {
+		gdb_if_session_s *const session = &gdb_if_sessions[idx];
+		session->conn = INVALID_SOCKET;
+		session->serv = INVALID_SOCKET;
+		for (; session->serv == INVALID_SOCKET && port < max_session_port; ++port)
+			session->serv = gdb_if_listen(port);
+		if (session->serv == INVALID_SOCKET) {
+			DEBUG_ERROR("Failed to acquire a port to listen on for session %zu\n", idx + 1U);
+			return -1;
 		}
-		DEBUG_INFO("Got connection\n");
-		socket_set_flags(gdb_if_serv, flags);
-		socket_set_flags(gdb_if_conn, socket_get_flags(gdb_if_conn) & ~O_NONBLOCK);
+		DEBUG_WARN("Session %zu listening on TCP port: %d\n", idx + 1U, port - 1U);
 	}
+	gdb_if_session_count = count;
+	gdb_if_multi_session = true;
+	return 0;
+}
 
-	char value = '\0';
-	int error = op_needs_retry;
-	while (error == op_needs_retry) {
-		const ssize_t result = recv(gdb_if_conn, &value, 1, 0);
-		if (result < 0) {
-			error = socket_error();
-			if (error == op_needs_retry)
-				continue;
-		} else
-			error = 0;
+void gdb_if_session_select(const size_t index)
+{
+	if (index < gdb_if_session_count)
+		gdb_if_active = &gdb_if_sessions[index];
+}
 
-		if (result <= 0) {
-			handle_error(gdb_if_conn, "on socket");
-			gdb_if_conn = INVALID_SOCKET;
-			/* Return '+' in case we were waiting for an ACK */
-			return '+';
+static void gdb_if_close(void)
+{
+	closesocket(gdb_if_active->conn);
+	gdb_if_active->conn = INVALID_SOCKET;
+	/* Anything left over from the old connection is meaningless now */
+	gdb_if_active->rx_begin = 0U;
+	gdb_if_active->rx_end = 0U;
+	gdb_if_active->tx_used = 0U;
+}
+
+/* Try to pick up a pending connection on a session's listening socket */
+static bool gdb_if_accept_pending(gdb_if_session_s *const session)
+{
+	session->conn = accept(session->serv, NULL, NULL);
+	if (session->conn == INVALID_SOCKET) {
+		const int error = socket_error();
+		/* The connection may have been dropped again between the poll and accept calls */
+		if (error == op_would_block || error == op_needs_retry)
+			return false;
+		display_socket_error(error, session->serv, "accepting connection from socket");
+		exit(1);
+	}
+	DEBUG_INFO("Got connection\n");
+	/* All I/O on the connection is driven by socket_poll(), so it must never block */
+	socket_set_flags(session->conn, socket_get_flags(session->conn) | O_NONBLOCK);
+	return true;
+}
+
+static void gdb_if_accept(void)
+{
+	SET_IDLE_STATE(1);
+	while (gdb_if_active->conn == INVALID_SOCKET) {
+		/* Sleep until a connection comes in rather than periodically checking for one */
+		if (socket_poll(gdb_if_active->serv, POLLIN, -1) < 0) {
+			display_socket_error(socket_error(), gdb_if_active->serv, "waiting for a connection on socket");
+			exit(1);
 		}
+		gdb_if_accept_pending(gdb_if_active);
 	}
-	return value;
 }
 
-char gdb_if_getchar_to(uint32_t timeout)
+size_t gdb_if_wait(const int timeout, gdb_if_event_e *const events)
 {
-	if (gdb_if_conn == INVALID_SOCKET)
-		return -1;
+	/* One extra for the probe, which wakes us up early when it has something for the next halt poll */
+	pollfd_s poll_fds[GDB_IF_MAX_SESSIONS + 1U];
+	int wait_time = timeout;
+	for (size_t idx = 0U; idx < gdb_if_session_count; ++idx) {
+		const gdb_if_session_s *const session = &gdb_if_sessions[idx];
+		const bool connected = session->conn != INVALID_SOCKET;
+		events[idx] = GDB_IF_EVENT_NONE;
+		/* Data already pulled off the socket still needs handling, so don't go to sleep on it */
+		if (connected && session->rx_begin != session->rx_end) {
+			events[idx] = GDB_IF_EVENT_DATA;
+			wait_time = 0;
+		}
+		/* Watch the connection if there is one, otherwise watch for one coming in */
+		poll_fds[idx] = (pollfd_s){
+			.fd = connected ? session->conn : session->serv,
+			.events = POLLIN,
+		};
+	}
+	/* Only a wait that's to end for the next halt poll has any reason to wake early for the probe */
+	size_t poll_count = gdb_if_session_count;
+	const int probe_fd = wait_time >= 0 ? platform_poll_wake_fd() : -1;
+	if (probe_fd >= 0)
+		poll_fds[poll_count++] = (pollfd_s){.fd = probe_fd, .events = POLLIN};
 
-#ifndef __CYGWIN__
-	timeval_s select_timeout;
+	while (true) {
+#if defined(_WIN32) || defined(__CYGWIN__)
+		const int result = WSAPoll(poll_fds, (ULONG)poll_count, wait_time);
 #else
-	TIMEVAL select_timeout;
+		const int result = poll(poll_fds, poll_count, wait_time);
 #endif
-	select_timeout.tv_sec = timeout / 1000U;
-	select_timeout.tv_usec = (timeout % 1000U) * 1000U;
+		if (result >= 0)
+			break;
+		if (socket_error() != op_needs_retry) {
+			display_socket_error(socket_error(), poll_fds[0].fd, "waiting on sockets");
+			exit(1);
+		}
+	}
 
-	fd_set fds;
-	FD_ZERO(&fds);
-	FD_SET(gdb_if_conn, &fds);
+	size_t ready = 0U;
+	for (size_t idx = 0U; idx < gdb_if_session_count; ++idx) {
+		gdb_if_session_s *const session = &gdb_if_sessions[idx];
+		if (events[idx] == GDB_IF_EVENT_NONE && poll_fds[idx].revents) {
+			/* A hang up or error on the connection is picked up by the next read from it */
+			if (session->conn != INVALID_SOCKET)
+				events[idx] = GDB_IF_EVENT_DATA;
+			else if (gdb_if_accept_pending(session))
+				events[idx] = GDB_IF_EVENT_CONNECTED;
+		}
+		if (events[idx] != GDB_IF_EVENT_NONE)
+			++ready;
+	}
+	return ready;
+}
 
-	if (select(FD_SETSIZE, &fds, NULL, NULL, &select_timeout) > 0)
-		return gdb_if_getchar();
-	return -1;
+/*
+ * Wait for data on the active connection, as socket_poll() does. If the wait is to end for the next halt poll
+ * and the probe can wake us early for it, this also waits on the probe, returning 0 as for a timeout if it's
+ * the probe that woke us.
+ */
+static int gdb_if_poll_active(const int timeout)
+{
+	const int probe_fd = timeout >= 0 ? platform_poll_wake_fd() : -1;
+	if (probe_fd < 0)
+		return socket_poll(gdb_if_active->conn, POLLIN, timeout);
+	pollfd_s poll_fds[2] = {
+		{.fd = gdb_if_active->conn, .events = POLLIN},
+		{.fd = probe_fd, .events = POLLIN},
+	};
+	while (true) {
+#if defined(_WIN32) || defined(__CYGWIN__)
+		const int result = WSAPoll(poll_fds, 2U, timeout);
+#else
+		const int result = poll(poll_fds, 2U, timeout);
+#endif
+		if (result < 0 && socket_error() == op_needs_retry)
+			continue;
+		if (result <= 0)
+			return result;
+		return poll_fds[0].revents;
+	}
+}
+
+/* Refill the receive buffer, waiting up to timeout milliseconds (or forever if negative) for data */
+static gdb_if_rx_result_e gdb_if_receive(const int timeout)
+{
+	while (true) {
+		const int events = gdb_if_poll_active(timeout);
+		if (events == 0)
+			return GDB_IF_RX_TIMEOUT;
+		if (events < 0) {
+			display_socket_error(socket_error(), gdb_if_active->conn, "waiting for data on socket");
+			gdb_if_close();
+			return GDB_IF_RX_CLOSED;
+		}
+
+		const ssize_t result = recv(gdb_if_active->conn, gdb_if_active->rx_buffer, GDB_RX_BUFFER_LEN, 0);
+		if (result > 0) {
+			gdb_if_active->rx_begin = 0U;
+			gdb_if_active->rx_end = (size_t)result;
+			return GDB_IF_RX_DATA;
+		}
+		if (result < 0) {
+			const int error = socket_error();
+			if (error == op_needs_retry || error == op_would_block)
+				continue;
+			display_socket_error(error, gdb_if_active->conn, "on socket");
+		} else
+			DEBUG_INFO("Connection closed by peer\n");
+		gdb_if_close();
+		return GDB_IF_RX_CLOSED;
+	}
+}
+
+char gdb_if_getchar(void)
+{
+	if (gdb_if_active->conn == INVALID_SOCKET) {
+		/* In multi-target server mode the scheduler handles new connections, we must not block waiting for one */
+		if (shutdown_bmda || gdb_if_multi_session)
+			return '\x04';
+		gdb_if_accept();
+	}
+
+	if (gdb_if_active->rx_begin == gdb_if_active->rx_end && gdb_if_receive(-1) != GDB_IF_RX_DATA)
+		/* Return '+' in case we were waiting for an ACK */
+		return '+';
+	return gdb_if_active->rx_buffer[gdb_if_active->rx_begin++];
+}
+
+char gdb_if_getchar_to(const uint32_t timeout)
+{
+	if (gdb_if_active->conn == INVALID_SOCKET) {
+		/* Nothing to wait on, but still honour the timeout so the poll loop doesn't spin */
+		platform_delay(timeout);
+		return -1;
+	}
+
+	/* Serve from the buffer if we can, only touching the socket when it has run dry */
+	if (gdb_if_active->rx_begin == gdb_if_active->rx_end) {
+		switch (gdb_if_receive((int)MIN(timeout, (uint32_t)INT32_MAX))) {
+		case GDB_IF_RX_TIMEOUT:
+			return -1;
+		case GDB_IF_RX_CLOSED:
+			/* Return '+' in case we were waiting for an ACK */
+			return '+';
+		default:
+			break;
+		}
+	}
+	return gdb_if_active->rx_buffer[gdb_if_active->rx_begin++];
 }
 
 void gdb_if_putchar(const char c, const bool flush)
 {
-	if (gdb_if_conn == INVALID_SOCKET)
+	if (gdb_if_active->conn == INVALID_SOCKET)
 		return;
-	gdb_buffer[gdb_buffer_used++] = c;
-	if (flush || gdb_buffer_used == GDB_BUFFER_LEN)
+	gdb_if_active->tx_buffer[gdb_if_active->tx_used++] = c;
+	if (flush || gdb_if_active->tx_used == GDB_BUFFER_LEN)
 		gdb_if_flush(flush);
 }
 
@@ -364,18 +590,34 @@ void gdb_if_flush(const bool force)
 	(void)force;
 
 	/* Flush only if there is data to flush */
-	if (gdb_buffer_used == 0U)
+	if (gdb_if_active->tx_used == 0U)
 		return;
 
 	/* Don't bother if the connection is not valid */
-	if (gdb_if_conn == INVALID_SOCKET) {
-		gdb_buffer_used = 0U;
+	if (gdb_if_active->conn == INVALID_SOCKET) {
+		gdb_if_active->tx_used = 0U;
 		return;
 	}
 
-	/* Send the data */
-	send(gdb_if_conn, gdb_buffer, gdb_buffer_used, 0);
+	/* Send the data, waiting for the socket to drain if it can't take it all in one go */
+	size_t offset = 0U;
+	while (offset < gdb_if_active->tx_used) {
+		const ssize_t result =
+			send(gdb_if_active->conn, gdb_if_active->tx_buffer + offset, gdb_if_active->tx_used - offset, 0);
+		if (result >= 0) {
+			offset += (size_t)result;
+			continue;
+		}
+		const int error = socket_error();
+		if (error == op_needs_retry)
+			continue;
+		if (error == op_would_block && socket_poll(gdb_if_active->conn, POLLOUT, -1) > 0)
+			continue;
+		display_socket_error(error, gdb_if_active->conn, "sending on socket");
+		gdb_if_close();
+		return;
+	}
 
 	/* Reset the buffer */
-	gdb_buffer_used = 0;
+	gdb_if_active->tx_used = 0;
 }
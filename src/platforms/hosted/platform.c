@@ -39,9 +39,11 @@
 #include "cli.h"
 #include "gdb_if.h"
 #include "gdb_packet.h"
+#include "gdb_main.h"
 #include <signal.h>
 
 #ifdef ENABLE_RTT
+#include "rtt.h"
 #include "rtt_if.h"
 #endif
 
@@ -70,6 +72,10 @@ static uint32_t max_frequency = 4000000U;
 
 static bmda_cli_options_s cl_opts;
 
+/* Current halt poll interval and when the next halt poll is due, see platform_poll_halt_due() */
+static uint32_t halt_poll_interval_ms;
+static uint32_t halt_poll_next_ms;
+
 void bmda_display_probe(void)
 {
 	gdb_outf("Using a %s (%s), %s\n", bmda_probe_info.product, bmda_probe_info.manufacturer, bmda_probe_info.version);
@@ -105,6 +111,22 @@ static void exit_function(void)
 	fflush(stdout);
 }
 
+/*
+ * Multi-target server mode: scan up front and give every target found its own GDB session,
+ * each listening on its own port counting up from the usual one
+ */
+static void bmda_multi_target_init(void)
+{
+	connect_assert_nrst = cl_opts.opt_connect_under_reset;
+	platform_nrst_set_val(cl_opts.opt_connect_under_reset);
+	if (!scan_for_targets(&cl_opts)) {
+		DEBUG_ERROR("No target found\n");
+		exit(1);
+	}
+	if (!gdb_sessions_init() || gdb_if_init_sessions(gdb_session_count()) < 0)
+		exit(1);
+}
+
 /* SIGTERM handler. */
 static void sigterm_handler(int sig)
 {
@@ -122,6 +144,8 @@ void platform_init(int argc, char **argv)
 	}
 #endif
 	cl_init(&cl_opts, argc, argv);
+	if (cl_opts.opt_packet_size && !gdb_packet_buffer_alloc(cl_opts.opt_packet_size))
+		exit(1);
 	atexit(exit_function);
 	signal(SIGTERM, sigterm_handler);
 	signal(SIGINT, sigterm_handler);
@@ -188,7 +212,10 @@ void platform_init(int argc, char **argv)
 	if (cl_opts.opt_mode != BMP_MODE_DEBUG)
 		exit(cl_execute(&cl_opts));
 	else {
-		gdb_if_init();
+		if (cl_opts.opt_multi_target)
+			bmda_multi_target_init();
+		else
+			gdb_if_init();
 
 #ifdef ENABLE_RTT
 		rtt_if_init();
@@ -674,10 +701,50 @@ void platform_buffer_flush(void)
 	}
 }
 
-void platform_pace_poll(void)
+void platform_poll_resumed(void)
 {
-	if (!cl_opts.fast_poll)
-		platform_delay(8);
+	/* A freshly resumed target is the most likely to stop again soon, so start over polling at the fastest rate */
+	halt_poll_interval_ms = cl_opts.opt_halt_poll_min_ms;
+	halt_poll_next_ms = platform_time_ms();
+}
+
+/* Whether the probe has something to tell us about its halt watch, which makes a halt poll due right away */
+static bool platform_halt_watch_pending(void)
+{
+	return bmda_probe_info.type == PROBE_TYPE_BMP && remote_halt_watch.armed && platform_buffer_pending();
+}
+
+bool platform_poll_halt_due(void)
+{
+	if (platform_halt_watch_pending())
+		return true;
+	const uint32_t now = platform_time_ms();
+	if ((int32_t)(halt_poll_next_ms - now) > 0)
+		return false;
+	/* Every poll that finds the target still running doubles the time to the next one, up to the maximum */
+	halt_poll_next_ms = now + halt_poll_interval_ms;
+	halt_poll_interval_ms = MIN(MAX(halt_poll_interval_ms * 2U, 1U), cl_opts.opt_halt_poll_max_ms);
+	return true;
+}
+
+uint32_t platform_poll_wait_time(void)
+{
+	if (platform_halt_watch_pending())
+		return 0U;
+	int32_t wait_time = (int32_t)(halt_poll_next_ms - platform_time_ms());
+#ifdef ENABLE_RTT
+	if (rtt_enabled)
+		wait_time = MIN(wait_time, (int32_t)rtt_poll_wait_time());
+#endif
+	return wait_time > 0 ? (uint32_t)wait_time : 0U;
+}
+
+int platform_poll_wake_fd(void)
+{
+	/* While the probe is watching for the target halting, it tells us when that happens, so wait for it to */
+	if (bmda_probe_info.type == PROBE_TYPE_BMP && remote_halt_watch.armed)
+		return platform_buffer_fd();
+	return -1;
 }
 
 void platform_target_clk_output_enable(const bool enable)
@@ -739,3 +806,63 @@ uint8_t platform_spi_xfer(const spi_bus_e bus, const uint8_t value)
 		return UINT8_MAX;
 	}
 }
+
+/*
+ * The SPI Flash transaction functions are implemented in BMDA by having the probe run the whole transaction,
+ * rather than by driving it one byte per round trip with platform_spi_xfer()
+ */
+void bmp_spi_read(const spi_bus_e bus, const uint8_t device, const uint16_t command, const target_addr32_t address,
+	void *const buffer, const size_t length)
+{
+	switch (bmda_probe_info.type) {
+	case PROBE_TYPE_BMP:
+		remote_spi_read(bus, device, command, address, buffer, length);
+		break;
+
+	default:
+		DEBUG_ERROR("SPI protocol unsupported by probe");
+		memset(buffer, 0, length);
+		break;
+	}
+}
+
+void bmp_spi_write(const spi_bus_e bus, const uint8_t device, const uint16_t command, const target_addr32_t address,
+	const void *const buffer, const size_t length)
+{
+	switch (bmda_probe_info.type) {
+	case PROBE_TYPE_BMP:
+		remote_spi_write(bus, device, command, address, buffer, length);
+		break;
+
+	default:
+		DEBUG_ERROR("SPI protocol unsupported by probe");
+		break;
+	}
+}
+
+void bmp_spi_run_command(
+	const spi_bus_e bus, const uint8_t device, const uint16_t command, const target_addr32_t address)
+{
+	switch (bmda_probe_info.type) {
+	case PROBE_TYPE_BMP:
+		remote_spi_run_command(bus, device, command, address);
+		break;
+
+	default:
+		DEBUG_ERROR("SPI protocol unsupported by probe");
+		break;
+	}
+}
+
+bool bmp_spi_program_page(const spi_bus_e bus, const uint8_t device, const uint16_t command,
+	const target_addr32_t address, const void *const buffer, const size_t length)
+{
+	switch (bmda_probe_info.type) {
+	case PROBE_TYPE_BMP:
+		return remote_spi_program_page(bus, device, command, address, buffer, length);
+
+	default:
+		DEBUG_ERROR("SPI protocol unsupported by probe");
+		return false;
+	}
+}
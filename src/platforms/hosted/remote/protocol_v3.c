@@ -55,6 +55,10 @@ void remote_v3_init(void)
 		.spi_deinit = remote_v3_spi_deinit,
 		.spi_chip_select = remote_v3_spi_chip_select,
 		.spi_xfer = remote_v3_spi_xfer,
+		.spi_read = remote_v3_spi_read,
+		.spi_write = remote_v3_spi_write,
+		.spi_run_command = remote_v3_spi_run_command,
+		.spi_program_page = remote_v3_spi_program_page,
 	};
 }
 
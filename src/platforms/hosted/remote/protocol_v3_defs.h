@@ -65,10 +65,14 @@
 #define REMOTE_SPI_CHIP_SELECT 'C'
 #define REMOTE_SPI_TRANSFER    'X'
 #define REMOTE_SPI_READ        'r'
-#define REMOTE_SPI_WRTIE       'w'
+#define REMOTE_SPI_WRITE       'w'
 #define REMOTE_SPI_CHIP_ID     'I'
 #define REMOTE_SPI_RUN_COMMAND 'c'
 
+#define REMOTE_UINT24 '%', '0', '6', 'x'
+/* The read and write requests can move at most this many bytes of data per request */
+#define REMOTE_SPI_MAX_DATA_LENGTH 256U
+
 #define REMOTE_SPI_BEGIN_STR                                                                          \
 	(char[])                                                                                          \
 	{                                                                                                 \
@@ -123,3 +123,94 @@ uint8_t remote_v3_spi_xfer(spi_bus_e bus, uint8_t value)
 	DEBUG_PROBE("%s: bus %u => %02x -> %02x\n", __func__, bus, value, result_value);
 	return result_value;
 }
+
+void remote_v3_spi_read(const spi_bus_e bus, const uint8_t device, const uint16_t command,
+	const target_addr32_t address, void *const buffer, const size_t length)
+{
+	uint8_t *const data = (uint8_t *)buffer;
+	char request[REMOTE_MAX_MSG_SIZE];
+	/* For each transfer block size, ask the firmware to run a read cycle for that block of bytes */
+	for (size_t offset = 0U; offset < length; offset += REMOTE_SPI_MAX_DATA_LENGTH) {
+		/* Pick the amount left to read or the block size, whichever is smaller */
+		const size_t amount = MIN(length - offset, REMOTE_SPI_MAX_DATA_LENGTH);
+		/* Create the request and send it to the remote */
+		ssize_t result = snprintf(request, REMOTE_MAX_MSG_SIZE, REMOTE_SPI_READ_STR, bus, device, command,
+			(uint32_t)(address + offset), (uint16_t)amount);
+		platform_buffer_write(request, result);
+		/* Read back the answer and check for errors */
+		result = platform_buffer_read(request, REMOTE_MAX_MSG_SIZE);
+		if (result < 1 || request[0] != REMOTE_RESP_OK || (size_t)result != 1U + (amount * 2U)) {
+			DEBUG_ERROR("Remote SPI read failed, %s\n", remote_v3_fault_to_string(request, result));
+			return;
+		}
+		/* If the response indicates all's OK, decode the data read */
+		unhexify(data + offset, request + 1U, amount);
+	}
+	DEBUG_PROBE("%s: bus %u device %u command %04x @%06" PRIx32 "+%zx\n", __func__, bus, device, command, address,
+		length);
+}
+
+void remote_v3_spi_write(const spi_bus_e bus, const uint8_t device, const uint16_t command,
+	const target_addr32_t address, const void *const buffer, const size_t length)
+{
+	const uint8_t *const data = (const uint8_t *)buffer;
+	/* + 1 for terminating NUL character */
+	char request[REMOTE_MAX_MSG_SIZE + 1U];
+	/* For each transfer block size, ask the firmware to run a write cycle for that block of bytes */
+	for (size_t offset = 0U; offset < length; offset += REMOTE_SPI_MAX_DATA_LENGTH) {
+		/* Pick the amount left to write or the block size, whichever is smaller */
+		const size_t amount = MIN(length - offset, REMOTE_SPI_MAX_DATA_LENGTH);
+		/* Create the request, encode the data to send after it, and append the packet termination marker */
+		ssize_t result = snprintf(request, REMOTE_MAX_MSG_SIZE, REMOTE_SPI_WRITE_STR, bus, device, command,
+			(uint32_t)(address + offset), (uint16_t)amount);
+		hexify(request + result, data + offset, amount);
+		result += (ssize_t)(amount * 2U);
+		request[result++] = REMOTE_EOM;
+		request[result] = '\0';
+		platform_buffer_write(request, result);
+		/* Read back the answer and check for errors */
+		result = platform_buffer_read(request, REMOTE_MAX_MSG_SIZE);
+		if (result < 1 || request[0] != REMOTE_RESP_OK) {
+			DEBUG_ERROR("Remote SPI write failed, %s\n", remote_v3_fault_to_string(request, result));
+			return;
+		}
+	}
+	DEBUG_PROBE("%s: bus %u device %u command %04x @%06" PRIx32 "+%zx\n", __func__, bus, device, command, address,
+		length);
+}
+
+void remote_v3_spi_run_command(
+	const spi_bus_e bus, const uint8_t device, const uint16_t command, const target_addr32_t address)
+{
+	char buffer[REMOTE_MAX_MSG_SIZE];
+	/* Create the request and send it to the remote */
+	ssize_t length = snprintf(buffer, REMOTE_MAX_MSG_SIZE, REMOTE_SPI_RUN_COMMAND_STR, bus, device, command, address);
+	platform_buffer_write(buffer, length);
+	/* Read back the answer and check for errors */
+	length = platform_buffer_read(buffer, REMOTE_MAX_MSG_SIZE);
+	if (length < 1 || buffer[0] != REMOTE_RESP_OK) {
+		DEBUG_ERROR("Remote SPI command failed, %s\n", remote_v3_fault_to_string(buffer, length));
+		return;
+	}
+	DEBUG_PROBE("%s: bus %u device %u command %04x @%06" PRIx32 "\n", __func__, bus, device, command, address);
+}
+
+static uint8_t remote_v3_spi_read_status(const spi_bus_e bus, const uint8_t device)
+{
+	uint8_t status = 0U;
+	remote_v3_spi_read(bus, device, SPI_FLASH_CMD_READ_STATUS, 0U, &status, sizeof(status));
+	return status;
+}
+
+bool remote_v3_spi_program_page(const spi_bus_e bus, const uint8_t device, const uint16_t command,
+	const target_addr32_t address, const void *const buffer, const size_t length)
+{
+	/* This version of the protocol has no single request for this, so build it out of the requests it does have */
+	remote_v3_spi_run_command(bus, device, SPI_FLASH_CMD_WRITE_ENABLE, 0U);
+	if (!(remote_v3_spi_read_status(bus, device) & SPI_FLASH_STATUS_WRITE_ENABLED))
+		return false;
+	remote_v3_spi_write(bus, device, command, address, buffer, length);
+	while (remote_v3_spi_read_status(bus, device) & SPI_FLASH_STATUS_BUSY)
+		continue;
+	return true;
+}
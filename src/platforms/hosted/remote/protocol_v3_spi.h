@@ -43,4 +43,12 @@ bool remote_v3_spi_deinit(spi_bus_e bus);
 bool remote_v3_spi_chip_select(uint8_t device_select);
 uint8_t remote_v3_spi_xfer(spi_bus_e bus, uint8_t value);
 
+void remote_v3_spi_read(
+	spi_bus_e bus, uint8_t device, uint16_t command, target_addr32_t address, void *buffer, size_t length);
+void remote_v3_spi_write(
+	spi_bus_e bus, uint8_t device, uint16_t command, target_addr32_t address, const void *buffer, size_t length);
+void remote_v3_spi_run_command(spi_bus_e bus, uint8_t device, uint16_t command, target_addr32_t address);
+bool remote_v3_spi_program_page(
+	spi_bus_e bus, uint8_t device, uint16_t command, target_addr32_t address, const void *buffer, size_t length);
+
 #endif /*PLATFORMS_HOSTED_REMOTE_PROTOCOL_V3_SPI_H*/
@@ -46,6 +46,9 @@
 #include "protocol_v4_adiv6.h"
 #include "protocol_v4_riscv.h"
 
+/* The accelerations the probe reported it has available, see remote_v4_available_accelerations() */
+static uint64_t remote_v4_accelerations = 0U;
+
 bool remote_v4_init(void)
 {
 	/* Before we initialise the remote functions structure, determine what accelerations are available */
@@ -60,6 +63,7 @@ bool remote_v4_init(void)
 	}
 
 	const uint64_t accelerations = remote_decode_response(buffer + 1, length - 1);
+	remote_v4_accelerations = accelerations;
 
 	/* Fill in the base set that will always be available */
 	remote_funcs = (bmp_remote_protocol_s){
@@ -73,6 +77,10 @@ bool remote_v4_init(void)
 		.spi_deinit = remote_v3_spi_deinit,
 		.spi_chip_select = remote_v3_spi_chip_select,
 		.spi_xfer = remote_v3_spi_xfer,
+		.spi_read = remote_v3_spi_read,
+		.spi_write = remote_v3_spi_write,
+		.spi_run_command = remote_v3_spi_run_command,
+		.spi_program_page = remote_v3_spi_program_page,
 	};
 
 	/* Now fill in acceleration-specific functions */
@@ -108,6 +116,9 @@ bool remote_v4_adiv5_init(adiv5_debug_port_s *const dp)
 	dp->ap_write = remote_v4_adiv5_ap_write;
 	dp->mem_read = remote_v4_adiv5_mem_read_bytes;
 	dp->mem_write = remote_v4_adiv5_mem_write_bytes;
+	/* If the probe can watch for the target halting for us, hook that up too */
+	if (remote_v4_accelerations & REMOTE_ACCEL_HALT_WATCH)
+		dp->halt_watch = remote_v4_adiv5_halt_watch;
 	return true;
 }
 
@@ -139,6 +150,11 @@ bool remote_v4_riscv_jtag_init(riscv_dmi_s *const dmi)
 	return true;
 }
 
+uint64_t remote_v4_available_accelerations(void)
+{
+	return remote_v4_accelerations;
+}
+
 uint64_t remote_v4_supported_architectures(void)
 {
 	/* Ask the probe what target architectures it supports */
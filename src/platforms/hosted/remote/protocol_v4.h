@@ -44,6 +44,7 @@ bool remote_v4_adiv5_init(adiv5_debug_port_s *dp);
 bool remote_v4_adiv6_init(adiv5_debug_port_s *dp);
 bool remote_v4_riscv_jtag_init(riscv_dmi_s *dmi);
 
+uint64_t remote_v4_available_accelerations(void);
 uint64_t remote_v4_supported_architectures(void);
 uint64_t remote_v4_supported_families(void);
 
@@ -44,7 +44,7 @@ static bool remote_v4_have_dp_targetsel_command = true;
 static uint8_t remote_v4_current_dp_version = UINT8_MAX;
 static uint32_t remote_v4_current_dp_targetsel = UINT32_MAX;
 
-static void remote_v4_adiv5_dp_version(adiv5_debug_port_s *const dp)
+void remote_v4_adiv5_dp_version(adiv5_debug_port_s *const dp)
 {
 	/*
 	 * Check if the probe actually has this command, skip if it does not.
@@ -67,7 +67,7 @@ static void remote_v4_adiv5_dp_version(adiv5_debug_port_s *const dp)
 		remote_v4_current_dp_version = dp->version;
 }
 
-static void remote_v4_adiv5_dp_targetsel(adiv5_debug_port_s *const dp)
+void remote_v4_adiv5_dp_targetsel(adiv5_debug_port_s *const dp)
 {
 	/*
 	 * Check if the probe actually has this command, skip if it does not.
@@ -194,3 +194,53 @@ void remote_v4_adiv5_mem_write_bytes(adiv5_access_port_s *const ap, const target
 		}
 	}
 }
+
+bool remote_v4_adiv5_halt_watch(
+	adiv5_access_port_s *const ap, const target_addr64_t address, const uint32_t mask, const uint32_t value)
+{
+	/* Pick up the probe telling us the watch fired if it has done so since we last looked */
+	while (remote_halt_watch.armed && platform_buffer_pending()) {
+		char buffer[REMOTE_MAX_MSG_SIZE];
+		const int length = platform_buffer_read_response(buffer, REMOTE_MAX_MSG_SIZE);
+		if (length < 1 || buffer[0] == REMOTE_RESP_HALT) {
+			remote_halt_watch.armed = false;
+			remote_halt_watch.fired = true;
+		}
+	}
+
+	/*
+	 * There is only one watch, so if it is for some other target it gets taken over. That is safe: when that
+	 * target next re-arms it the probe checks the word straight away, so a halt in between is not lost.
+	 */
+	const bool same_watch = remote_halt_watch.dev_index == ap->dp->dev_index && remote_halt_watch.apsel == ap->apsel &&
+		remote_halt_watch.address == address;
+	if (same_watch && remote_halt_watch.fired) {
+		remote_halt_watch.fired = false;
+		return true;
+	}
+	if (same_watch && remote_halt_watch.armed)
+		return false;
+
+	remote_v4_adiv5_dp_version(ap->dp);
+	remote_v4_adiv5_dp_targetsel(ap->dp);
+	/* Create the request and send it to the remote */
+	char buffer[REMOTE_MAX_MSG_SIZE];
+	ssize_t length = snprintf(buffer, REMOTE_MAX_MSG_SIZE, REMOTE_HALT_WATCH_STR, ap->dp->dev_index, ap->apsel,
+		ap->csw, address, mask, value);
+	platform_buffer_write(buffer, length);
+	/* Read back the answer, falling back to polling the target directly if the watch could not be set up */
+	length = platform_buffer_read(buffer, REMOTE_MAX_MSG_SIZE);
+	if (length < 1 || buffer[0] != REMOTE_RESP_OK) {
+		DEBUG_ERROR("%s failed, error %s\n", __func__, length ? buffer + 1 : "with communication");
+		return true;
+	}
+	remote_halt_watch = (remote_halt_watch_s){
+		.armed = true,
+		.fired = false,
+		.dev_index = ap->dp->dev_index,
+		.apsel = ap->apsel,
+		.address = address,
+	};
+	/* Until the probe says otherwise, the target is still running */
+	return false;
+}
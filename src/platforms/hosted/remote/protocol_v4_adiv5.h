@@ -43,6 +43,10 @@
  * so as to allow calling the DP version setting command v4 introduces to ensure the probe accelerates
  * things correctly.
  */
+/* Bring the probe's idea of the DP version and TARGETSEL value in line with dp's, if they've changed */
+void remote_v4_adiv5_dp_version(adiv5_debug_port_s *dp);
+void remote_v4_adiv5_dp_targetsel(adiv5_debug_port_s *dp);
+
 uint32_t remote_v4_adiv5_raw_access(adiv5_debug_port_s *dp, uint8_t rnw, uint16_t addr, uint32_t request_value);
 uint32_t remote_v4_adiv5_dp_read(adiv5_debug_port_s *dp, uint16_t addr);
 uint32_t remote_v4_adiv5_ap_read(adiv5_access_port_s *ap, uint16_t addr);
@@ -50,5 +54,6 @@ void remote_v4_adiv5_ap_write(adiv5_access_port_s *ap, uint16_t addr, uint32_t v
 void remote_v4_adiv5_mem_read_bytes(adiv5_access_port_s *ap, void *dest, target_addr64_t src, size_t read_length);
 void remote_v4_adiv5_mem_write_bytes(
 	adiv5_access_port_s *ap, target_addr64_t dest, const void *src, size_t write_length, align_e align);
+bool remote_v4_adiv5_halt_watch(adiv5_access_port_s *ap, target_addr64_t address, uint32_t mask, uint32_t value);
 
 #endif /*PLATFORMS_HOSTED_REMOTE_PROTOCOL_V4_ADIV5_H*/
@@ -68,10 +68,11 @@
 	}
 
 /* Remote protocol enabled acceleration bit values */
-#define REMOTE_ACCEL_ADIV5     (1U << 0U)
-#define REMOTE_ACCEL_CORTEX_AR (1U << 1U)
-#define REMOTE_ACCEL_RISCV     (1U << 2U)
-#define REMOTE_ACCEL_ADIV6     (1U << 3U)
+#define REMOTE_ACCEL_ADIV5      (1U << 0U)
+#define REMOTE_ACCEL_CORTEX_AR  (1U << 1U)
+#define REMOTE_ACCEL_RISCV      (1U << 2U)
+#define REMOTE_ACCEL_ADIV6      (1U << 3U)
+#define REMOTE_ACCEL_HALT_WATCH (1U << 4U)
 
 /* Remote protocol enabled architecture support bit values */
 #define REMOTE_ARCH_CORTEXM  (1U << 0U)
@@ -154,6 +155,21 @@
 		REMOTE_SOM, REMOTE_ADIV5_PACKET, REMOTE_DP_TARGETSEL, REMOTE_ADIV5_DATA, REMOTE_EOM, 0 \
 	}
 
+/*
+ * Probes advertising REMOTE_ACCEL_HALT_WATCH can watch a memory word for the target halting, sending an
+ * unsolicited REMOTE_RESP_HALT response when it does. Any other request cancels the watch.
+ */
+#define REMOTE_RESP_HALT  'H'
+#define REMOTE_HALT_WATCH 'H'
+#define REMOTE_ADIV5_MASK REMOTE_UINT32
+
+#define REMOTE_HALT_WATCH_STR                                                                            \
+	(char[])                                                                                             \
+	{                                                                                                    \
+		REMOTE_SOM, REMOTE_ADIV5_PACKET, REMOTE_HALT_WATCH, REMOTE_ADIV5_DEV_INDEX, REMOTE_ADIV5_AP_SEL, \
+			REMOTE_ADIV5_CSW, REMOTE_ADIV5_ADDR64, REMOTE_ADIV5_MASK, REMOTE_ADIV5_DATA, REMOTE_EOM, 0   \
+	}
+
 /* ADIv6 acceleration protocol elements */
 #define REMOTE_ADIV6_PACKET '6'
 
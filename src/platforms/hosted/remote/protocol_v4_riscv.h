@@ -38,6 +38,7 @@
 #include <stddef.h>
 #include "riscv_debug.h"
 
+bool remote_v4_riscv_check_error(const char *func, riscv_dmi_s *dmi, const char *buffer, ssize_t length);
 bool remote_v4_riscv_jtag_dmi_read(riscv_dmi_s *dmi, uint32_t address, uint32_t *value);
 bool remote_v4_riscv_jtag_dmi_write(riscv_dmi_s *dmi, uint32_t address, uint32_t value);
 
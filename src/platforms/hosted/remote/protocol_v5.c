@@ -0,0 +1,156 @@
+/*
+ * This file is part of the Black Magic Debug project.
+ *
+ * Copyright (C) 2026 1BitSquared <info@1bitsquared.com>
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived from
+ *    this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "bmp_remote.h"
+#include "buffer_utils.h"
+
+#include "protocol_v4.h"
+#include "protocol_v4_adiv5.h"
+#include "protocol_v5.h"
+#include "protocol_v5_defs.h"
+#include "protocol_v5_adiv5.h"
+#include "protocol_v5_adiv6.h"
+#include "protocol_v5_riscv.h"
+#include "protocol_v5_spi.h"
+
+/* The largest binary payload the probe told us it can handle, see remote_v5_max_packet_size() */
+static size_t remote_v5_packet_size = REMOTE_MAX_MSG_SIZE;
+/* Whether the probe answered the packet size request, and so knows how to stream memory transfers */
+static bool remote_v5_mem_stream = false;
+
+static void remote_v5_negotiate_packet_size(void)
+{
+	/* Start from the size every v5 probe can handle, in case this one can't tell us otherwise */
+	remote_v5_packet_size = REMOTE_MAX_MSG_SIZE;
+	remote_v5_mem_stream = false;
+	platform_buffer_write(REMOTE_HL_MAX_PACKET_STR, sizeof(REMOTE_HL_MAX_PACKET_STR));
+
+	char buffer[REMOTE_MAX_MSG_SIZE];
+	const ssize_t length = platform_buffer_read(buffer, REMOTE_MAX_MSG_SIZE);
+	/* Probes that predate the request say they don't recognise it, which leaves us with the defaults */
+	if (length < 1 || buffer[0] != REMOTE_RESP_OK) {
+		DEBUG_PROBE("%s: Probe did not report a packet size, using %zu bytes\n", __func__, remote_v5_packet_size);
+		return;
+	}
+
+	const uint64_t packet_size = remote_decode_response(buffer + 1, length - 1);
+	if (packet_size < REMOTE_V5_MIN_PACKET_SIZE) {
+		DEBUG_ERROR("%s: Probe reported an unusable packet size of %" PRIu64 " bytes\n", __func__, packet_size);
+		return;
+	}
+	remote_v5_packet_size = MIN(packet_size, REMOTE_V5_MAX_PACKET_SIZE);
+	remote_v5_mem_stream = true;
+	DEBUG_INFO("Using a remote packet size of %zu bytes\n", remote_v5_packet_size);
+}
+
+bool remote_v5_init(void)
+{
+	/* v5 only adds to v4, so start by setting everything up as v4 would */
+	if (!remote_v4_init())
+		return false;
+	/* Find out how much the probe can take in a single binary frame */
+	remote_v5_negotiate_packet_size();
+
+	/* Then switch the ADIv5 and ADIv6 accelerations, if available, over to binary requests */
+	if (remote_funcs.adiv5_init)
+		remote_funcs.adiv5_init = remote_v5_adiv5_init;
+	if (remote_funcs.adiv6_init)
+		remote_funcs.adiv6_init = remote_v5_adiv6_init;
+	/* Have RISC-V Debug run whole Hart-level operations on the probe where it can */
+	if (remote_funcs.riscv_jtag_init)
+		remote_funcs.riscv_jtag_init = remote_v5_riscv_jtag_init;
+	/* And do the same for the SPI Flash transactions */
+	remote_funcs.spi_read = remote_v5_spi_read;
+	remote_funcs.spi_write = remote_v5_spi_write;
+	remote_funcs.spi_program_page = remote_v5_spi_program_page;
+	return true;
+}
+
+bool remote_v5_adiv5_init(adiv5_debug_port_s *const dp)
+{
+	/* Start from the v4 set so the halt watch gets hooked up if the probe has it */
+	if (!remote_v4_adiv5_init(dp))
+		return false;
+	dp->low_access = remote_v5_adiv5_raw_access;
+	dp->dp_read = remote_v5_adiv5_dp_read;
+	dp->ap_read = remote_v5_adiv5_ap_read;
+	dp->ap_write = remote_v5_adiv5_ap_write;
+	dp->mem_read = remote_v5_adiv5_mem_read_bytes;
+	dp->mem_write = remote_v5_adiv5_mem_write_bytes;
+	/* If the probe can run batches of DP and AP operations, hook that up too */
+	if (remote_v4_available_accelerations() & REMOTE_ACCEL_ADIV5_BATCH)
+		dp->batch_run = remote_v5_adiv5_batch_run;
+	return true;
+}
+
+bool remote_v5_adiv6_init(adiv5_debug_port_s *const dp)
+{
+	dp->ap_read = remote_v5_adiv6_ap_read;
+	dp->ap_write = remote_v5_adiv6_ap_write;
+	dp->mem_read = remote_v5_adiv6_mem_read_bytes;
+	dp->mem_write = remote_v5_adiv6_mem_write_bytes;
+	return true;
+}
+
+bool remote_v5_riscv_jtag_init(riscv_dmi_s *const dmi)
+{
+	/* Start from the v4 set so the DMI accesses get hooked up */
+	if (!remote_v4_riscv_jtag_init(dmi))
+		return false;
+	/* If the probe can run memory accesses and register reads on the Hart itself, hook that up too */
+	if (remote_v4_available_accelerations() & REMOTE_ACCEL_RISCV_HART) {
+		dmi->mem_read = remote_v5_riscv32_mem_read;
+		dmi->mem_write = remote_v5_riscv32_mem_write;
+		dmi->regs_read = remote_v5_riscv32_regs_read;
+	}
+	return true;
+}
+
+size_t remote_v5_max_packet_size(void)
+{
+	return remote_v5_packet_size;
+}
+
+bool remote_v5_mem_stream_available(void)
+{
+	return remote_v5_mem_stream;
+}
+
+void remote_v5_send_frame(uint8_t *const frame, const size_t payload_length)
+{
+	/* Fill in the header ahead of the payload and the end of message marker after it, then send the frame */
+	frame[0U] = REMOTE_SOM;
+	frame[1U] = REMOTE_BINARY_PACKET;
+	write_le2(frame, 2U, (uint16_t)payload_length);
+	frame[REMOTE_BINARY_HEADER_LENGTH + payload_length] = REMOTE_EOM;
+	platform_buffer_write(frame, REMOTE_BINARY_FRAME_LENGTH(payload_length));
+}
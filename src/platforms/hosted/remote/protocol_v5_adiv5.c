@@ -0,0 +1,438 @@
+/*
+ * This file is part of the Black Magic Debug project.
+ *
+ * Copyright (C) 2026 1BitSquared <info@1bitsquared.com>
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived from
+ *    this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "bmp_remote.h"
+#include "buffer_utils.h"
+#include "protocol_v4_adiv5.h"
+#include "protocol_v5.h"
+#include "protocol_v5_defs.h"
+#include "protocol_v5_adiv5.h"
+#include "exception.h"
+
+/* Decode a result code sent as a little-endian value only as long as it needs to be */
+static uint64_t remote_v5_decode_response(const uint8_t *const response, const size_t length)
+{
+	uint64_t value = 0U;
+	for (size_t idx = MIN(length, sizeof(value)); idx; --idx)
+		value = (value << 8U) | response[idx - 1U];
+	return value;
+}
+
+bool remote_v5_adiv5_check_error(
+	const char *const func, adiv5_debug_port_s *const dp, const uint8_t *const buffer, const ssize_t length)
+{
+	/* Check the response length for error codes */
+	if (length < 1) {
+		DEBUG_ERROR("%s comms error: %zd\n", func, length);
+		return false;
+	}
+	/* Now check if the remote is reporting an error */
+	if (buffer[0] == REMOTE_RESP_ERR) {
+		const uint64_t response_code = remote_v5_decode_response(buffer + 1, (size_t)length - 1U);
+		const uint8_t error = response_code & 0xffU;
+		/* If the error part of the response code indicates a fault, store the fault value */
+		if (error == REMOTE_ERROR_FAULT) {
+			dp->fault = response_code >> 8U;
+			/*
+			 * If we're not handling errors for a function where no-response is non-fatal,
+			 * then turn any no-response fault codes into a fatal exception.
+			 */
+			if (dp->fault == SWD_ACK_NO_RESPONSE && strcmp(func, "remote_v5_adiv5_raw_access") != 0)
+				raise_exception(EXCEPTION_ERROR, "SWD invalid ACK");
+		}
+		/* If the error part indicates an exception had occurred, make that happen here too */
+		else if (error == REMOTE_ERROR_EXCEPTION)
+			raise_exception(response_code >> 8U, "Remote protocol exception");
+		/* Otherwise it's an unexpected error */
+		else
+			DEBUG_ERROR("%s: Unexpected error %u\n", func, error);
+	} /* Check if the remote is reporting a parameter error*/
+	else if (buffer[0] == REMOTE_RESP_PARERR)
+		DEBUG_ERROR("%s: !BUG! Firmware reported a parameter error\n", func);
+	/* Check if the firmware is reporting some other kind of error */
+	else if (buffer[0] != REMOTE_RESP_OK)
+		DEBUG_ERROR("%s: Firmware reported unexpected error: %c\n", func, buffer[0]);
+	/* Return whether the remote indicated the request was successful */
+	return buffer[0] == REMOTE_RESP_OK;
+}
+
+/* Build and send a binary ADIv5 register access request, returning the 32-bit result if there is one */
+static uint32_t remote_v5_adiv5_reg_access(const char *const func, adiv5_debug_port_s *const dp, const char command,
+	const uint8_t apsel, const uint16_t addr, const uint32_t value)
+{
+	remote_v4_adiv5_dp_version(dp);
+	remote_v4_adiv5_dp_targetsel(dp);
+	/* Reads carry only the address, writes (and raw accesses) also carry a value */
+	const bool has_value = command == REMOTE_AP_WRITE || command == REMOTE_ADIV5_RAW_ACCESS;
+	const size_t request_length =
+		has_value ? REMOTE_BINARY_ADIV5_REG_WRITE_LENGTH : REMOTE_BINARY_ADIV5_REG_READ_LENGTH;
+	uint8_t frame[REMOTE_BINARY_FRAME_LENGTH(REMOTE_BINARY_ADIV5_REG_WRITE_LENGTH)];
+	uint8_t *const request = frame + REMOTE_BINARY_HEADER_LENGTH;
+	request[0U] = REMOTE_ADIV5_PACKET;
+	request[1U] = command;
+	request[2U] = dp->dev_index;
+	request[3U] = apsel;
+	/* Remap the access from our current format to the remote register address format */
+	write_le2(request, 4U, (addr & ADIV5_APnDP ? REMOTE_ADIV5_APnDP : 0U) | (addr & 0x00ffU));
+	if (has_value)
+		write_le4(request, 6U, value);
+	remote_v5_send_frame(frame, request_length);
+
+	/* Read back the answer and check for errors */
+	uint8_t buffer[REMOTE_MAX_MSG_SIZE];
+	const int length = platform_buffer_read(buffer, REMOTE_MAX_MSG_SIZE);
+	if (!remote_v5_adiv5_check_error(func, dp, buffer, length))
+		return 0U;
+	/* If the response indicates all's OK, decode any data read and return it */
+	return length > 4 ? read_le4(buffer, 1U) : 0U;
+}
+
+uint32_t remote_v5_adiv5_raw_access(
+	adiv5_debug_port_s *const dp, const uint8_t rnw, const uint16_t addr, const uint32_t request_value)
+{
+	const uint32_t result_value =
+		remote_v5_adiv5_reg_access(__func__, dp, REMOTE_ADIV5_RAW_ACCESS, rnw, addr, request_value);
+	DEBUG_PROBE("%s: addr %04x %s %08" PRIx32, __func__, addr, rnw ? "->" : "<-", rnw ? result_value : request_value);
+	if (!rnw)
+		DEBUG_PROBE(" -> %08" PRIx32, result_value);
+	DEBUG_PROBE("\n");
+	return result_value;
+}
+
+uint32_t remote_v5_adiv5_dp_read(adiv5_debug_port_s *const dp, const uint16_t addr)
+{
+	/* DP reads have no AP to select, so as with the ASCII form, send 0xff */
+	const uint32_t value = remote_v5_adiv5_reg_access(__func__, dp, REMOTE_DP_READ, 0xffU, addr, 0U);
+	DEBUG_PROBE("%s: addr %04x -> %08" PRIx32 "\n", __func__, addr, value);
+	return value;
+}
+
+uint32_t remote_v5_adiv5_ap_read(adiv5_access_port_s *const ap, const uint16_t addr)
+{
+	const uint32_t value = remote_v5_adiv5_reg_access(__func__, ap->dp, REMOTE_AP_READ, ap->apsel, addr, 0U);
+	DEBUG_PROBE("%s: addr %04x -> %08" PRIx32 "\n", __func__, addr, value);
+	return value;
+}
+
+void remote_v5_adiv5_ap_write(adiv5_access_port_s *const ap, const uint16_t addr, const uint32_t value)
+{
+	remote_v5_adiv5_reg_access(__func__, ap->dp, REMOTE_AP_WRITE, ap->apsel, addr, value);
+	DEBUG_PROBE("%s: addr %04x <- %08" PRIx32 "\n", __func__, addr, value);
+}
+
+/* Read more than fits in a single response by having the probe stream the data back a block at a time */
+static void remote_v5_adiv5_mem_stream_read(adiv5_access_port_s *const ap, uint8_t *const data,
+	const target_addr64_t src, const size_t read_length, const size_t blocksize)
+{
+	uint8_t frame[REMOTE_BINARY_FRAME_LENGTH(REMOTE_BINARY_ADIV5_STREAM_READ_LENGTH)];
+	uint8_t *const request = frame + REMOTE_BINARY_HEADER_LENGTH;
+	request[0U] = REMOTE_ADIV5_PACKET;
+	request[1U] = REMOTE_MEM_STREAM_READ;
+	request[2U] = ap->dp->dev_index;
+	request[3U] = ap->apsel;
+	write_le4(request, 4U, ap->csw);
+	write_le8(request, 8U, src);
+	write_le4(request, 16U, read_length);
+	write_le2(request, 20U, (uint16_t)blocksize);
+	remote_v5_send_frame(frame, REMOTE_BINARY_ADIV5_STREAM_READ_LENGTH);
+
+	uint8_t buffer[REMOTE_V5_MAX_PACKET_SIZE + 1U];
+	/* Collect each of the responses in turn, the probe stops sending them after the first that's an error */
+	for (size_t offset = 0; offset < read_length; offset += blocksize) {
+		const size_t amount = MIN(read_length - offset, blocksize);
+		const int length = platform_buffer_read(buffer, sizeof(buffer));
+		if (!remote_v5_adiv5_check_error(__func__, ap->dp, buffer, length) || (size_t)length != amount + 1U) {
+			DEBUG_ERROR("%s error around 0x%08zx\n", __func__, (size_t)src + offset);
+			return;
+		}
+		/* If the response indicates all's OK, copy out the data read */
+		memcpy(data + offset, buffer + 1U, amount);
+	}
+}
+
+void remote_v5_adiv5_mem_read_bytes(
+	adiv5_access_port_s *const ap, void *const dest, const target_addr64_t src, const size_t read_length)
+{
+	/* Check if we have anything to do */
+	if (!read_length)
+		return;
+	remote_v4_adiv5_dp_version(ap->dp);
+	remote_v4_adiv5_dp_targetsel(ap->dp);
+	uint8_t *const data = (uint8_t *)dest;
+	DEBUG_PROBE("%s: @%08" PRIx64 "+%zx\n", __func__, src, read_length);
+	/* The data comes back unencoded, so we can read as much as fits in a message after the response code */
+	const size_t blocksize = remote_v5_max_packet_size() - 1U;
+	/* If there's more than one message's worth to read and the probe can stream it back, have it do so */
+	if (read_length > blocksize && read_length <= UINT32_MAX && remote_v5_mem_stream_available()) {
+		remote_v5_adiv5_mem_stream_read(ap, data, src, read_length, blocksize);
+		return;
+	}
+
+	uint8_t frame[REMOTE_BINARY_FRAME_LENGTH(REMOTE_BINARY_ADIV5_MEM_READ_LENGTH)];
+	uint8_t *const request = frame + REMOTE_BINARY_HEADER_LENGTH;
+	uint8_t buffer[REMOTE_V5_MAX_PACKET_SIZE + 1U];
+	/* For each transfer block size, ask the firmware to read that block of bytes */
+	for (size_t offset = 0; offset < read_length; offset += blocksize) {
+		/* Pick the amount left to read or the block size, whichever is smaller */
+		const size_t amount = MIN(read_length - offset, blocksize);
+		/* Create the request and send it to the remote */
+		request[0U] = REMOTE_ADIV5_PACKET;
+		request[1U] = REMOTE_MEM_READ;
+		request[2U] = ap->dp->dev_index;
+		request[3U] = ap->apsel;
+		write_le4(request, 4U, ap->csw);
+		write_le8(request, 8U, src + offset);
+		write_le4(request, 16U, amount);
+		remote_v5_send_frame(frame, REMOTE_BINARY_ADIV5_MEM_READ_LENGTH);
+
+		/* Read back the answer and check for errors */
+		const int length = platform_buffer_read(buffer, sizeof(buffer));
+		if (!remote_v5_adiv5_check_error(__func__, ap->dp, buffer, length) || (size_t)length != amount + 1U) {
+			DEBUG_ERROR("%s error around 0x%08zx\n", __func__, (size_t)src + offset);
+			return;
+		}
+		/* If the response indicates all's OK, copy out the data read */
+		memcpy(data + offset, buffer + 1U, amount);
+	}
+}
+
+/* Write more than fits in a single request by streaming the data to the probe, which answers once at the end */
+static void remote_v5_adiv5_mem_stream_write(adiv5_access_port_s *const ap, const target_addr64_t dest,
+	const uint8_t *const data, const size_t write_length, const align_e align)
+{
+	uint8_t frame[REMOTE_BINARY_FRAME_LENGTH(REMOTE_V5_MAX_PACKET_SIZE)];
+	uint8_t *const request = frame + REMOTE_BINARY_HEADER_LENGTH;
+	/* Start with the header saying where all the data is to go, then follow it with the data itself */
+	request[0U] = REMOTE_ADIV5_PACKET;
+	request[1U] = REMOTE_MEM_STREAM_WRITE;
+	request[2U] = ap->dp->dev_index;
+	request[3U] = ap->apsel;
+	write_le4(request, 4U, ap->csw);
+	request[8U] = align;
+	write_le8(request, 9U, dest);
+	write_le4(request, 17U, write_length);
+	remote_v5_send_frame(frame, REMOTE_BINARY_ADIV5_MEM_WRITE_LENGTH);
+
+	/* Each data frame carries as much as fits after its header, keeping to the alignment of the write */
+	const size_t alignment_mask = ~((1U << align) - 1U);
+	const size_t blocksize =
+		(remote_v5_max_packet_size() - REMOTE_BINARY_ADIV5_STREAM_DATA_LENGTH) & alignment_mask;
+	request[1U] = REMOTE_MEM_STREAM_DATA;
+	for (size_t offset = 0; offset < write_length; offset += blocksize) {
+		const size_t amount = MIN(write_length - offset, blocksize);
+		memcpy(request + REMOTE_BINARY_ADIV5_STREAM_DATA_LENGTH, data + offset, amount);
+		remote_v5_send_frame(frame, REMOTE_BINARY_ADIV5_STREAM_DATA_LENGTH + amount);
+	}
+
+	/* Read back the answer for the whole write and check for errors */
+	uint8_t buffer[REMOTE_MAX_MSG_SIZE];
+	const int length = platform_buffer_read(buffer, REMOTE_MAX_MSG_SIZE);
+	if (!remote_v5_adiv5_check_error(__func__, ap->dp, buffer, length))
+		DEBUG_ERROR("%s error writing 0x%08zx+%zx\n", __func__, (size_t)dest, write_length);
+}
+
+void remote_v5_adiv5_mem_write_bytes(adiv5_access_port_s *const ap, const target_addr64_t dest, const void *const src,
+	const size_t write_length, const align_e align)
+{
+	/* Check if we have anything to do */
+	if (!write_length)
+		return;
+	remote_v4_adiv5_dp_version(ap->dp);
+	remote_v4_adiv5_dp_targetsel(ap->dp);
+	const uint8_t *const data = (const uint8_t *)src;
+	DEBUG_PROBE("%s: @%08" PRIx64 "+%zx alignment %u\n", __func__, dest, write_length, align);
+	/* As we do, calculate how large a transfer we can do to the firmware, which is the message less the header */
+	const size_t alignment_mask = ~((1U << align) - 1U);
+	const size_t blocksize =
+		(remote_v5_max_packet_size() - REMOTE_BINARY_ADIV5_MEM_WRITE_LENGTH) & alignment_mask;
+	/* If there's more than one message's worth to write and the probe can take it as a stream, send it so */
+	if (write_length > blocksize && write_length <= UINT32_MAX && remote_v5_mem_stream_available()) {
+		remote_v5_adiv5_mem_stream_write(ap, dest, data, write_length, align);
+		return;
+	}
+
+	uint8_t frame[REMOTE_BINARY_FRAME_LENGTH(REMOTE_V5_MAX_PACKET_SIZE)];
+	uint8_t *const request = frame + REMOTE_BINARY_HEADER_LENGTH;
+	/* For each transfer block size, ask the firmware to write that block of bytes */
+	for (size_t offset = 0; offset < write_length; offset += blocksize) {
+		/* Pick the amount left to write or the block size, whichever is smaller */
+		const size_t amount = MIN(write_length - offset, blocksize);
+		/* Create the request with the data to write following it, and send it to the remote */
+		request[0U] = REMOTE_ADIV5_PACKET;
+		request[1U] = REMOTE_MEM_WRITE;
+		request[2U] = ap->dp->dev_index;
+		request[3U] = ap->apsel;
+		write_le4(request, 4U, ap->csw);
+		request[8U] = align;
+		write_le8(request, 9U, dest + offset);
+		write_le4(request, 17U, amount);
+		memcpy(request + REMOTE_BINARY_ADIV5_MEM_WRITE_LENGTH, data + offset, amount);
+		remote_v5_send_frame(frame, REMOTE_BINARY_ADIV5_MEM_WRITE_LENGTH + amount);
+
+		/* Read back the answer and check for errors */
+		uint8_t buffer[REMOTE_MAX_MSG_SIZE];
+		const int length = platform_buffer_read(buffer, REMOTE_MAX_MSG_SIZE);
+		if (!remote_v5_adiv5_check_error(__func__, ap->dp, buffer, length)) {
+			DEBUG_ERROR("%s error around 0x%08zx\n", __func__, (size_t)dest + offset);
+			return;
+		}
+	}
+}
+
+static bool remote_v5_adiv5_batch_op_is_read(const adiv5_batch_op_s *const op)
+{
+	return op->type == ADIV5_BATCH_DP_READ || op->type == ADIV5_BATCH_AP_READ || op->type == ADIV5_BATCH_AP_POLL;
+}
+
+/* How many bytes an operation takes up in a batch request */
+static size_t remote_v5_adiv5_batch_op_length(const adiv5_batch_op_s *const op)
+{
+	switch (op->type) {
+	case ADIV5_BATCH_DP_READ:
+		return 3U;
+	case ADIV5_BATCH_DP_WRITE:
+		return 7U;
+	case ADIV5_BATCH_AP_READ:
+		return 4U;
+	case ADIV5_BATCH_AP_WRITE:
+		return 8U;
+	case ADIV5_BATCH_AP_POLL:
+	default:
+		return REMOTE_ADIV5_BATCH_MAX_OP_LENGTH;
+	}
+}
+
+/* Run count operations of a batch in one request, returning false if that failed */
+static bool remote_v5_adiv5_batch_run_ops(
+	adiv5_debug_port_s *const dp, const adiv5_batch_op_s *const ops, const size_t count)
+{
+	uint8_t frame[REMOTE_BINARY_FRAME_LENGTH(
+		REMOTE_BINARY_ADIV5_BATCH_LENGTH + (ADIV5_BATCH_MAX_OPS * REMOTE_ADIV5_BATCH_MAX_OP_LENGTH))];
+	uint8_t *const request = frame + REMOTE_BINARY_HEADER_LENGTH;
+	request[0U] = REMOTE_ADIV5_PACKET;
+	request[1U] = REMOTE_ADIV5_BATCH;
+	request[2U] = dp->dev_index;
+	request[3U] = (uint8_t)count;
+	size_t offset = REMOTE_BINARY_ADIV5_BATCH_LENGTH;
+	size_t result_count = 0U;
+	/* Encode each of the operations in turn, remapping the addresses to the remote register address format */
+	for (size_t idx = 0U; idx < count; ++idx) {
+		const adiv5_batch_op_s *const op = &ops[idx];
+		const uint16_t addr = (op->addr & ADIV5_APnDP ? REMOTE_ADIV5_APnDP : 0U) | (op->addr & 0x00ffU);
+		switch (op->type) {
+		case ADIV5_BATCH_DP_READ:
+			request[offset] = REMOTE_ADIV5_BATCH_DP_READ;
+			write_le2(request, offset + 1U, addr);
+			offset += 3U;
+			++result_count;
+			break;
+		case ADIV5_BATCH_DP_WRITE:
+			request[offset] = REMOTE_ADIV5_BATCH_DP_WRITE;
+			write_le2(request, offset + 1U, addr);
+			write_le4(request, offset + 3U, op->value);
+			offset += 7U;
+			break;
+		case ADIV5_BATCH_AP_READ:
+			request[offset] = REMOTE_ADIV5_BATCH_AP_READ;
+			request[offset + 1U] = op->ap->apsel;
+			write_le2(request, offset + 2U, addr);
+			offset += 4U;
+			++result_count;
+			break;
+		case ADIV5_BATCH_AP_WRITE:
+			request[offset] = REMOTE_ADIV5_BATCH_AP_WRITE;
+			request[offset + 1U] = op->ap->apsel;
+			write_le2(request, offset + 2U, addr);
+			write_le4(request, offset + 4U, op->value);
+			offset += 8U;
+			break;
+		case ADIV5_BATCH_AP_POLL:
+			request[offset] = REMOTE_ADIV5_BATCH_AP_POLL;
+			request[offset + 1U] = op->ap->apsel;
+			write_le2(request, offset + 2U, addr);
+			write_le4(request, offset + 4U, op->mask);
+			write_le4(request, offset + 8U, op->value);
+			write_le2(request, offset + 12U, op->timeout);
+			offset += 14U;
+			++result_count;
+			break;
+		}
+	}
+	remote_v5_send_frame(frame, offset);
+	DEBUG_PROBE("%s: %zu operations, %zu results\n", __func__, count, result_count);
+
+	/* Read back the answer and check for errors, any results not read back are left as 0 */
+	uint8_t buffer[REMOTE_MAX_MSG_SIZE];
+	const int length = platform_buffer_read(buffer, REMOTE_MAX_MSG_SIZE);
+	if (!remote_v5_adiv5_check_error(__func__, dp, buffer, length))
+		return false;
+	if ((size_t)length != 1U + (result_count * 4U)) {
+		DEBUG_ERROR("%s: Expected %zu results, got %d bytes\n", __func__, result_count, length - 1);
+		return false;
+	}
+	/* If the response indicates all's OK, hand each result back to the operation that asked for it */
+	size_t result = 0U;
+	for (size_t idx = 0U; idx < count; ++idx) {
+		const adiv5_batch_op_s *const op = &ops[idx];
+		if (remote_v5_adiv5_batch_op_is_read(op))
+			*op->result = read_le4(buffer, 1U + (4U * result++));
+	}
+	return true;
+}
+
+void remote_v5_adiv5_batch_run(adiv5_debug_port_s *const dp, const adiv5_batch_s *const batch)
+{
+	remote_v4_adiv5_dp_version(dp);
+	remote_v4_adiv5_dp_targetsel(dp);
+	/*
+	 * Split the batch into as many requests as it takes for each one, and the results it sends back,
+	 * to fit within the packet size the probe can handle
+	 */
+	const size_t max_length = remote_v5_max_packet_size();
+	for (size_t begin = 0U; begin < batch->count;) {
+		size_t length = REMOTE_BINARY_ADIV5_BATCH_LENGTH;
+		size_t results = 0U;
+		size_t end = begin;
+		for (; end < batch->count; ++end) {
+			const adiv5_batch_op_s *const op = &batch->ops[end];
+			const size_t op_results = results + (remote_v5_adiv5_batch_op_is_read(op) ? 1U : 0U);
+			if (end != begin &&
+				(length + remote_v5_adiv5_batch_op_length(op) > max_length || 1U + (op_results * 4U) > max_length))
+				break;
+			length += remote_v5_adiv5_batch_op_length(op);
+			results = op_results;
+		}
+		if (!remote_v5_adiv5_batch_run_ops(dp, batch->ops + begin, end - begin))
+			return;
+		begin = end;
+	}
+}
@@ -0,0 +1,161 @@
+/*
+ * This file is part of the Black Magic Debug project.
+ *
+ * Copyright (C) 2026 1BitSquared <info@1bitsquared.com>
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived from
+ *    this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "bmp_remote.h"
+#include "buffer_utils.h"
+#include "protocol_v5.h"
+#include "protocol_v5_defs.h"
+#include "protocol_v5_adiv5.h"
+#include "protocol_v5_adiv6.h"
+
+/* Fill in the header common to all binary ADIv6 requests */
+static void remote_v5_adiv6_request_header(
+	uint8_t *const request, const char command, const adiv6_access_port_s *const ap)
+{
+	request[0U] = REMOTE_ADIV5_PACKET;
+	request[1U] = REMOTE_ADIV6_PACKET;
+	request[2U] = command;
+	request[3U] = ap->base.dp->dev_index;
+	write_le8(request, 4U, ap->ap_address);
+}
+
+uint32_t remote_v5_adiv6_ap_read(adiv5_access_port_s *const base_ap, const uint16_t addr)
+{
+	adiv6_access_port_s *const ap = (adiv6_access_port_s *)base_ap;
+	/* Create the request and send it to the remote */
+	uint8_t frame[REMOTE_BINARY_FRAME_LENGTH(REMOTE_BINARY_ADIV6_REG_READ_LENGTH)];
+	uint8_t *const request = frame + REMOTE_BINARY_HEADER_LENGTH;
+	remote_v5_adiv6_request_header(request, REMOTE_AP_READ, ap);
+	write_le2(request, 12U, addr);
+	remote_v5_send_frame(frame, REMOTE_BINARY_ADIV6_REG_READ_LENGTH);
+	/* Read back the answer and check for errors */
+	uint8_t buffer[REMOTE_MAX_MSG_SIZE];
+	const int length = platform_buffer_read(buffer, REMOTE_MAX_MSG_SIZE);
+	if (!remote_v5_adiv5_check_error(__func__, ap->base.dp, buffer, length))
+		return 0U;
+	/* If the response indicates all's OK, decode the data read and return it */
+	const uint32_t value = length > 4 ? read_le4(buffer, 1U) : 0U;
+	DEBUG_PROBE("%s: addr %04x -> %08" PRIx32 "\n", __func__, addr, value);
+	return value;
+}
+
+void remote_v5_adiv6_ap_write(adiv5_access_port_s *const base_ap, const uint16_t addr, const uint32_t value)
+{
+	adiv6_access_port_s *const ap = (adiv6_access_port_s *)base_ap;
+	/* Create the request and send it to the remote */
+	uint8_t frame[REMOTE_BINARY_FRAME_LENGTH(REMOTE_BINARY_ADIV6_REG_WRITE_LENGTH)];
+	uint8_t *const request = frame + REMOTE_BINARY_HEADER_LENGTH;
+	remote_v5_adiv6_request_header(request, REMOTE_AP_WRITE, ap);
+	write_le2(request, 12U, addr);
+	write_le4(request, 14U, value);
+	remote_v5_send_frame(frame, REMOTE_BINARY_ADIV6_REG_WRITE_LENGTH);
+	/* Read back the answer and check for errors */
+	uint8_t buffer[REMOTE_MAX_MSG_SIZE];
+	const int length = platform_buffer_read(buffer, REMOTE_MAX_MSG_SIZE);
+	if (!remote_v5_adiv5_check_error(__func__, ap->base.dp, buffer, length))
+		return;
+	DEBUG_PROBE("%s: addr %04x <- %08" PRIx32 "\n", __func__, addr, value);
+}
+
+void remote_v5_adiv6_mem_read_bytes(
+	adiv5_access_port_s *const base_ap, void *const dest, const target_addr64_t src, const size_t read_length)
+{
+	/* Check if we have anything to do */
+	if (!read_length)
+		return;
+	adiv6_access_port_s *const ap = (adiv6_access_port_s *)base_ap;
+	uint8_t *const data = (uint8_t *)dest;
+	DEBUG_PROBE("%s: @%08" PRIx64 "+%zx\n", __func__, src, read_length);
+	uint8_t frame[REMOTE_BINARY_FRAME_LENGTH(REMOTE_BINARY_ADIV6_MEM_READ_LENGTH)];
+	uint8_t *const request = frame + REMOTE_BINARY_HEADER_LENGTH;
+	uint8_t buffer[REMOTE_V5_MAX_PACKET_SIZE + 1U];
+	/* The data comes back unencoded, so we can read as much as fits in a message after the response code */
+	const size_t blocksize = remote_v5_max_packet_size() - 1U;
+	/* For each transfer block size, ask the firmware to read that block of bytes */
+	for (size_t offset = 0; offset < read_length; offset += blocksize) {
+		/* Pick the amount left to read or the block size, whichever is smaller */
+		const size_t amount = MIN(read_length - offset, blocksize);
+		/* Create the request and send it to the remote */
+		remote_v5_adiv6_request_header(request, REMOTE_MEM_READ, ap);
+		write_le4(request, 12U, ap->base.csw);
+		write_le8(request, 16U, src + offset);
+		write_le4(request, 24U, amount);
+		remote_v5_send_frame(frame, REMOTE_BINARY_ADIV6_MEM_READ_LENGTH);
+
+		/* Read back the answer and check for errors */
+		const int length = platform_buffer_read(buffer, sizeof(buffer));
+		if (!remote_v5_adiv5_check_error(__func__, ap->base.dp, buffer, length) || (size_t)length != amount + 1U) {
+			DEBUG_ERROR("%s error around 0x%08zx\n", __func__, (size_t)src + offset);
+			return;
+		}
+		/* If the response indicates all's OK, copy out the data read */
+		memcpy(data + offset, buffer + 1U, amount);
+	}
+}
+
+void remote_v5_adiv6_mem_write_bytes(adiv5_access_port_s *const base_ap, const target_addr64_t dest,
+	const void *const src, const size_t write_length, const align_e align)
+{
+	/* Check if we have anything to do */
+	if (!write_length)
+		return;
+	adiv6_access_port_s *const ap = (adiv6_access_port_s *)base_ap;
+	const uint8_t *const data = (const uint8_t *)src;
+	DEBUG_PROBE("%s: @%08" PRIx64 "+%zx alignment %u\n", __func__, dest, write_length, align);
+	uint8_t frame[REMOTE_BINARY_FRAME_LENGTH(REMOTE_V5_MAX_PACKET_SIZE)];
+	uint8_t *const request = frame + REMOTE_BINARY_HEADER_LENGTH;
+	/* As we do, calculate how large a transfer we can do to the firmware, which is the message less the header */
+	const size_t alignment_mask = ~((1U << align) - 1U);
+	const size_t blocksize =
+		(remote_v5_max_packet_size() - REMOTE_BINARY_ADIV6_MEM_WRITE_LENGTH) & alignment_mask;
+	/* For each transfer block size, ask the firmware to write that block of bytes */
+	for (size_t offset = 0; offset < write_length; offset += blocksize) {
+		/* Pick the amount left to write or the block size, whichever is smaller */
+		const size_t amount = MIN(write_length - offset, blocksize);
+		/* Create the request with the data to write following it, and send it to the remote */
+		remote_v5_adiv6_request_header(request, REMOTE_MEM_WRITE, ap);
+		write_le4(request, 12U, ap->base.csw);
+		request[16U] = align;
+		write_le8(request, 17U, dest + offset);
+		write_le4(request, 25U, amount);
+		memcpy(request + REMOTE_BINARY_ADIV6_MEM_WRITE_LENGTH, data + offset, amount);
+		remote_v5_send_frame(frame, REMOTE_BINARY_ADIV6_MEM_WRITE_LENGTH + amount);
+
+		/* Read back the answer and check for errors */
+		uint8_t buffer[REMOTE_MAX_MSG_SIZE];
+		const int length = platform_buffer_read(buffer, REMOTE_MAX_MSG_SIZE);
+		if (!remote_v5_adiv5_check_error(__func__, ap->base.dp, buffer, length)) {
+			DEBUG_ERROR("%s error around 0x%08zx\n", __func__, (size_t)dest + offset);
+			return;
+		}
+	}
+}
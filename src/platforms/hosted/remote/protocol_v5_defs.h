@@ -0,0 +1,181 @@
+/*
+ * This file is part of the Black Magic Debug project.
+ *
+ * Copyright (C) 2026 1BitSquared <info@1bitsquared.com>
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived from
+ *    this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef PLATFORMS_HOSTED_REMOTE_PROTOCOL_V5_DEFS_H
+#define PLATFORMS_HOSTED_REMOTE_PROTOCOL_V5_DEFS_H
+
+/* Bring in the v4 protocol definitions, this version only adds to them */
+#include "protocol_v4_defs.h"
+
+/*
+ * This version of the protocol introduces binary frames for the ADIv5 and ADIv6 acceleration and SPI requests.
+ * These are sent as !B<LEN><PAYLOAD># where <LEN> is the 16-bit little-endian length of <PAYLOAD>, which
+ * is the same packet and command bytes as the ASCII forms followed by the parameters in little-endian binary
+ * and any data unencoded. Responses come back as &B<LEN><RESP><DATA>#, where <LEN> covers the response code
+ * and data, and result codes are a little-endian value only as long as needed to hold them.
+ */
+#define REMOTE_BINARY_PACKET        'B'
+#define REMOTE_BINARY_HEADER_LENGTH 4U
+/* The length of a whole binary frame carrying the given payload length */
+#define REMOTE_BINARY_FRAME_LENGTH(payload_length) (REMOTE_BINARY_HEADER_LENGTH + (payload_length) + 1U)
+
+/*
+ * Probes that know about it answer this with the largest binary payload they can take, and so also send back,
+ * in one frame. Probes that don't are limited to REMOTE_MAX_MSG_SIZE, and can't stream memory transfers.
+ */
+#define REMOTE_HL_MAX_PACKET 'M'
+#define REMOTE_HL_MAX_PACKET_STR                                          \
+	(char[])                                                              \
+	{                                                                     \
+		REMOTE_SOM, REMOTE_HL_PACKET, REMOTE_HL_MAX_PACKET, REMOTE_EOM, 0 \
+	}
+/* The bounds we put on the probe's answer, the upper one being what our own frame buffers are sized for */
+#define REMOTE_V5_MIN_PACKET_SIZE 64U
+#define REMOTE_V5_MAX_PACKET_SIZE 8192U
+
+/*
+ * Binary ADIv5 acceleration requests start with the packet and command bytes, then the dev index and
+ * AP selection (which, as with the ASCII form, is R/!W for raw accesses), followed by:
+ *  - DP read, AP read: 16-bit address
+ *  - AP write, raw access: 16-bit address, 32-bit value
+ *  - memory read: 32-bit CSW, 64-bit address, 32-bit count
+ *  - memory write: 32-bit CSW, 8-bit alignment, 64-bit address, 32-bit count, then the data to write
+ */
+#define REMOTE_BINARY_ADIV5_REG_READ_LENGTH  6U
+#define REMOTE_BINARY_ADIV5_REG_WRITE_LENGTH 10U
+#define REMOTE_BINARY_ADIV5_MEM_READ_LENGTH  20U
+#define REMOTE_BINARY_ADIV5_MEM_WRITE_LENGTH 21U
+
+/*
+ * Binary ADIv5 streaming memory requests move more data than fits in a single frame:
+ *  - stream read ('s'): as for memory read, followed by the 16-bit maximum data length per response frame.
+ *    The probe answers with consecutive responses each carrying the next block of data, until either all
+ *    the data is sent or a response reports an error
+ *  - stream write ('S'): as for memory write, but without any data. The data then follows in stream data
+ *    frames ('D'), each the packet and command bytes then the next block of data. The probe answers just
+ *    once, after the last of the data, with the result of the whole write
+ */
+#define REMOTE_MEM_STREAM_READ                 's'
+#define REMOTE_MEM_STREAM_WRITE                'S'
+#define REMOTE_MEM_STREAM_DATA                 'D'
+#define REMOTE_BINARY_ADIV5_STREAM_READ_LENGTH 22U
+#define REMOTE_BINARY_ADIV5_STREAM_DATA_LENGTH 2U
+
+/* Probes advertising this acceleration can run batches of ADIv5 DP and AP operations in a single request */
+#define REMOTE_ACCEL_ADIV5_BATCH (1U << 5U)
+
+/*
+ * Binary ADIv5 batch requests start with the packet and command bytes, then the dev index and the number of
+ * operations in the batch, followed by each operation as its op byte and parameters:
+ *  - DP read ('d'): 16-bit address
+ *  - DP write ('D'): 16-bit address, 32-bit value
+ *  - AP read ('a'): AP selection, 16-bit address
+ *  - AP write ('A'): AP selection, 16-bit address, 32-bit value
+ *  - AP poll ('p'): AP selection, 16-bit address, 32-bit mask, 32-bit value, 16-bit timeout in milliseconds
+ * On success, the response carries the 32-bit result of each read and poll operation, in request order.
+ */
+#define REMOTE_ADIV5_BATCH                'B'
+#define REMOTE_BINARY_ADIV5_BATCH_LENGTH  4U
+#define REMOTE_BINARY_ADIV5_BATCH_MAX_OPS 64U
+#define REMOTE_ADIV5_BATCH_DP_READ        'd'
+#define REMOTE_ADIV5_BATCH_DP_WRITE       'D'
+#define REMOTE_ADIV5_BATCH_AP_READ        'a'
+#define REMOTE_ADIV5_BATCH_AP_WRITE       'A'
+#define REMOTE_ADIV5_BATCH_AP_POLL        'p'
+/* The longest single operation in a batch request is an AP poll */
+#define REMOTE_ADIV5_BATCH_MAX_OP_LENGTH 14U
+
+/*
+ * Binary ADIv6 acceleration requests start with the packet, ADIv6 and command bytes, then the dev index
+ * and 64-bit DP resource bus AP base address, followed by the same parameters as their ADIv5 counterparts
+ */
+#define REMOTE_BINARY_ADIV6_REG_READ_LENGTH  14U
+#define REMOTE_BINARY_ADIV6_REG_WRITE_LENGTH 18U
+#define REMOTE_BINARY_ADIV6_MEM_READ_LENGTH  28U
+#define REMOTE_BINARY_ADIV6_MEM_WRITE_LENGTH 29U
+
+/* Probes advertising this acceleration can run whole memory accesses and register reads on 32-bit RISC-V Harts */
+#define REMOTE_ACCEL_RISCV_HART (1U << 6U)
+
+/*
+ * The RISC-V Hart-level requests are ASCII, as with the other RISC-V requests, and carry the DM base address,
+ * Hart flags and progbuf size after the DMI parameters. The responses lead with the resulting Hart status
+ * and Hart flags
+ */
+#define REMOTE_RISCV_MEM_READ     'm'
+#define REMOTE_RISCV_MEM_WRITE    'M'
+#define REMOTE_RISCV_REGS_READ    'g'
+#define REMOTE_RISCV_DM_BASE      REMOTE_UINT32
+#define REMOTE_RISCV_HART_FLAGS   REMOTE_UINT8
+#define REMOTE_RISCV_PROGBUF_SIZE REMOTE_UINT8
+#define REMOTE_RISCV_COUNT        REMOTE_UINT32
+#define REMOTE_RISCV_GPRS_COUNT   REMOTE_UINT8
+
+#define REMOTE_RISCV_MEM_READ_STR                                                                                 \
+	(char[])                                                                                                      \
+	{                                                                                                             \
+		REMOTE_SOM, REMOTE_RISCV_PACKET, REMOTE_RISCV_MEM_READ, REMOTE_RISCV_DEV_INDEX, REMOTE_RISCV_IDLE_CYCLES, \
+			REMOTE_RISCV_ADDR_WIDTH, REMOTE_RISCV_DM_BASE, REMOTE_RISCV_HART_FLAGS, REMOTE_RISCV_PROGBUF_SIZE,    \
+			REMOTE_RISCV_ADDR32, REMOTE_RISCV_COUNT, REMOTE_EOM, 0                                                \
+	}
+/* 2 leader bytes, 2 for the Hart status, 2 for the Hart flags and one trailer byte gives 7 bytes response overhead */
+#define REMOTE_RISCV_MEM_READ_LENGTH 7U
+#define REMOTE_RISCV_MEM_WRITE_STR                                                                                 \
+	(char[])                                                                                                       \
+	{                                                                                                              \
+		REMOTE_SOM, REMOTE_RISCV_PACKET, REMOTE_RISCV_MEM_WRITE, REMOTE_RISCV_DEV_INDEX, REMOTE_RISCV_IDLE_CYCLES, \
+			REMOTE_RISCV_ADDR_WIDTH, REMOTE_RISCV_DM_BASE, REMOTE_RISCV_HART_FLAGS, REMOTE_RISCV_PROGBUF_SIZE,     \
+			REMOTE_RISCV_ADDR32, REMOTE_RISCV_COUNT, 0                                                             \
+	}
+/*
+ * 3 leader bytes + 2 bytes for dev index + 2 for idle cycles + 2 for the address width + 8 for the DM base +
+ * 2 for the Hart flags + 2 for the progbuf size + 8 for the address and 8 for the count and one trailer gives
+ * 38 bytes request overhead
+ */
+#define REMOTE_RISCV_MEM_WRITE_LENGTH 38U
+#define REMOTE_RISCV_REGS_READ_STR                                                                                 \
+	(char[])                                                                                                       \
+	{                                                                                                              \
+		REMOTE_SOM, REMOTE_RISCV_PACKET, REMOTE_RISCV_REGS_READ, REMOTE_RISCV_DEV_INDEX, REMOTE_RISCV_IDLE_CYCLES, \
+			REMOTE_RISCV_ADDR_WIDTH, REMOTE_RISCV_DM_BASE, REMOTE_RISCV_HART_FLAGS, REMOTE_RISCV_PROGBUF_SIZE,     \
+			REMOTE_RISCV_GPRS_COUNT, REMOTE_EOM, 0                                                                 \
+	}
+
+/*
+ * Binary SPI requests start with the packet and command bytes, then the bus and device to use, followed by
+ * the 16-bit SPI Flash command, the 32-bit address and 16-bit data length for the operation, then any data
+ * to write. Program requests also enable writing before, and wait for the Flash to finish after, the write.
+ */
+#define REMOTE_SPI_PROGRAM       'p'
+#define REMOTE_BINARY_SPI_LENGTH 12U
+
+#endif /*PLATFORMS_HOSTED_REMOTE_PROTOCOL_V5_DEFS_H*/
@@ -0,0 +1,156 @@
+/*
+ * This file is part of the Black Magic Debug project.
+ *
+ * Copyright (C) 2026 1BitSquared <info@1bitsquared.com>
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived from
+ *    this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <assert.h>
+#include "bmp_remote.h"
+#include "protocol_v4_riscv.h"
+#include "protocol_v5_defs.h"
+#include "protocol_v5_riscv.h"
+#include "hex_utils.h"
+
+/*
+ * Check the response to a Hart-level request for errors, then pick up the Hart status and flags it leads with.
+ * The probe may have learnt something about the Hart running the request (that it lacks CSR access, say),
+ * so its flags replace ours
+ */
+static bool remote_v5_riscv_hart_check_error(
+	const char *const func, riscv_hart_s *const hart, const char *const buffer, const ssize_t length)
+{
+	if (!remote_v4_riscv_check_error(func, hart->dbg_module->dmi_bus, buffer, length))
+		return false;
+	if (length < 5) {
+		DEBUG_ERROR("%s: Response is missing the Hart status and flags\n", func);
+		return false;
+	}
+	uint8_t status = 0U;
+	unhexify(&status, buffer + 1U, 1U);
+	uint8_t flags = 0U;
+	unhexify(&flags, buffer + 3U, 1U);
+	hart->status = status;
+	hart->flags = flags;
+	if (hart->status != RISCV_HART_NO_ERROR)
+		DEBUG_WARN("%s: Hart reported error %u\n", func, status);
+	return hart->status == RISCV_HART_NO_ERROR;
+}
+
+void remote_v5_riscv32_mem_read(
+	riscv_hart_s *const hart, void *const dest, const target_addr_t src, const size_t read_length)
+{
+	riscv_dmi_s *const dmi = hart->dbg_module->dmi_bus;
+	uint8_t *const data = (uint8_t *)dest;
+	DEBUG_PROBE("%s: @%08" PRIx32 "+%zx\n", __func__, src, read_length);
+	char buffer[REMOTE_MAX_MSG_SIZE];
+	/*
+	 * As we do, calculate how large a transfer we can do to the firmware. The data comes back hex-encoded after
+	 * the Hart status and flags, and we keep to whole words so each block after the first stays aligned
+	 */
+	const size_t blocksize = ((REMOTE_MAX_MSG_SIZE - REMOTE_RISCV_MEM_READ_LENGTH) / 2U) & ~3U;
+	/* For each transfer block size, ask the firmware to read that block of bytes */
+	for (size_t offset = 0; offset < read_length; offset += blocksize) {
+		/* Pick the amount left to read or the block size, whichever is smaller */
+		const size_t amount = MIN(read_length - offset, blocksize);
+		/* Create the request and send it to the remote */
+		ssize_t length = snprintf(buffer, REMOTE_MAX_MSG_SIZE, REMOTE_RISCV_MEM_READ_STR, dmi->dev_index,
+			dmi->idle_cycles, dmi->address_width, hart->dbg_module->base, hart->flags, hart->progbuf_size,
+			(uint32_t)(src + offset), (uint32_t)amount);
+		platform_buffer_write(buffer, length);
+
+		/* Read back the answer and check for errors */
+		length = platform_buffer_read(buffer, REMOTE_MAX_MSG_SIZE);
+		if (!remote_v5_riscv_hart_check_error(__func__, hart, buffer, length) ||
+			(size_t)length != 5U + (amount * 2U)) {
+			DEBUG_ERROR("%s error around 0x%08" PRIx32 "\n", __func__, (uint32_t)(src + offset));
+			return;
+		}
+		/* If the response indicates all's OK, decode the data read */
+		unhexify(data + offset, buffer + 5U, amount);
+	}
+}
+
+void remote_v5_riscv32_mem_write(
+	riscv_hart_s *const hart, const target_addr_t dest, const void *const src, const size_t write_length)
+{
+	riscv_dmi_s *const dmi = hart->dbg_module->dmi_bus;
+	const uint8_t *const data = (const uint8_t *)src;
+	DEBUG_PROBE("%s: @%08" PRIx32 "+%zx\n", __func__, dest, write_length);
+	/* + 1 for terminating NUL character */
+	char buffer[REMOTE_MAX_MSG_SIZE + 1U];
+	/* As we do, calculate how large a transfer we can do to the firmware, keeping to whole words as for reads */
+	const size_t blocksize = ((REMOTE_MAX_MSG_SIZE - REMOTE_RISCV_MEM_WRITE_LENGTH) / 2U) & ~3U;
+	/* For each transfer block size, ask the firmware to write that block of bytes */
+	for (size_t offset = 0; offset < write_length; offset += blocksize) {
+		/* Pick the amount left to write or the block size, whichever is smaller */
+		const size_t amount = MIN(write_length - offset, blocksize);
+		/* Create the request and validate it ends up the right length */
+		ssize_t length = snprintf(buffer, REMOTE_MAX_MSG_SIZE, REMOTE_RISCV_MEM_WRITE_STR, dmi->dev_index,
+			dmi->idle_cycles, dmi->address_width, hart->dbg_module->base, hart->flags, hart->progbuf_size,
+			(uint32_t)(dest + offset), (uint32_t)amount);
+		assert(length == REMOTE_RISCV_MEM_WRITE_LENGTH - 1U);
+		/* Encode the data to send after the request block and append the packet termination marker */
+		hexify(buffer + length, data + offset, amount);
+		length += (ssize_t)(amount * 2U);
+		buffer[length++] = REMOTE_EOM;
+		buffer[length++] = '\0';
+		platform_buffer_write(buffer, length);
+
+		/* Read back the answer and check for errors */
+		length = platform_buffer_read(buffer, REMOTE_MAX_MSG_SIZE);
+		if (!remote_v5_riscv_hart_check_error(__func__, hart, buffer, length)) {
+			DEBUG_ERROR("%s error around 0x%08" PRIx32 "\n", __func__, (uint32_t)(dest + offset));
+			return;
+		}
+	}
+}
+
+bool remote_v5_riscv32_regs_read(riscv_hart_s *const hart, uint32_t *const regs, const size_t gprs_count)
+{
+	riscv_dmi_s *const dmi = hart->dbg_module->dmi_bus;
+	/* Format the register read request into a new buffer and send it to the probe */
+	char buffer[REMOTE_MAX_MSG_SIZE];
+	ssize_t length = snprintf(buffer, REMOTE_MAX_MSG_SIZE, REMOTE_RISCV_REGS_READ_STR, dmi->dev_index,
+		dmi->idle_cycles, dmi->address_width, hart->dbg_module->base, hart->flags, hart->progbuf_size,
+		(uint8_t)gprs_count);
+	platform_buffer_write(buffer, length);
+
+	/* Read back the answer and check for errors, the GPRs being followed by the PC */
+	const size_t regs_length = (gprs_count + 1U) * 4U;
+	length = platform_buffer_read(buffer, REMOTE_MAX_MSG_SIZE);
+	if (!remote_v5_riscv_hart_check_error(__func__, hart, buffer, length) ||
+		(size_t)length != 5U + (regs_length * 2U)) {
+		DEBUG_ERROR("%s failed\n", __func__);
+		return false;
+	}
+	/* If the response indicates all's OK, decode the registers read */
+	unhexify(regs, buffer + 5U, regs_length);
+	DEBUG_PROBE("%s: %zu GPRs, pc = %08" PRIx32 "\n", __func__, gprs_count, regs[gprs_count]);
+	return true;
+}
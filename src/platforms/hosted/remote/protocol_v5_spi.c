@@ -0,0 +1,142 @@
+/*
+ * This file is part of the Black Magic Debug project.
+ *
+ * Copyright (C) 2026 1BitSquared <info@1bitsquared.com>
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived from
+ *    this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "bmp_remote.h"
+#include "buffer_utils.h"
+#include "protocol_v5.h"
+#include "protocol_v5_defs.h"
+#include "protocol_v5_spi.h"
+
+/* Build and send a binary SPI request, with any data to write following it */
+static void remote_v5_spi_request(const char command, const spi_bus_e bus, const uint8_t device,
+	const uint16_t spi_command, const target_addr32_t address, const void *const data, const size_t length)
+{
+	uint8_t frame[REMOTE_BINARY_FRAME_LENGTH(REMOTE_V5_MAX_PACKET_SIZE)];
+	uint8_t *const request = frame + REMOTE_BINARY_HEADER_LENGTH;
+	request[0U] = REMOTE_SPI_PACKET;
+	request[1U] = command;
+	request[2U] = bus;
+	request[3U] = device;
+	write_le2(request, 4U, spi_command);
+	write_le4(request, 6U, address);
+	write_le2(request, 10U, (uint16_t)length);
+	/* Reads carry no data, only the length to read */
+	const size_t data_length = command == REMOTE_SPI_READ ? 0U : length;
+	if (data_length)
+		memcpy(request + REMOTE_BINARY_SPI_LENGTH, data, data_length);
+	remote_v5_send_frame(frame, REMOTE_BINARY_SPI_LENGTH + data_length);
+}
+
+/*
+ * Read back the response to a SPI request into buffer, which must be REMOTE_V5_MAX_PACKET_SIZE + 1 bytes long,
+ * and check it for errors, returning the response length if it's OK
+ */
+static int remote_v5_spi_response(const char *const func, uint8_t *const buffer)
+{
+	const int length = platform_buffer_read(buffer, REMOTE_V5_MAX_PACKET_SIZE + 1U);
+	if (length < 1) {
+		DEBUG_ERROR("%s comms error: %d\n", func, length);
+		return -1;
+	}
+	if (buffer[0] != REMOTE_RESP_OK) {
+		DEBUG_ERROR("%s: Firmware reported an error: %c\n", func, buffer[0]);
+		return -1;
+	}
+	return length;
+}
+
+void remote_v5_spi_read(const spi_bus_e bus, const uint8_t device, const uint16_t command,
+	const target_addr32_t address, void *const buffer, const size_t length)
+{
+	uint8_t *const data = (uint8_t *)buffer;
+	uint8_t response[REMOTE_V5_MAX_PACKET_SIZE + 1U];
+	/* The data comes back unencoded, so we can read as much as fits in a message after the response code */
+	const size_t blocksize = remote_v5_max_packet_size() - 1U;
+	/* For each transfer block size, ask the firmware to run a read cycle for that block of bytes */
+	for (size_t offset = 0U; offset < length; offset += blocksize) {
+		/* Pick the amount left to read or the block size, whichever is smaller */
+		const size_t amount = MIN(length - offset, blocksize);
+		remote_v5_spi_request(REMOTE_SPI_READ, bus, device, command, address + offset, NULL, amount);
+		const int result = remote_v5_spi_response(__func__, response);
+		if (result < 0 || (size_t)result != amount + 1U) {
+			DEBUG_ERROR("%s error around 0x%06" PRIx32 "\n", __func__, (uint32_t)(address + offset));
+			memset(data + offset, 0, length - offset);
+			return;
+		}
+		/* If the response indicates all's OK, copy out the data read */
+		memcpy(data + offset, response + 1U, amount);
+	}
+	DEBUG_PROBE("%s: bus %u device %u command %04x @%06" PRIx32 "+%zx\n", __func__, bus, device, command, address,
+		length);
+}
+
+void remote_v5_spi_write(const spi_bus_e bus, const uint8_t device, const uint16_t command,
+	const target_addr32_t address, const void *const buffer, const size_t length)
+{
+	const uint8_t *const data = (const uint8_t *)buffer;
+	uint8_t response[REMOTE_V5_MAX_PACKET_SIZE + 1U];
+	/* The data goes across unencoded, so we can write as much as fits in a message after the request header */
+	const size_t blocksize = remote_v5_max_packet_size() - REMOTE_BINARY_SPI_LENGTH;
+	/* For each transfer block size, ask the firmware to run a write cycle for that block of bytes */
+	for (size_t offset = 0U; offset < length; offset += blocksize) {
+		/* Pick the amount left to write or the block size, whichever is smaller */
+		const size_t amount = MIN(length - offset, blocksize);
+		remote_v5_spi_request(REMOTE_SPI_WRITE, bus, device, command, address + offset, data + offset, amount);
+		if (remote_v5_spi_response(__func__, response) < 0) {
+			DEBUG_ERROR("%s error around 0x%06" PRIx32 "\n", __func__, (uint32_t)(address + offset));
+			return;
+		}
+	}
+	DEBUG_PROBE("%s: bus %u device %u command %04x @%06" PRIx32 "+%zx\n", __func__, bus, device, command, address,
+		length);
+}
+
+bool remote_v5_spi_program_page(const spi_bus_e bus, const uint8_t device, const uint16_t command,
+	const target_addr32_t address, const void *const buffer, const size_t length)
+{
+	const uint8_t *const data = (const uint8_t *)buffer;
+	uint8_t response[REMOTE_V5_MAX_PACKET_SIZE + 1U];
+	/*
+	 * A page usually fits in a single request, but if the probe can't take one that big, program it a piece
+	 * at a time - SPI Flash is fine with a page being programmed in several goes
+	 */
+	const size_t blocksize = remote_v5_max_packet_size() - REMOTE_BINARY_SPI_LENGTH;
+	bool result = true;
+	for (size_t offset = 0U; result && offset < length; offset += blocksize) {
+		const size_t amount = MIN(length - offset, blocksize);
+		remote_v5_spi_request(REMOTE_SPI_PROGRAM, bus, device, command, address + offset, data + offset, amount);
+		result = remote_v5_spi_response(__func__, response) >= 0;
+	}
+	DEBUG_PROBE("%s: bus %u device %u command %04x @%06" PRIx32 "+%zx %s\n", __func__, bus, device, command, address,
+		length, result ? "OK" : "failed");
+	return result;
+}
@@ -28,6 +28,8 @@
 #include "platform.h"
 #include "remote.h"
 #include "cli.h"
+#include "bmp_remote.h"
+#include "buffer_utils.h"
 #include "utils.h"
 
 #include <assert.h>
@@ -356,7 +358,12 @@ void serial_close(void)
 bool platform_buffer_write(const void *const data, const size_t length)
 {
 	const char *const buffer = (const char *)data;
-	DEBUG_WIRE("%s\n", buffer);
+	if (length > 1U && buffer[1] == REMOTE_BINARY_PACKET)
+		DEBUG_WIRE("<binary request, %zu bytes>\n", length);
+	else
+		DEBUG_WIRE("%.*s\n", (int)length, buffer);
+	/* The probe stops any halt watch as soon as it sees a new request */
+	remote_halt_watch.armed = false;
 	DWORD written = 0;
 	for (size_t offset = 0; offset < length; offset += written) {
 		if (port_handle != INVALID_HANDLE_VALUE) {
@@ -440,8 +447,81 @@ static ssize_t bmda_read_more_data(const uint32_t end_time)
 	return 0;
 }
 
+bool platform_buffer_pending(void)
+{
+	if (read_buffer_offset != read_buffer_fullness)
+		return true;
+	if (network_socket != INVALID_SOCKET) {
+		struct timeval timeout = {0};
+		fd_set select_set;
+		FD_ZERO(&select_set);
+		FD_SET(network_socket, &select_set);
+		return select(FD_SETSIZE, &select_set, NULL, NULL, &timeout) > 0;
+	}
+	/* Read timeouts are off on the serial port, so this returns straight away if there is nothing waiting */
+	DWORD bytes_received = 0;
+	if (!ReadFile(port_handle, read_buffer, READ_BUFFER_LENGTH, &bytes_received, NULL) || !bytes_received)
+		return false;
+	read_buffer_fullness = bytes_received;
+	read_buffer_offset = 0U;
+	return true;
+}
+
+int platform_buffer_fd(void)
+{
+	/* The serial port handle is not something poll() can wait on */
+	return -1;
+}
+
+/* Pull exactly length bytes from the probe, throwing them away if data is NULL */
+static ssize_t bmda_read_exact(uint8_t *const data, const size_t length, const uint32_t end_time)
+{
+	for (size_t offset = 0U; offset < length;) {
+		while (read_buffer_offset == read_buffer_fullness) {
+			const ssize_t result = bmda_read_more_data(end_time);
+			if (result < 0)
+				return result;
+		}
+		const size_t amount = MIN(length - offset, read_buffer_fullness - read_buffer_offset);
+		if (data)
+			memcpy(data + offset, read_buffer + read_buffer_offset, amount);
+		read_buffer_offset += amount;
+		offset += amount;
+	}
+	return 0;
+}
+
+/* Collect a binary (v5) response, which gives its length up front rather than being terminated by REMOTE_EOM */
+static int bmda_read_binary_response(uint8_t *const buffer, const size_t length, const uint32_t end_time)
+{
+	uint8_t header[2U];
+	ssize_t result = bmda_read_exact(header, sizeof(header), end_time);
+	if (result < 0)
+		return result;
+	const size_t response_length = read_le2(header, 0U);
+	/* If the response won't fit, drain it so we stay in sync with the probe, and fail the read */
+	if (response_length > length) {
+		DEBUG_ERROR("Binary response too long (%zu > %zu)\n", response_length, length);
+		result = bmda_read_exact(NULL, response_length + 1U, end_time);
+		return result < 0 ? result : -5;
+	}
+	result = bmda_read_exact(buffer, response_length, end_time);
+	if (result < 0)
+		return result;
+	uint8_t trailer = 0U;
+	result = bmda_read_exact(&trailer, 1U, end_time);
+	if (result < 0)
+		return result;
+	if (trailer != REMOTE_EOM) {
+		DEBUG_ERROR("Binary response not properly terminated\n");
+		return -5;
+	}
+	DEBUG_WIRE("       <binary response, %zu bytes>\n", response_length);
+	return (int)response_length;
+}
+
 /* XXX: We should either return size_t or bool */
-int platform_buffer_read(void *const data, const size_t length)
+int platform_buffer_read_response(void *const data, const size_t length)
 {
 	char *const buffer = (char *)data;
 	const uint32_t start_time = platform_time_ms();
@@ -455,6 +535,16 @@ int platform_buffer_read(void *const data, const size_t length)
 		}
 		response = read_buffer[read_buffer_offset++];
 	}
+	/* Binary (v5) responses are marked as such straight after the start-of-response byte */
+	while (read_buffer_offset == read_buffer_fullness) {
+		const ssize_t result = bmda_read_more_data(end_time);
+		if (result < 0)
+			return result;
+	}
+	if (read_buffer[read_buffer_offset] == REMOTE_BINARY_PACKET) {
+		++read_buffer_offset;
+		return bmda_read_binary_response((uint8_t *)data, length, end_time);
+	}
 	/* Now collect the response */
 	for (size_t offset = 0; offset < length;) {
 		/* Check if we've exceeded the allowed time */
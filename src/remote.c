@@ -41,6 +41,7 @@
 #include "version.h"
 #include "exception.h"
 #include "hex_utils.h"
+#include "buffer_utils.h"
 
 #if CONFIG_BMDA == 0
 static void remote_packet_process_adiv6(const char *packet, size_t packet_len);
@@ -57,20 +58,42 @@ static void remote_send_buf(const void *const buffer, const size_t len)
 	}
 }
 
+/* Set while handling a binary (v5) request so the responses to it get sent back in kind */
+static bool remote_binary_response = false;
+
 /* Send a response with some data following */
 static void remote_respond_buf(const char response_code, const void *const buffer, const size_t len)
 {
 	gdb_if_putchar(REMOTE_RESP, false);
-	gdb_if_putchar(response_code, false);
-
-	remote_send_buf(buffer, len);
-
+	if (remote_binary_response) {
+		/* Binary responses give the length of the response code and data up front, then send the data as-is */
+		gdb_if_putchar(REMOTE_BINARY_PACKET, false);
+		gdb_if_putchar((char)((len + 1U) & 0xffU), false);
+		gdb_if_putchar((char)((len + 1U) >> 8U), false);
+		gdb_if_putchar(response_code, false);
+		const char *const data = (const char *)buffer;
+		for (size_t offset = 0; offset < len; ++offset)
+			gdb_if_putchar(data[offset], false);
+	} else {
+		gdb_if_putchar(response_code, false);
+		remote_send_buf(buffer, len);
+	}
 	gdb_if_putchar(REMOTE_EOM, true);
 }
 
 /* Send a response with a simple result code parameter */
 static void remote_respond(const char response_code, uint64_t param)
 {
+	if (remote_binary_response) {
+		/* Binary responses carry the parameter little-endian, in only as many bytes as it needs */
+		uint8_t response[8];
+		size_t length = 0;
+		for (; param; param >>= 8U)
+			response[length++] = param & 0xffU;
+		remote_respond_buf(response_code, response, length);
+		return;
+	}
+
 	/* Put out the start of response marker and response code */
 	gdb_if_putchar(REMOTE_RESP, false);
 	gdb_if_putchar(response_code, false);
@@ -128,6 +151,38 @@ static adiv5_debug_port_s remote_dp = {
 	.mem_write = adiv5_mem_write_bytes,
 };
 
+/* How often the halt watch reads the watched word while the host is quiet */
+#define REMOTE_HALT_WATCH_INTERVAL_MS 1U
+
+typedef struct remote_halt_watch {
+	bool armed;
+	uint8_t dev_index;
+	uint8_t apsel;
+	uint32_t csw;
+	target_addr64_t address;
+	uint32_t mask;
+	uint32_t value;
+} remote_halt_watch_s;
+
+/* Armed by REMOTE_HALT_WATCH, and run from remote_halt_watch_getchar() while waiting on the host */
+static remote_halt_watch_s remote_halt_watch;
+
+typedef struct remote_mem_stream {
+	bool active;
+	uint8_t dev_index;
+	uint8_t apsel;
+	align_e align;
+	uint32_t csw;
+	target_addr64_t address;
+	uint32_t remaining;
+	/* The response to give once the stream is complete, which is the first error encountered if any */
+	char response;
+	uint64_t response_code;
+} remote_mem_stream_s;
+
+/* Set up by REMOTE_MEM_STREAM_WRITE, and fed by the REMOTE_MEM_STREAM_DATA frames that follow it */
+static remote_mem_stream_s remote_mem_stream;
+
 static void remote_packet_process_swd(const char *const packet, const size_t packet_len)
 {
 	switch (packet[1]) {
@@ -330,6 +385,10 @@ static void remote_packet_process_high_level(const char *packet, const size_t pa
 		remote_respond(REMOTE_RESP_OK, REMOTE_HL_VERSION);
 		break;
 
+	case REMOTE_HL_MAX_PACKET: /* HM = request the largest binary payload the probe can handle */
+		remote_respond(REMOTE_RESP_OK, gdb_packet_buffer_size());
+		break;
+
 	case REMOTE_HL_ADD_JTAG_DEV: { /* HJ = fill firmware jtag_devs */
 		/* Check the packet is an appropriate length */
 		if (packet_len < 22U) {
@@ -353,9 +412,12 @@ static void remote_packet_process_high_level(const char *packet, const size_t pa
 	case REMOTE_HL_ACCEL: /* HA = request what accelerations are available */
 		/* Build a response value that depends on what things are built into the firmare */
 		remote_respond(REMOTE_RESP_OK,
-			REMOTE_ACCEL_ADIV5 | REMOTE_ACCEL_ADIV6
+			REMOTE_ACCEL_ADIV5 | REMOTE_ACCEL_ADIV6 | REMOTE_ACCEL_HALT_WATCH | REMOTE_ACCEL_ADIV5_BATCH
 #if defined(CONFIG_RISCV_ACCEL) && CONFIG_RISCV_ACCEL == 1
 				| REMOTE_ACCEL_RISCV
+#if defined(CONFIG_RISCV) && CONFIG_RISCV == 1
+				| REMOTE_ACCEL_RISCV_HART
+#endif
 #endif
 		);
 		break;
@@ -492,6 +554,23 @@ static void remote_packet_process_adiv5(const char *const packet, const size_t p
 		return;
 	}
 
+	/* Check if this is a halt watch packet and handle it if it is */
+	if (packet[1] == REMOTE_HALT_WATCH) {
+		if (packet_len == REMOTE_HALT_WATCH_LENGTH) {
+			/* Note down what to watch, the watch itself runs as the probe waits for the next request */
+			remote_halt_watch.dev_index = hex_string_to_num(2U, packet + 2U);
+			remote_halt_watch.apsel = hex_string_to_num(2U, packet + 4U);
+			remote_halt_watch.csw = hex_string_to_num(8U, packet + 6U);
+			remote_halt_watch.address = hex_string_to_num(16U, packet + 14U);
+			remote_halt_watch.mask = hex_string_to_num(8U, packet + 30U);
+			remote_halt_watch.value = hex_string_to_num(8U, packet + 38U);
+			remote_halt_watch.armed = true;
+			remote_respond(REMOTE_RESP_OK, 0);
+		} else
+			remote_respond(REMOTE_RESP_ERR, REMOTE_ERROR_WRONGLEN);
+		return;
+	}
+
 	/* Our shortest ADIv5 packet is 8 bytes long, check that we have at least that */
 	if (packet_len < 8U) {
 		remote_respond(REMOTE_RESP_PARERR, 0);
@@ -705,6 +784,410 @@ static void remote_packet_process_adiv6(const char *const packet, const size_t p
 	SET_IDLE_STATE(1);
 }
 
+static void remote_binary_packet_process_adiv6(uint8_t *const packet, const size_t packet_len)
+{
+	/* Check there's at least the ADIv6 header (command, dev index and AP base address) present */
+	if (packet_len < REMOTE_BINARY_ADIV6_REG_READ_LENGTH) {
+		remote_respond(REMOTE_RESP_PARERR, 0);
+		return;
+	}
+
+	/* Set up the DP and a fake AP structure to perform the access with, as for the ASCII form of these requests */
+	adiv5_debug_port_s dp = remote_dp;
+	dp.ap_read = adiv6_ap_reg_read;
+	dp.ap_write = adiv6_ap_reg_write;
+
+	remote_dp.dev_index = packet[3];
+	remote_dp.fault = 0U;
+	adiv6_access_port_s remote_ap;
+	remote_ap.ap_address = read_le8(packet, 4U);
+	remote_ap.base.dp = &dp;
+
+	SET_IDLE_STATE(0);
+	switch (packet[2]) {
+	/* AP access commands */
+	case REMOTE_AP_READ: { /* A6a = Read from APv2 register */
+		if (packet_len != REMOTE_BINARY_ADIV6_REG_READ_LENGTH) {
+			remote_respond(REMOTE_RESP_ERR, REMOTE_ERROR_WRONGLEN);
+			break;
+		}
+		const uint32_t data = adiv5_ap_read(&remote_ap.base, read_le2(packet, 12U));
+		remote_adiv5_respond(&data, 4U);
+		break;
+	}
+	case REMOTE_AP_WRITE: { /* A6A = Write to APv2 register */
+		if (packet_len != REMOTE_BINARY_ADIV6_REG_WRITE_LENGTH) {
+			remote_respond(REMOTE_RESP_ERR, REMOTE_ERROR_WRONGLEN);
+			break;
+		}
+		adiv5_ap_write(&remote_ap.base, read_le2(packet, 12U), read_le4(packet, 14U));
+		remote_adiv5_respond(NULL, 0U);
+		break;
+	}
+	/* Memory access commands */
+	case REMOTE_MEM_READ: { /* A6m = Read from memory */
+		if (packet_len != REMOTE_BINARY_ADIV6_MEM_READ_LENGTH) {
+			remote_respond(REMOTE_RESP_ERR, REMOTE_ERROR_WRONGLEN);
+			break;
+		}
+		remote_ap.base.csw = read_le4(packet, 12U);
+		const target_addr64_t address = read_le8(packet, 16U);
+		/* The data goes back unencoded, so the whole packet buffer is available to read into */
+		const uint32_t length = read_le4(packet, 24U);
+		if (length > GDB_PACKET_BUFFER_SIZE) {
+			remote_respond(REMOTE_RESP_PARERR, 0);
+			break;
+		}
+		void *data = gdb_packet_buffer();
+		adiv5_mem_read(&remote_ap.base, data, address, length);
+		remote_adiv5_respond(data, length);
+		break;
+	}
+	case REMOTE_MEM_WRITE: { /* A6M = Write to memory */
+		if (packet_len < REMOTE_BINARY_ADIV6_MEM_WRITE_LENGTH) {
+			remote_respond(REMOTE_RESP_PARERR, 0);
+			break;
+		}
+		remote_ap.base.csw = read_le4(packet, 12U);
+		const align_e align = packet[16U];
+		const target_addr64_t address = read_le8(packet, 17U);
+		const uint32_t length = read_le4(packet, 25U);
+		/* Validate that the data to write is all present, and that the alignment is suitable */
+		if (packet_len - REMOTE_BINARY_ADIV6_MEM_WRITE_LENGTH != length || (length & ((1U << align) - 1U))) {
+			remote_respond(REMOTE_RESP_PARERR, 0);
+			break;
+		}
+		/* Move the data down to the start of the (aligned) packet buffer and perform the write */
+		void *data = gdb_packet_buffer();
+		memmove(data, packet + REMOTE_BINARY_ADIV6_MEM_WRITE_LENGTH, length);
+		adiv5_mem_write_aligned(&remote_ap.base, address, data, length, align);
+		remote_adiv5_respond(NULL, 0);
+		break;
+	}
+
+	default:
+		remote_respond(REMOTE_RESP_ERR, REMOTE_ERROR_UNRECOGNISED);
+		break;
+	}
+	SET_IDLE_STATE(1);
+}
+
+/* Convert a remote register address into the format used by the ADIv5 access routines */
+static uint16_t remote_adiv5_reg(const uint16_t addr)
+{
+	return (addr & REMOTE_ADIV5_APnDP ? ADIV5_APnDP : 0U) | (addr & 0x00ffU);
+}
+
+/* Determine how long a batch operation is, including its op byte, or 0 if the operation is not valid */
+static size_t remote_adiv5_batch_op_length(const uint8_t op)
+{
+	switch (op) {
+	case REMOTE_ADIV5_BATCH_DP_READ:
+		return 3U;
+	case REMOTE_ADIV5_BATCH_AP_READ:
+		return 4U;
+	case REMOTE_ADIV5_BATCH_DP_WRITE:
+		return 7U;
+	case REMOTE_ADIV5_BATCH_AP_WRITE:
+		return 8U;
+	case REMOTE_ADIV5_BATCH_AP_POLL:
+		return 14U;
+	default:
+		return 0U;
+	}
+}
+
+static void remote_binary_packet_process_adiv5_batch(const uint8_t *const packet, const size_t packet_len)
+{
+	if (packet_len < REMOTE_BINARY_ADIV5_BATCH_LENGTH || packet[3] > REMOTE_BINARY_ADIV5_BATCH_MAX_OPS) {
+		remote_respond(REMOTE_RESP_PARERR, 0);
+		return;
+	}
+
+	/* Set up the DP and a fake AP structure to perform the accesses with, the batch runs each as it's added */
+	remote_dp.dev_index = packet[2];
+	remote_dp.fault = 0U;
+	adiv5_access_port_s remote_ap;
+	remote_ap.dp = &remote_dp;
+	adiv5_batch_s batch = {.dp = &remote_dp};
+	uint32_t results[REMOTE_BINARY_ADIV5_BATCH_MAX_OPS];
+	size_t result_count = 0U;
+	size_t offset = REMOTE_BINARY_ADIV5_BATCH_LENGTH;
+
+	SET_IDLE_STATE(0);
+	for (size_t op = 0U; op < packet[3] && !remote_dp.fault; ++op) {
+		/* Figure out how long this operation is, and check that all of it is present */
+		const size_t op_length = offset < packet_len ? remote_adiv5_batch_op_length(packet[offset]) : 0U;
+		if (!op_length || packet_len - offset < op_length) {
+			remote_respond(REMOTE_RESP_PARERR, 0);
+			SET_IDLE_STATE(1);
+			return;
+		}
+
+		const uint8_t *const request = packet + offset;
+		switch (request[0]) {
+		case REMOTE_ADIV5_BATCH_DP_READ:
+			adiv5_batch_dp_read(&batch, remote_adiv5_reg(read_le2(request, 1U)), &results[result_count++]);
+			break;
+		case REMOTE_ADIV5_BATCH_DP_WRITE:
+			adiv5_batch_dp_write(&batch, remote_adiv5_reg(read_le2(request, 1U)), read_le4(request, 3U));
+			break;
+		case REMOTE_ADIV5_BATCH_AP_READ:
+			remote_ap.apsel = request[1];
+			adiv5_batch_ap_read(&batch, &remote_ap, remote_adiv5_reg(read_le2(request, 2U)), &results[result_count++]);
+			break;
+		case REMOTE_ADIV5_BATCH_AP_WRITE:
+			remote_ap.apsel = request[1];
+			adiv5_batch_ap_write(&batch, &remote_ap, remote_adiv5_reg(read_le2(request, 2U)), read_le4(request, 4U));
+			break;
+		case REMOTE_ADIV5_BATCH_AP_POLL:
+			remote_ap.apsel = request[1];
+			adiv5_batch_ap_poll(&batch, &remote_ap, remote_adiv5_reg(read_le2(request, 2U)), read_le4(request, 4U),
+				read_le4(request, 8U), read_le2(request, 12U), &results[result_count++]);
+			break;
+		}
+		offset += op_length;
+	}
+	adiv5_batch_run(&batch);
+
+	/* Turn the results into their little-endian wire form in place and send them back */
+	for (size_t idx = 0U; idx < result_count; ++idx)
+		write_le4((uint8_t *)results, idx * 4U, results[idx]);
+	remote_adiv5_respond(results, result_count * 4U);
+	SET_IDLE_STATE(1);
+}
+
+static void remote_mem_stream_read(adiv5_access_port_s *const ap, const uint8_t *const packet, const size_t packet_len)
+{
+	if (packet_len != REMOTE_BINARY_ADIV5_STREAM_READ_LENGTH) {
+		remote_respond(REMOTE_RESP_ERR, REMOTE_ERROR_WRONGLEN);
+		return;
+	}
+	ap->csw = read_le4(packet, 4U);
+	const target_addr64_t address = read_le8(packet, 8U);
+	const uint32_t length = read_le4(packet, 16U);
+	/* Send back at most as much data per response as both we and the host can handle */
+	const size_t blocksize = MIN(read_le2(packet, 20U), gdb_packet_buffer_size());
+	if (!blocksize) {
+		remote_respond(REMOTE_RESP_PARERR, 0);
+		return;
+	}
+	/* A zero length read still gets its (empty) response */
+	if (!length) {
+		remote_adiv5_respond(NULL, 0U);
+		return;
+	}
+
+	/* Read the data a block at a time, sending each back as soon as it's read, and stopping at the first fault */
+	void *data = gdb_packet_buffer();
+	for (uint32_t offset = 0U; offset < length && !remote_dp.fault; offset += blocksize) {
+		const size_t amount = MIN(length - offset, blocksize);
+		adiv5_mem_read(ap, data, address + offset, amount);
+		remote_adiv5_respond(data, amount);
+	}
+}
+
+static void remote_mem_stream_write(
+	const adiv5_access_port_s *const ap, const uint8_t *const packet, const size_t packet_len)
+{
+	if (packet_len != REMOTE_BINARY_ADIV5_MEM_WRITE_LENGTH) {
+		remote_respond(REMOTE_RESP_ERR, REMOTE_ERROR_WRONGLEN);
+		return;
+	}
+	const align_e align = packet[8U];
+	const uint32_t length = read_le4(packet, 17U);
+	/* Validate that the alignment is suitable for the amount of data to be written */
+	if (length & ((1U << align) - 1U)) {
+		remote_respond(REMOTE_RESP_PARERR, 0);
+		return;
+	}
+
+	/* Note down where the data is to go, it gets written as the stream data frames arrive */
+	remote_mem_stream = (remote_mem_stream_s){
+		.active = length != 0U,
+		.dev_index = remote_dp.dev_index,
+		.apsel = ap->apsel,
+		.align = align,
+		.csw = read_le4(packet, 4U),
+		.address = read_le8(packet, 9U),
+		.remaining = length,
+		.response = REMOTE_RESP_OK,
+		.response_code = 0U,
+	};
+	/* A zero length write has nothing to follow, so is already done */
+	if (!length)
+		remote_respond(REMOTE_RESP_OK, 0);
+}
+
+static void remote_mem_stream_data(uint8_t *const packet, const size_t packet_len)
+{
+	/* Data for a streaming write that was abandoned, or never started, is dropped as there's no one to tell */
+	if (!remote_mem_stream.active)
+		return;
+
+	const size_t length = packet_len - REMOTE_BINARY_ADIV5_STREAM_DATA_LENGTH;
+	/* If the host sends more data than it said it would, or misaligns it, give up on the write now */
+	if (length > remote_mem_stream.remaining || (length & ((1U << remote_mem_stream.align) - 1U))) {
+		remote_mem_stream.active = false;
+		remote_respond(REMOTE_RESP_PARERR, 0);
+		return;
+	}
+
+	/* Only carry on writing while the stream has not yet run into an error */
+	if (remote_mem_stream.response == REMOTE_RESP_OK) {
+		/* Set up the DP and a fake AP structure to perform the access with */
+		remote_dp.dev_index = remote_mem_stream.dev_index;
+		remote_dp.fault = 0U;
+		adiv5_access_port_s remote_ap;
+		remote_ap.apsel = remote_mem_stream.apsel;
+		remote_ap.csw = remote_mem_stream.csw;
+		remote_ap.dp = &remote_dp;
+		/* Move the data down to the start of the (aligned) packet buffer and perform the write */
+		void *data = gdb_packet_buffer();
+		memmove(data, packet + REMOTE_BINARY_ADIV5_STREAM_DATA_LENGTH, length);
+		SET_IDLE_STATE(0);
+		TRY (EXCEPTION_ALL) {
+			adiv5_mem_write_aligned(&remote_ap, remote_mem_stream.address, data, length, remote_mem_stream.align);
+		}
+		CATCH () {
+		/* Note down the exception to tell the host about once the stream is done */
+		default:
+			remote_mem_stream.response = REMOTE_RESP_ERR;
+			remote_mem_stream.response_code = REMOTE_ERROR_EXCEPTION | ((uint64_t)exception_frame.type << 8U);
+		}
+		SET_IDLE_STATE(1);
+		if (remote_dp.fault && remote_mem_stream.response == REMOTE_RESP_OK) {
+			remote_mem_stream.response = REMOTE_RESP_ERR;
+			remote_mem_stream.response_code = REMOTE_ERROR_FAULT | ((uint16_t)remote_dp.fault << 8U);
+		}
+	}
+
+	/* Once all the data has arrived, tell the host how the write went */
+	remote_mem_stream.address += length;
+	remote_mem_stream.remaining -= length;
+	if (!remote_mem_stream.remaining) {
+		remote_mem_stream.active = false;
+		remote_respond(remote_mem_stream.response, remote_mem_stream.response_code);
+	}
+}
+
+static void remote_binary_packet_process_adiv5(uint8_t *const packet, const size_t packet_len)
+{
+	/* Check there's at least an ADI command byte, and dispatch ADIv6 acceleration and batch requests */
+	if (packet_len >= 2U && packet[1] == REMOTE_ADIV6_PACKET) {
+		remote_binary_packet_process_adiv6(packet, packet_len);
+		return;
+	}
+	if (packet_len >= 2U && packet[1] == REMOTE_ADIV5_BATCH) {
+		remote_binary_packet_process_adiv5_batch(packet, packet_len);
+		return;
+	}
+	if (packet_len >= 2U && packet[1] == REMOTE_MEM_STREAM_DATA) {
+		remote_mem_stream_data(packet, packet_len);
+		return;
+	}
+	/* Our shortest binary ADIv5 request is a register read, check that we have at least that */
+	if (packet_len < REMOTE_BINARY_ADIV5_REG_READ_LENGTH) {
+		remote_respond(REMOTE_RESP_PARERR, 0);
+		return;
+	}
+
+	/* Set up the DP and a fake AP structure to perform the access with */
+	remote_dp.dev_index = packet[2];
+	remote_dp.fault = 0U;
+	adiv5_access_port_s remote_ap;
+	remote_ap.apsel = packet[3];
+	remote_ap.dp = &remote_dp;
+
+	SET_IDLE_STATE(0);
+	switch (packet[1]) {
+	/* Register access commands */
+	case REMOTE_DP_READ:          /* Ad = Read from DP register */
+	case REMOTE_AP_READ: {        /* Aa = Read from AP register */
+		if (packet_len != REMOTE_BINARY_ADIV5_REG_READ_LENGTH) {
+			remote_respond(REMOTE_RESP_ERR, REMOTE_ERROR_WRONGLEN);
+			break;
+		}
+		const uint16_t addr = read_le2(packet, 4U);
+		const uint16_t reg = remote_adiv5_reg(addr);
+		const uint32_t data =
+			packet[1] == REMOTE_DP_READ ? adiv5_dp_read(&remote_dp, reg) : adiv5_ap_read(&remote_ap, reg);
+		remote_adiv5_respond(&data, 4U);
+		break;
+	}
+	case REMOTE_ADIV5_RAW_ACCESS: /* AR = Perform a raw ADIv5 access */
+	case REMOTE_AP_WRITE: {       /* AA = Write to AP register */
+		if (packet_len != REMOTE_BINARY_ADIV5_REG_WRITE_LENGTH) {
+			remote_respond(REMOTE_RESP_ERR, REMOTE_ERROR_WRONGLEN);
+			break;
+		}
+		const uint16_t addr = read_le2(packet, 4U);
+		const uint16_t reg = remote_adiv5_reg(addr);
+		const uint32_t value = read_le4(packet, 6U);
+		if (packet[1] == REMOTE_AP_WRITE) {
+			adiv5_ap_write(&remote_ap, reg, value);
+			remote_adiv5_respond(NULL, 0U);
+		} else {
+			/* Try to perform the access using the AP selection value as R/!W */
+			const uint32_t data = adiv5_dp_low_access(&remote_dp, remote_ap.apsel, reg, value);
+			remote_adiv5_respond(&data, 4U);
+		}
+		break;
+	}
+	/* Memory access commands */
+	case REMOTE_MEM_STREAM_READ: /* As = Read from memory, streaming the data back over several responses */
+		remote_mem_stream_read(&remote_ap, packet, packet_len);
+		break;
+	case REMOTE_MEM_STREAM_WRITE: /* AS = Write to memory, with the data to follow in stream data frames */
+		remote_mem_stream_write(&remote_ap, packet, packet_len);
+		break;
+	case REMOTE_MEM_READ: { /* Am = Read from memory */
+		if (packet_len != REMOTE_BINARY_ADIV5_MEM_READ_LENGTH) {
+			remote_respond(REMOTE_RESP_ERR, REMOTE_ERROR_WRONGLEN);
+			break;
+		}
+		remote_ap.csw = read_le4(packet, 4U);
+		const target_addr64_t address = read_le8(packet, 8U);
+		/* The data goes back unencoded, so the whole packet buffer is available to read into */
+		const uint32_t length = read_le4(packet, 16U);
+		if (length > GDB_PACKET_BUFFER_SIZE) {
+			remote_respond(REMOTE_RESP_PARERR, 0);
+			break;
+		}
+		void *data = gdb_packet_buffer();
+		adiv5_mem_read(&remote_ap, data, address, length);
+		remote_adiv5_respond(data, length);
+		break;
+	}
+	case REMOTE_MEM_WRITE: { /* AM = Write to memory */
+		if (packet_len < REMOTE_BINARY_ADIV5_MEM_WRITE_LENGTH) {
+			remote_respond(REMOTE_RESP_PARERR, 0);
+			break;
+		}
+		remote_ap.csw = read_le4(packet, 4U);
+		const align_e align = packet[8U];
+		const target_addr64_t address = read_le8(packet, 9U);
+		const uint32_t length = read_le4(packet, 17U);
+		/* Validate that the data to write is all present, and that the alignment is suitable */
+		if (packet_len - REMOTE_BINARY_ADIV5_MEM_WRITE_LENGTH != length || (length & ((1U << align) - 1U))) {
+			remote_respond(REMOTE_RESP_PARERR, 0);
+			break;
+		}
+		/* Move the data down to the start of the (aligned) packet buffer and perform the write */
+		void *data = gdb_packet_buffer();
+		memmove(data, packet + REMOTE_BINARY_ADIV5_MEM_WRITE_LENGTH, length);
+		adiv5_mem_write_aligned(&remote_ap, address, data, length, align);
+		remote_adiv5_respond(NULL, 0);
+		break;
+	}
+
+	default:
+		remote_respond(REMOTE_RESP_ERR, REMOTE_ERROR_UNRECOGNISED);
+		break;
+	}
+	SET_IDLE_STATE(1);
+}
+
 #if defined(CONFIG_RISCV_ACCEL) && CONFIG_RISCV_ACCEL == 1
 /*
  * This faked RISC-V DMI structure holds the currently used low-level implementation functions and basic DMI
@@ -718,6 +1201,45 @@ static riscv_dmi_s remote_dmi = {
 	.write = NULL,
 };
 
+#if defined(CONFIG_RISCV) && CONFIG_RISCV == 1
+/*
+ * Set up a fake Debug Module and Hart structure to perform a Hart-level request with, from the DM base address,
+ * Hart flags and progbuf size that follow the DMI parameters in the request
+ */
+static void remote_riscv_hart_setup(riscv_dm_s *const dbg_module, riscv_hart_s *const hart, const char *const packet)
+{
+	*dbg_module = (riscv_dm_s){
+		.dmi_bus = &remote_dmi,
+		.base = hex_string_to_num(8, packet + 8U),
+	};
+	*hart = (riscv_hart_s){
+		.dbg_module = dbg_module,
+		/* The Hart-level requests are only for 32-bit Harts */
+		.access_width = 32U,
+		.address_width = 32U,
+		.flags = hex_string_to_num(2, packet + 16U),
+		.progbuf_size = hex_string_to_num(2, packet + 18U),
+	};
+}
+
+/*
+ * Respond to a Hart-level request, with data holding the Hart status and flags bytes followed by length bytes of
+ * data. The flags go back so the host picks up anything learnt about the Hart here, such as it lacking CSR access
+ */
+static void remote_riscv_hart_respond(const riscv_hart_s *const hart, uint8_t *const data, const size_t length)
+{
+	if (remote_dmi.fault)
+		/* If the request didn't work, and caused a fault, tell the host */
+		remote_respond(REMOTE_RESP_ERR, REMOTE_ERROR_FAULT | ((uint16_t)remote_dmi.fault << 8U));
+	else {
+		/* Otherwise reply back with the status and flags of the Hart after the request, and any data */
+		data[0U] = hart->status;
+		data[1U] = hart->flags;
+		remote_respond_buf(REMOTE_RESP_OK, data, length + 2U);
+	}
+}
+#endif
+
 void remote_packet_process_riscv(const char *const packet, const size_t packet_len)
 {
 	/* Our shortest RISC-V Debug protocol packet is 2 bytes long, check that we have at least that */
@@ -799,6 +1321,82 @@ void remote_packet_process_riscv(const char *const packet, const size_t packet_l
 			remote_respond(REMOTE_RESP_OK, 0);
 		break;
 	}
+#if defined(CONFIG_RISCV) && CONFIG_RISCV == 1
+	case REMOTE_RISCV_MEM_READ: {
+		/* Memory read packets are 36 bytes long, verify we have enough bytes */
+		if (packet_len != 36U) {
+			remote_respond(REMOTE_RESP_PARERR, 0);
+			break;
+		}
+		/* Grab the start address for the read */
+		const uint32_t address = hex_string_to_num(8, packet + 20U);
+		/* And how many bytes to read, validating it for buffer overflows */
+		const uint32_t length = hex_string_to_num(8, packet + 28U);
+		/* NB: Hex encoding on the response data halfs the available buffer capacity */
+		if (length > (GDB_PACKET_BUFFER_SIZE - REMOTE_RISCV_MEM_READ_LENGTH) >> 1U) {
+			remote_respond(REMOTE_RESP_PARERR, 0);
+			break;
+		}
+		riscv_dm_s dbg_module;
+		riscv_hart_s hart;
+		remote_riscv_hart_setup(&dbg_module, &hart, packet);
+		/* Get the packet buffer to reuse for the data read, leaving room for the Hart status and flags ahead of it */
+		uint8_t *const data = (uint8_t *)gdb_packet_buffer();
+		/* Perform the read and send back the results */
+		riscv32_hart_mem_read(&hart, data + 2U, address, length);
+		remote_riscv_hart_respond(&hart, data, length);
+		break;
+	}
+	case REMOTE_RISCV_MEM_WRITE: {
+		/* Grab the start address for the write */
+		const uint32_t address = hex_string_to_num(8, packet + 20U);
+		/* And how many bytes to write, validating it for buffer overflows and that all the data is present */
+		const uint32_t length = hex_string_to_num(8, packet + 28U);
+		if (length > (GDB_PACKET_BUFFER_SIZE - REMOTE_RISCV_MEM_WRITE_LENGTH) >> 1U ||
+			packet_len != 36U + (length * 2U)) {
+			remote_respond(REMOTE_RESP_PARERR, 0);
+			break;
+		}
+		riscv_dm_s dbg_module;
+		riscv_hart_s hart;
+		remote_riscv_hart_setup(&dbg_module, &hart, packet);
+		/* Get the packet buffer to reuse for the data to write, leaving room for the Hart status and flags */
+		uint8_t *const data = (uint8_t *)gdb_packet_buffer();
+		/* And decode the data from the packet into it */
+		unhexify(data + 2U, packet + 36U, length);
+		/* Perform the write and report success/failures */
+		riscv32_hart_mem_write(&hart, address, data + 2U, length);
+		remote_riscv_hart_respond(&hart, data, 0U);
+		break;
+	}
+	case REMOTE_RISCV_REGS_READ: {
+		/* Register read packets are 22 bytes long, verify we have enough bytes */
+		if (packet_len != 22U) {
+			remote_respond(REMOTE_RESP_PARERR, 0);
+			break;
+		}
+		/* Grab how many GPRs the Hart has, which must be either 16 (RV32E) or 32 */
+		const size_t gprs_count = hex_string_to_num(2, packet + 20U);
+		if (gprs_count != 16U && gprs_count != 32U) {
+			remote_respond(REMOTE_RESP_PARERR, 0);
+			break;
+		}
+		riscv_dm_s dbg_module;
+		riscv_hart_s hart;
+		remote_riscv_hart_setup(&dbg_module, &hart, packet);
+		/* Read out the GPRs and the PC, then send them back after the Hart status and flags */
+		uint32_t regs[33U];
+		if (!riscv32_hart_regs_read(&hart, regs, gprs_count)) {
+			/* Tell the host the read failed, even if it wasn't a DMI fault that did it */
+			remote_respond(REMOTE_RESP_ERR, REMOTE_ERROR_FAULT | ((uint16_t)remote_dmi.fault << 8U));
+			break;
+		}
+		uint8_t response[2U + sizeof(regs)];
+		memcpy(response + 2U, regs, (gprs_count + 1U) * 4U);
+		remote_riscv_hart_respond(&hart, response, (gprs_count + 1U) * 4U);
+		break;
+	}
+#endif
 	default:
 		remote_respond(REMOTE_RESP_ERR, REMOTE_ERROR_UNRECOGNISED);
 		break;
@@ -857,7 +1455,7 @@ void remote_packet_process_spi(const char *const packet, const size_t packet_len
 		const target_addr_t address = hex_string_to_num(6, packet + 10);
 		const size_t length = hex_string_to_num(4, packet + 16);
 		/* Validate the data length isn't overly long */
-		if (length > 256U) {
+		if (length > REMOTE_SPI_MAX_DATA_LENGTH) {
 			remote_respond(REMOTE_RESP_PARERR, 0);
 			break;
 		}
@@ -869,7 +1467,7 @@ void remote_packet_process_spi(const char *const packet, const size_t packet_len
 		break;
 	}
 	/* Perform a complete write cycle with a SPI Flash of up to 256 bytes */
-	case REMOTE_SPI_WRTIE: {
+	case REMOTE_SPI_WRITE: {
 		/*
 		 * Decode the device to talk to, what command to send, and the addressing
 		 * and length information for that command
@@ -878,8 +1476,8 @@ void remote_packet_process_spi(const char *const packet, const size_t packet_len
 		const uint16_t command = hex_string_to_num(4, packet + 6);
 		const target_addr_t address = hex_string_to_num(6, packet + 10);
 		const size_t length = hex_string_to_num(4, packet + 16);
-		/* Validate the data length isn't overly long */
-		if (length > 256U) {
+		/* Validate the data length isn't overly long, and that all the data to write is present */
+		if (length > REMOTE_SPI_MAX_DATA_LENGTH || packet_len != 20U + (length * 2U)) {
 			remote_respond(REMOTE_RESP_PARERR, 0);
 			break;
 		}
@@ -920,8 +1518,108 @@ void remote_packet_process_spi(const char *const packet, const size_t packet_len
 	}
 }
 
+static void remote_binary_packet_process_spi(uint8_t *const packet, const size_t packet_len)
+{
+	/* Check there's at least the common part of a SPI request */
+	if (packet_len < REMOTE_BINARY_SPI_LENGTH) {
+		remote_respond(REMOTE_RESP_PARERR, 0);
+		return;
+	}
+
+	/* Decode the bus and device to talk to, what command to send, and the addressing and length information */
+	const spi_bus_e spi_bus = packet[2];
+	const uint8_t spi_device = packet[3];
+	const uint16_t command = read_le2(packet, 4U);
+	const target_addr32_t address = read_le4(packet, 6U);
+	const size_t length = read_le2(packet, 10U);
+
+	switch (packet[1]) {
+	/* Perform a complete read cycle with a SPI Flash */
+	case REMOTE_SPI_READ: {
+		/* The data goes back unencoded, so the whole packet buffer is available to read into */
+		if (packet_len != REMOTE_BINARY_SPI_LENGTH || length > GDB_PACKET_BUFFER_SIZE) {
+			remote_respond(REMOTE_RESP_PARERR, 0);
+			break;
+		}
+		void *data = gdb_packet_buffer();
+		bmp_spi_read(spi_bus, spi_device, command, address, data, length);
+		remote_respond_buf(REMOTE_RESP_OK, data, length);
+		break;
+	}
+	/* Perform a complete write cycle with a SPI Flash, and for programming, wait for the Flash to finish */
+	case REMOTE_SPI_WRITE:
+	case REMOTE_SPI_PROGRAM: {
+		/* Validate that the data to write is all present */
+		if (packet_len - REMOTE_BINARY_SPI_LENGTH != length) {
+			remote_respond(REMOTE_RESP_PARERR, 0);
+			break;
+		}
+		/* Move the data down to the start of the (aligned) packet buffer and perform the write */
+		void *data = gdb_packet_buffer();
+		memmove(data, packet + REMOTE_BINARY_SPI_LENGTH, length);
+		if (packet[1] == REMOTE_SPI_PROGRAM)
+			remote_spi_respond(bmp_spi_program_page(spi_bus, spi_device, command, address, data, length));
+		else {
+			bmp_spi_write(spi_bus, spi_device, command, address, data, length);
+			remote_respond(REMOTE_RESP_OK, 0);
+		}
+		break;
+	}
+	default:
+		remote_respond(REMOTE_RESP_ERR, REMOTE_ERROR_UNRECOGNISED);
+		break;
+	}
+}
+
+/* Read the watched word once, telling the host and disarming if the watch fired */
+static void remote_halt_watch_poll(void)
+{
+	remote_dp.dev_index = remote_halt_watch.dev_index;
+	remote_dp.fault = 0U;
+	adiv5_access_port_s remote_ap = {
+		.dp = &remote_dp,
+		.apsel = remote_halt_watch.apsel,
+		.csw = remote_halt_watch.csw,
+	};
+
+	volatile uint32_t word = 0U;
+	volatile bool fired = true;
+	TRY (EXCEPTION_ALL) {
+		uint32_t data = 0U;
+		adiv5_mem_read(&remote_ap, &data, remote_halt_watch.address, sizeof(data));
+		word = data;
+		/* A fault also fires the watch, the host finds out what happened when it next talks to the target */
+		fired = remote_dp.fault || (data & remote_halt_watch.mask) == remote_halt_watch.value;
+	}
+	CATCH () {
+	default:
+		break;
+	}
+
+	if (!fired)
+		return;
+	remote_halt_watch.armed = false;
+	remote_respond(REMOTE_RESP_HALT, word);
+}
+
+char remote_halt_watch_getchar(void)
+{
+	while (remote_halt_watch.armed) {
+		const char rx_char = gdb_if_getchar_to(REMOTE_HALT_WATCH_INTERVAL_MS);
+		/* Anything from the host ends the watch, as whatever it is about to ask for may use the same AP */
+		if (rx_char != -1) {
+			remote_halt_watch.armed = false;
+			return rx_char;
+		}
+		remote_halt_watch_poll();
+	}
+	return gdb_if_getchar();
+}
+
 void remote_packet_process(char *const packet, const size_t packet_length)
 {
+	/* Any ASCII request abandons a streaming write that's in progress */
+	remote_mem_stream.active = false;
 	/* Check there's at least a request byte */
 	if (packet_length < 1U) {
 		remote_respond(REMOTE_RESP_ERR, REMOTE_ERROR_WRONGLEN);
@@ -972,4 +1670,39 @@ void remote_packet_process(char *const packet, const size_t packet_length)
 		break;
 	}
 }
+
+void remote_binary_packet_process(uint8_t *const packet, const size_t packet_length)
+{
+	/* Everything we say back to a binary request goes back as a binary response */
+	remote_binary_response = true;
+	/* Anything other than more data for a streaming write abandons that write */
+	if (packet_length < 2U || packet[0] != REMOTE_ADIV5_PACKET || packet[1] != REMOTE_MEM_STREAM_DATA)
+		remote_mem_stream.active = false;
+	/* Check there's at least a request byte */
+	if (packet_length < 1U)
+		remote_respond(REMOTE_RESP_ERR, REMOTE_ERROR_WRONGLEN);
+	else {
+		/* Setup an exception frame to try the operation in */
+		TRY (EXCEPTION_ALL) {
+			/* Only the ADIv5 (and ADIv6) acceleration and SPI requests have binary forms */
+			switch (packet[0]) {
+			case REMOTE_ADIV5_PACKET:
+				remote_binary_packet_process_adiv5(packet, packet_length);
+				break;
+			case REMOTE_SPI_PACKET:
+				remote_binary_packet_process_spi(packet, packet_length);
+				break;
+			default:
+				remote_respond(REMOTE_RESP_ERR, REMOTE_ERROR_UNRECOGNISED);
+				break;
+			}
+		}
+		CATCH () {
+		/* Handle any exception we've caught by translating it into a remote protocol response */
+		default:
+			remote_respond(REMOTE_RESP_ERR, REMOTE_ERROR_EXCEPTION | ((uint64_t)exception_frame.type << 8U));
+		}
+	}
+	remote_binary_response = false;
+}
 #endif
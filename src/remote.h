@@ -26,7 +26,7 @@
 #include <stddef.h>
 #include "general.h"
 
-#define REMOTE_HL_VERSION 4
+#define REMOTE_HL_VERSION 5
 
 /*
  * Commands to remote end, and responses
@@ -48,6 +48,20 @@
  *       resp: F<PARAM> - hex value returned, bad parity.
  *             X<err>   - error occurred
  *
+ * From v5 on, the ADIv5 and ADIv6 acceleration and SPI Flash data commands may also be sent in binary
+ * frames, which carry their fields as little-endian binary and their data unencoded:
+ *
+ * !B<LEN><PAYLOAD>#
+ *   <LEN>     - 16-bit little-endian length of <PAYLOAD>
+ *   <PAYLOAD> - the packet and command bytes as for the ASCII form, then the parameters
+ *
+ * The probe answers binary frames in kind with &B<LEN><RESP><DATA>#, where <LEN> covers the
+ * response code and data. Result codes are sent as a little-endian value just long enough to
+ * hold them (so none at all for 0), and data is sent as-is.
+ *
+ * How large <PAYLOAD> may be is reported by the probe in answer to HM. Memory transfers larger than
+ * that are streamed over several frames, see REMOTE_MEM_STREAM_READ and REMOTE_MEM_STREAM_WRITE.
+ *
  * The whole protocol is defined in this header file. Parameters have
  * to be marshalled in remote.c, swdptap.c and jtagtap.c, so be
  * careful to ensure the parameter handling matches the protocol
@@ -65,11 +79,18 @@
 #define REMOTE_EOM  '#'
 #define REMOTE_RESP '&'
 
+/* Marks a binary (v5) frame when following REMOTE_SOM or REMOTE_RESP */
+#define REMOTE_BINARY_PACKET 'B'
+/* The SOM, marker and length bytes ahead of a binary frame's payload */
+#define REMOTE_BINARY_HEADER_LENGTH 4U
+
 /* Protocol response options */
 #define REMOTE_RESP_OK     'K'
 #define REMOTE_RESP_PARERR 'P'
 #define REMOTE_RESP_ERR    'E'
 #define REMOTE_RESP_NOTSUP 'N'
+/* Unsolicited response sent when a halt watch (see REMOTE_HALT_WATCH) fires */
+#define REMOTE_RESP_HALT 'H'
 
 /* Protocol data elements */
 #define REMOTE_UINT8  '%', '0', '2', 'x'
@@ -225,6 +246,7 @@
 #define REMOTE_HL_ADD_JTAG_DEV 'J'
 #define REMOTE_HL_ARCHS        'a'
 #define REMOTE_HL_FAMILIES     'F'
+#define REMOTE_HL_MAX_PACKET   'M'
 
 #define REMOTE_HL_CHECK_STR                                          \
 	(char[])                                                         \
@@ -236,6 +258,12 @@
 	{                                                                \
 		REMOTE_SOM, REMOTE_HL_PACKET, REMOTE_HL_ACCEL, REMOTE_EOM, 0 \
 	}
+/* HM = request the largest binary (v5) payload the probe can take, and so also send back, in one frame */
+#define REMOTE_HL_MAX_PACKET_STR                                          \
+	(char[])                                                              \
+	{                                                                     \
+		REMOTE_SOM, REMOTE_HL_PACKET, REMOTE_HL_MAX_PACKET, REMOTE_EOM, 0 \
+	}
 #define REMOTE_JTAG_ADD_DEV_STR                                                               \
 	(char[])                                                                                  \
 	{                                                                                         \
@@ -260,10 +288,13 @@
 	}
 
 /* Remote protocol enabled acceleration bit values */
-#define REMOTE_ACCEL_ADIV5     (1U << 0U)
-#define REMOTE_ACCEL_CORTEX_AR (1U << 1U)
-#define REMOTE_ACCEL_RISCV     (1U << 2U)
-#define REMOTE_ACCEL_ADIV6     (1U << 3U)
+#define REMOTE_ACCEL_ADIV5       (1U << 0U)
+#define REMOTE_ACCEL_CORTEX_AR   (1U << 1U)
+#define REMOTE_ACCEL_RISCV       (1U << 2U)
+#define REMOTE_ACCEL_ADIV6       (1U << 3U)
+#define REMOTE_ACCEL_HALT_WATCH  (1U << 4U)
+#define REMOTE_ACCEL_ADIV5_BATCH (1U << 5U)
+#define REMOTE_ACCEL_RISCV_HART  (1U << 6U)
 
 /* Remote protocol enabled architecture support bit values */
 #define REMOTE_ARCH_CORTEXM  (1U << 0U)
@@ -313,6 +344,11 @@
 #define REMOTE_MEM_WRITE        'M'
 #define REMOTE_DP_VERSION       'V'
 #define REMOTE_DP_TARGETSEL     'T'
+#define REMOTE_HALT_WATCH       'H'
+#define REMOTE_ADIV5_BATCH      'B'
+#define REMOTE_MEM_STREAM_READ  's'
+#define REMOTE_MEM_STREAM_WRITE 'S'
+#define REMOTE_MEM_STREAM_DATA  'D'
 
 #define REMOTE_ADIV5_DEV_INDEX  REMOTE_UINT8
 #define REMOTE_ADIV5_AP_SEL     REMOTE_UINT8
@@ -323,6 +359,7 @@
 #define REMOTE_ADIV5_ALIGNMENT  REMOTE_UINT8
 #define REMOTE_ADIV5_COUNT      REMOTE_UINT32
 #define REMOTE_ADIV5_DP_VERSION REMOTE_UINT8
+#define REMOTE_ADIV5_MASK       REMOTE_UINT32
 
 #define REMOTE_ADIV5_APnDP 0x0100U
 
@@ -380,6 +417,21 @@
 		REMOTE_SOM, REMOTE_ADIV5_PACKET, REMOTE_DP_TARGETSEL, REMOTE_ADIV5_DATA, REMOTE_EOM, 0 \
 	}
 
+/*
+ * Halt watch: the probe repeatedly reads the 32-bit word at the given address through the given AP while it
+ * has nothing else to do, until (word & mask) == value. It then sends an unsolicited &H<word># response and
+ * stops watching. Any further request from the host also stops the watch, so the host must re-arm it after
+ * talking to the probe. The probe also fires the watch if the read faults, leaving the host to find out why.
+ */
+#define REMOTE_HALT_WATCH_STR                                                                            \
+	(char[])                                                                                             \
+	{                                                                                                    \
+		REMOTE_SOM, REMOTE_ADIV5_PACKET, REMOTE_HALT_WATCH, REMOTE_ADIV5_DEV_INDEX, REMOTE_ADIV5_AP_SEL, \
+			REMOTE_ADIV5_CSW, REMOTE_ADIV5_ADDR64, REMOTE_ADIV5_MASK, REMOTE_ADIV5_DATA, REMOTE_EOM, 0   \
+	}
+/* 2 command bytes + 2 for dev index + 2 for AP select + 8 for CSW + 16 for the address + 8 each for mask and value */
+#define REMOTE_HALT_WATCH_LENGTH 46U
+
 /* ADIv6 acceleration protocol elements */
 #define REMOTE_ADIV6_PACKET '6'
 
@@ -415,18 +467,77 @@
  */
 #define REMOTE_ADIV6_MEM_WRITE_LENGTH 57U
 
+/*
+ * Binary (v5) ADIv5 acceleration requests start with the packet and command bytes, then the dev index and
+ * AP selection (which, as with the ASCII form, is R/!W for raw accesses), followed by:
+ *  - DP read, AP read: 16-bit address
+ *  - AP write, raw access: 16-bit address, 32-bit value
+ *  - memory read: 32-bit CSW, 64-bit address, 32-bit count
+ *  - memory write: 32-bit CSW, 8-bit alignment, 64-bit address, 32-bit count, then the data to write
+ */
+#define REMOTE_BINARY_ADIV5_REG_READ_LENGTH  6U
+#define REMOTE_BINARY_ADIV5_REG_WRITE_LENGTH 10U
+#define REMOTE_BINARY_ADIV5_MEM_READ_LENGTH  20U
+#define REMOTE_BINARY_ADIV5_MEM_WRITE_LENGTH 21U
+/*
+ * Binary (v5) ADIv5 streaming memory requests move more data than fits in a single frame:
+ *  - stream read: as for memory read, followed by the 16-bit maximum data length per response frame. The
+ *    probe answers with consecutive responses each carrying the next block of data, until either all the
+ *    data is sent or a response reports an error
+ *  - stream write: as for memory write, but without any data. The data then follows in stream data
+ *    frames, each the packet and command bytes then the next block of data. The probe answers just once,
+ *    after the last of the data, with the result of the whole write
+ */
+#define REMOTE_BINARY_ADIV5_STREAM_READ_LENGTH 22U
+#define REMOTE_BINARY_ADIV5_STREAM_DATA_LENGTH 2U
+/*
+ * Binary (v5) ADIv5 batch requests, available to probes advertising REMOTE_ACCEL_ADIV5_BATCH, start with the
+ * packet and command bytes, then the dev index and the number of operations in the batch, followed by each
+ * operation as its op byte and parameters:
+ *  - DP read ('d'): 16-bit address
+ *  - DP write ('D'): 16-bit address, 32-bit value
+ *  - AP read ('a'): AP selection, 16-bit address
+ *  - AP write ('A'): AP selection, 16-bit address, 32-bit value
+ *  - AP poll ('p'): AP selection, 16-bit address, 32-bit mask, 32-bit value, 16-bit timeout in milliseconds
+ * The operations are run in order, stopping at the first fault. On success, the response carries the 32-bit
+ * result of each read and poll operation in the order they appeared in the request.
+ */
+#define REMOTE_BINARY_ADIV5_BATCH_LENGTH  4U
+#define REMOTE_BINARY_ADIV5_BATCH_MAX_OPS 64U
+#define REMOTE_ADIV5_BATCH_DP_READ        'd'
+#define REMOTE_ADIV5_BATCH_DP_WRITE       'D'
+#define REMOTE_ADIV5_BATCH_AP_READ        'a'
+#define REMOTE_ADIV5_BATCH_AP_WRITE       'A'
+#define REMOTE_ADIV5_BATCH_AP_POLL        'p'
+/*
+ * Binary (v5) ADIv6 acceleration requests start with the packet, ADIv6 and command bytes, then the dev index
+ * and 64-bit DP resource bus AP base address, followed by the same parameters as their ADIv5 counterparts
+ */
+#define REMOTE_BINARY_ADIV6_REG_READ_LENGTH  14U
+#define REMOTE_BINARY_ADIV6_REG_WRITE_LENGTH 18U
+#define REMOTE_BINARY_ADIV6_MEM_READ_LENGTH  28U
+#define REMOTE_BINARY_ADIV6_MEM_WRITE_LENGTH 29U
+
 /* RISC-V acceleration protocol elements */
 #define REMOTE_RISCV_PACKET    'R'
 #define REMOTE_RISCV_PROTOCOLS 'P'
 #define REMOTE_RISCV_DMI_READ  'd'
 #define REMOTE_RISCV_DMI_WRITE 'D'
-
-#define REMOTE_RISCV_PROTOCOL    '%', 'c'
-#define REMOTE_RISCV_DEV_INDEX   REMOTE_UINT8
-#define REMOTE_RISCV_IDLE_CYCLES REMOTE_UINT8
-#define REMOTE_RISCV_ADDR_WIDTH  REMOTE_UINT8
-#define REMOTE_RISCV_ADDR32      REMOTE_UINT32
-#define REMOTE_RISCV_DATA        REMOTE_UINT32
+#define REMOTE_RISCV_MEM_READ  'm'
+#define REMOTE_RISCV_MEM_WRITE 'M'
+#define REMOTE_RISCV_REGS_READ 'g'
+
+#define REMOTE_RISCV_PROTOCOL     '%', 'c'
+#define REMOTE_RISCV_DEV_INDEX    REMOTE_UINT8
+#define REMOTE_RISCV_IDLE_CYCLES  REMOTE_UINT8
+#define REMOTE_RISCV_ADDR_WIDTH   REMOTE_UINT8
+#define REMOTE_RISCV_ADDR32       REMOTE_UINT32
+#define REMOTE_RISCV_DATA         REMOTE_UINT32
+#define REMOTE_RISCV_DM_BASE      REMOTE_UINT32
+#define REMOTE_RISCV_HART_FLAGS   REMOTE_UINT8
+#define REMOTE_RISCV_PROGBUF_SIZE REMOTE_UINT8
+#define REMOTE_RISCV_COUNT        REMOTE_UINT32
+#define REMOTE_RISCV_GPRS_COUNT   REMOTE_UINT8
 
 /* Supported RISC-V DTM protocols */
 #define REMOTE_RISCV_JTAG 'J'
@@ -454,6 +565,42 @@
 			REMOTE_RISCV_ADDR_WIDTH, REMOTE_RISCV_ADDR32, REMOTE_RISCV_DATA, REMOTE_EOM, 0                         \
 	}
 
+/*
+ * The Hart-level requests, available to probes advertising REMOTE_ACCEL_RISCV_HART, run whole memory accesses
+ * and register reads on 32-bit Harts on the probe. They carry the DM base address, Hart flags and progbuf size
+ * after the DMI parameters, and respond with the resulting Hart status and Hart flags as the first two bytes
+ * of any data, the flags picking up anything learnt about the Hart while running the request
+ */
+#define REMOTE_RISCV_MEM_READ_STR                                                                                 \
+	(char[])                                                                                                      \
+	{                                                                                                             \
+		REMOTE_SOM, REMOTE_RISCV_PACKET, REMOTE_RISCV_MEM_READ, REMOTE_RISCV_DEV_INDEX, REMOTE_RISCV_IDLE_CYCLES, \
+			REMOTE_RISCV_ADDR_WIDTH, REMOTE_RISCV_DM_BASE, REMOTE_RISCV_HART_FLAGS, REMOTE_RISCV_PROGBUF_SIZE,    \
+			REMOTE_RISCV_ADDR32, REMOTE_RISCV_COUNT, REMOTE_EOM, 0                                                \
+	}
+/* 2 leader bytes, 2 for the Hart status, 2 for the Hart flags and one trailer byte gives 7 bytes response overhead */
+#define REMOTE_RISCV_MEM_READ_LENGTH 7U
+#define REMOTE_RISCV_MEM_WRITE_STR                                                                                 \
+	(char[])                                                                                                       \
+	{                                                                                                              \
+		REMOTE_SOM, REMOTE_RISCV_PACKET, REMOTE_RISCV_MEM_WRITE, REMOTE_RISCV_DEV_INDEX, REMOTE_RISCV_IDLE_CYCLES, \
+			REMOTE_RISCV_ADDR_WIDTH, REMOTE_RISCV_DM_BASE, REMOTE_RISCV_HART_FLAGS, REMOTE_RISCV_PROGBUF_SIZE,     \
+			REMOTE_RISCV_ADDR32, REMOTE_RISCV_COUNT, 0                                                             \
+	}
+/*
+ * 3 leader bytes + 2 bytes for dev index + 2 for idle cycles + 2 for the address width + 8 for the DM base +
+ * 2 for the Hart flags + 2 for the progbuf size + 8 for the address and 8 for the count and one trailer gives
+ * 38 bytes request overhead
+ */
+#define REMOTE_RISCV_MEM_WRITE_LENGTH 38U
+#define REMOTE_RISCV_REGS_READ_STR                                                                                 \
+	(char[])                                                                                                       \
+	{                                                                                                              \
+		REMOTE_SOM, REMOTE_RISCV_PACKET, REMOTE_RISCV_REGS_READ, REMOTE_RISCV_DEV_INDEX, REMOTE_RISCV_IDLE_CYCLES, \
+			REMOTE_RISCV_ADDR_WIDTH, REMOTE_RISCV_DM_BASE, REMOTE_RISCV_HART_FLAGS, REMOTE_RISCV_PROGBUF_SIZE,     \
+			REMOTE_RISCV_GPRS_COUNT, REMOTE_EOM, 0                                                                 \
+	}
+
 /* Remote protocol enabled RISC-V protocols bit values */
 #define REMOTE_RISCV_PROTOCOL_JTAG (1U << 0U)
 
@@ -464,9 +611,10 @@
 #define REMOTE_SPI_CHIP_SELECT 'C'
 #define REMOTE_SPI_TRANSFER    'X'
 #define REMOTE_SPI_READ        'r'
-#define REMOTE_SPI_WRTIE       'w'
+#define REMOTE_SPI_WRITE       'w'
 #define REMOTE_SPI_CHIP_ID     'I'
 #define REMOTE_SPI_RUN_COMMAND 'c'
+#define REMOTE_SPI_PROGRAM     'p'
 
 #define REMOTE_SPI_BEGIN_STR                                                                          \
 	(char[])                                                                                          \
@@ -511,7 +659,20 @@
 		REMOTE_SOM, REMOTE_SPI_PACKET, REMOTE_SPI_RUN_COMMAND, REMOTE_UINT8, REMOTE_UINT8, REMOTE_UINT16, \
 			REMOTE_UINT24, REMOTE_EOM, 0                                                                  \
 	}
+/* The ASCII read and write requests can move at most this many bytes of data per request */
+#define REMOTE_SPI_MAX_DATA_LENGTH 256U
+
+/*
+ * Binary (v5) SPI requests start with the packet and command bytes, then the bus and device to use, followed
+ * by the 16-bit SPI Flash command, the 32-bit address and 16-bit data length for the operation, then any
+ * data to write. Read ('r') requests respond with the data read, write ('w') requests perform a complete
+ * write cycle with the data, and program ('p') requests enable writing, perform the write cycle with the
+ * data, then wait for the Flash to finish programming it before responding.
+ */
+#define REMOTE_BINARY_SPI_LENGTH 12U
 
 void remote_packet_process(char *packet, size_t packet_length);
+void remote_binary_packet_process(uint8_t *packet, size_t packet_length);
+char remote_halt_watch_getchar(void);
 
 #endif /* REMOTE_H */
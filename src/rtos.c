@@ -0,0 +1,586 @@
+/*
+ * This file is part of the Black Magic Debug project.
+ *
+ * Copyright (C) 2026 1BitSquared <info@1bitsquared.com>
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived from
+ *    this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/*
+ * This file implements RTOS thread awareness - rather than the single thread that is the CPU, the tasks of an
+ * RTOS running on the target are presented to GDB as threads. The RTOS is found by GDB looking up the symbols
+ * it needs for us via qSymbol, the task lists are then walked on the probe side with block memory reads, and
+ * the registers of tasks that are switched out are unstacked from the context saved on their stacks.
+ *
+ * FreeRTOS on ARMv6-M and ARMv7-M cores (the ARM_CM0, ARM_CM3, ARM_CM4F and ARM_CM7 ports) is supported.
+ * Other RTOSes slot in as further entries in the rtos_drivers table.
+ */
+
+#include "general.h"
+#include "target.h"
+#include "target_internal.h"
+#include "cortex.h"
+#include "cortex_internal.h"
+#include "gdb_packet.h"
+#include "buffer_utils.h"
+#include "hex_utils.h"
+#include "rtos.h"
+
+#include <assert.h>
+
+/* Largest number of symbols any one RTOS driver needs looking up */
+#define RTOS_MAX_SYMBOLS 8U
+
+typedef enum rtos_thread_state {
+	RTOS_THREAD_READY,
+	RTOS_THREAD_BLOCKED,
+	RTOS_THREAD_SUSPENDED,
+	RTOS_THREAD_DELETED,
+} rtos_thread_state_e;
+
+typedef struct rtos_thread {
+	uint32_t id;
+	uint32_t stack_pointer;
+	rtos_thread_state_e state;
+	char name[RTOS_THREAD_NAME_LEN + 1U];
+} rtos_thread_s;
+
+typedef struct rtos rtos_s;
+
+typedef struct rtos_driver {
+	const char *name;
+	/* The symbols the driver needs, the first required_symbols of which must be found for it to be used */
+	const char *const *symbols;
+	size_t symbol_count;
+	size_t required_symbols;
+	/* Whether the driver knows how this target's threads are stacked */
+	bool (*supported)(const target_s *target);
+	bool (*current_thread)(rtos_s *rtos, target_s *target, uint32_t *thread_id);
+	bool (*threads_read)(rtos_s *rtos, target_s *target);
+	bool (*thread_regs_read)(rtos_s *rtos, target_s *target, const rtos_thread_s *thread, void *data);
+} rtos_driver_s;
+
+struct rtos {
+	rtos_s *next;
+	const target_s *target;
+	/* The RTOS found running on the target, NULL if there isn't one (yet) */
+	const rtos_driver_s *driver;
+	/* Progress of the qSymbol exchange with GDB */
+	size_t lookup_driver;
+	size_t lookup_symbol;
+	uint32_t symbols_found;
+	uint32_t symbols[RTOS_MAX_SYMBOLS];
+	/* The running thread and the thread list, read on demand after each halt */
+	bool current_valid;
+	bool threads_valid;
+	uint32_t current_thread;
+	size_t thread_count;
+	rtos_thread_s threads[RTOS_MAX_THREADS];
+};
+
+static rtos_s *rtos_list = NULL;
+
+static const char *const rtos_thread_state_names[] = {
+	[RTOS_THREAD_READY] = "Ready",
+	[RTOS_THREAD_BLOCKED] = "Blocked",
+	[RTOS_THREAD_SUSPENDED] = "Suspended",
+	[RTOS_THREAD_DELETED] = "Deleted",
+};
+
+static bool rtos_symbol_found(const rtos_s *const rtos, const size_t symbol)
+{
+	return rtos->symbols_found & (1U << symbol);
+}
+
+static void rtos_thread_add(
+	rtos_s *const rtos, const uint32_t thread_id, const uint32_t stack_pointer, const rtos_thread_state_e state)
+{
+	/* A thread can be found on more than one list (pending ready and delayed, for example), only keep the first */
+	for (size_t idx = 0U; idx < rtos->thread_count; ++idx) {
+		if (rtos->threads[idx].id == thread_id)
+			return;
+	}
+	if (rtos->thread_count == RTOS_MAX_THREADS)
+		return;
+	rtos_thread_s *const thread = &rtos->threads[rtos->thread_count++];
+	thread->id = thread_id;
+	thread->stack_pointer = stack_pointer;
+	thread->state = state;
+	thread->name[0] = '\0';
+}
+
+/*
+ * FreeRTOS support
+ *
+ * Each task's TCB is found by walking the kernel's task lists, and the TCB's address is used as the thread ID.
+ * This assumes 32-bit pointers and ticks, the default configUSE_MINI_LIST_ITEM, no list integrity check bytes,
+ * and no MPU wrappers (which would move the fields after pxTopOfStack).
+ */
+typedef enum freertos_symbol {
+	FREERTOS_CURRENT_TCB,
+	FREERTOS_READY_LISTS,
+	FREERTOS_DELAYED_LIST1,
+	FREERTOS_DELAYED_LIST2,
+	FREERTOS_PENDING_READY_LIST,
+	/* Optional symbols */
+	FREERTOS_SUSPENDED_LIST,
+	FREERTOS_TERMINATION_LIST,
+	FREERTOS_TOP_USED_PRIORITY,
+	FREERTOS_SYMBOL_COUNT,
+} freertos_symbol_e;
+
+static_assert(FREERTOS_SYMBOL_COUNT <= RTOS_MAX_SYMBOLS, "FreeRTOS needs more symbols than an rtos_s can hold");
+
+static const char *const freertos_symbols[FREERTOS_SYMBOL_COUNT] = {
+	[FREERTOS_CURRENT_TCB] = "pxCurrentTCB",
+	[FREERTOS_READY_LISTS] = "pxReadyTasksLists",
+	[FREERTOS_DELAYED_LIST1] = "xDelayedTaskList1",
+	[FREERTOS_DELAYED_LIST2] = "xDelayedTaskList2",
+	[FREERTOS_PENDING_READY_LIST] = "xPendingReadyList",
+	[FREERTOS_SUSPENDED_LIST] = "xSuspendedTaskList",
+	[FREERTOS_TERMINATION_LIST] = "xTasksWaitingTermination",
+	[FREERTOS_TOP_USED_PRIORITY] = "uxTopUsedPriority",
+};
+
+/* List_t: uxNumberOfItems, pxIndex, then the xListEnd marker item (xItemValue, pxNext, pxPrevious) */
+#define FREERTOS_LIST_SIZE       20U
+#define FREERTOS_LIST_ITEMS      0U
+#define FREERTOS_LIST_END        8U
+#define FREERTOS_LIST_FIRST_ITEM 12U
+/* ListItem_t: xItemValue, pxNext, pxPrevious, pvOwner, pxContainer */
+#define FREERTOS_ITEM_NEXT  4U
+#define FREERTOS_ITEM_OWNER 12U
+/* TCB_t: pxTopOfStack, xStateListItem, xEventListItem, uxPriority, pxStack, pcTaskName */
+#define FREERTOS_TCB_TOP_OF_STACK 0U
+#define FREERTOS_TCB_STATE_ITEM   4U
+#define FREERTOS_TCB_NAME         52U
+#define FREERTOS_TCB_READ_SIZE    (FREERTOS_TCB_NAME + RTOS_THREAD_NAME_LEN)
+
+/* The most ready lists (configMAX_PRIORITIES) we will walk, and how many to read in one go */
+#define FREERTOS_MAX_PRIORITIES    32U
+#define FREERTOS_READY_LISTS_CHUNK 8U
+
+static bool freertos_current_thread(rtos_s *const rtos, target_s *const target, uint32_t *const thread_id)
+{
+	uint8_t current_tcb[4];
+	if (target_mem32_read_cached(target, current_tcb, rtos->symbols[FREERTOS_CURRENT_TCB], sizeof(current_tcb)))
+		return false;
+	*thread_id = read_le4(current_tcb, 0);
+	/* Before the scheduler has created any tasks, there's only the CPU */
+	return *thread_id != 0U;
+}
+
+/* Walk a task list whose List_t has already been read in to header, adding the tasks found on it */
+static bool freertos_list_walk(rtos_s *const rtos, target_s *const target, const uint32_t list,
+	const uint8_t *const header, const rtos_thread_state_e state)
+{
+	const uint32_t items = read_le4(header, FREERTOS_LIST_ITEMS);
+	const uint32_t list_end = list + FREERTOS_LIST_END;
+	uint32_t item = read_le4(header, FREERTOS_LIST_FIRST_ITEM);
+	for (uint32_t idx = 0U; idx < items && item != list_end && rtos->thread_count < RTOS_MAX_THREADS; ++idx) {
+		/*
+		 * Items on all but the pending ready list are the TCB's xStateListItem, so reading the TCB on the
+		 * assumption that this is one gets both the list item and the task in a single read
+		 */
+		uint8_t tcb[FREERTOS_TCB_READ_SIZE];
+		const uint32_t tcb_address = item - FREERTOS_TCB_STATE_ITEM;
+		if (target_mem32_read_cached(target, tcb, tcb_address, sizeof(tcb)))
+			return false;
+		const uint32_t owner = read_le4(tcb, FREERTOS_TCB_STATE_ITEM + FREERTOS_ITEM_OWNER);
+		item = read_le4(tcb, FREERTOS_TCB_STATE_ITEM + FREERTOS_ITEM_NEXT);
+		if (owner == 0U)
+			return false;
+		/* It wasn't (it's an xEventListItem), so go and read the actual TCB */
+		if (owner != tcb_address && target_mem32_read_cached(target, tcb, owner, sizeof(tcb)))
+			return false;
+
+		const size_t thread_index = rtos->thread_count;
+		rtos_thread_add(rtos, owner, read_le4(tcb, FREERTOS_TCB_TOP_OF_STACK), state);
+		if (rtos->thread_count != thread_index) {
+			rtos_thread_s *const thread = &rtos->threads[thread_index];
+			memcpy(thread->name, tcb + FREERTOS_TCB_NAME, RTOS_THREAD_NAME_LEN);
+			thread->name[RTOS_THREAD_NAME_LEN] = '\0';
+		}
+	}
+	return true;
+}
+
+static bool freertos_list_read(
+	rtos_s *const rtos, target_s *const target, const freertos_symbol_e symbol, const rtos_thread_state_e state)
+{
+	if (!rtos_symbol_found(rtos, symbol))
+		return true;
+	uint8_t header[FREERTOS_LIST_SIZE];
+	const uint32_t list = rtos->symbols[symbol];
+	return !target_mem32_read_cached(target, header, list, sizeof(header)) &&
+		freertos_list_walk(rtos, target, list, header, state);
+}
+
+/* Work out configMAX_PRIORITIES, which is how many ready lists there are */
+static size_t freertos_priorities(rtos_s *const rtos, target_s *const target)
+{
+	if (rtos_symbol_found(rtos, FREERTOS_TOP_USED_PRIORITY)) {
+		uint8_t top_used_priority[4];
+		if (target_mem32_read_cached(
+				target, top_used_priority, rtos->symbols[FREERTOS_TOP_USED_PRIORITY], sizeof(top_used_priority)))
+			return 0U;
+		return MIN(read_le4(top_used_priority, 0) + 1U, FREERTOS_MAX_PRIORITIES);
+	}
+	/* Without uxTopUsedPriority, rely on tasks.c's ready list array being followed by xDelayedTaskList1 */
+	const uint32_t ready_lists = rtos->symbols[FREERTOS_READY_LISTS];
+	const uint32_t delayed_list = rtos->symbols[FREERTOS_DELAYED_LIST1];
+	if (delayed_list <= ready_lists || (delayed_list - ready_lists) % FREERTOS_LIST_SIZE != 0U) {
+		DEBUG_WARN("FreeRTOS: Unable to determine the number of priorities, uxTopUsedPriority is needed\n");
+		return 0U;
+	}
+	return MIN((delayed_list - ready_lists) / FREERTOS_LIST_SIZE, FREERTOS_MAX_PRIORITIES);
+}
+
+static bool freertos_threads_read(rtos_s *const rtos, target_s *const target)
+{
+	const size_t priorities = freertos_priorities(rtos, target);
+	if (!priorities)
+		return false;
+	/* Read the ready lists in blocks, so finding the ready tasks costs a handful of reads */
+	const uint32_t ready_lists = rtos->symbols[FREERTOS_READY_LISTS];
+	for (size_t priority = 0U; priority < priorities; priority += FREERTOS_READY_LISTS_CHUNK) {
+		const size_t lists = MIN(priorities - priority, FREERTOS_READY_LISTS_CHUNK);
+		uint8_t headers[FREERTOS_LIST_SIZE * FREERTOS_READY_LISTS_CHUNK];
+		const uint32_t address = ready_lists + (priority * FREERTOS_LIST_SIZE);
+		if (target_mem32_read_cached(target, headers, address, lists * FREERTOS_LIST_SIZE))
+			return false;
+		for (size_t idx = 0U; idx < lists; ++idx) {
+			const uint8_t *const header = headers + (idx * FREERTOS_LIST_SIZE);
+			if (read_le4(header, FREERTOS_LIST_ITEMS) != 0U &&
+				!freertos_list_walk(rtos, target, address + (idx * FREERTOS_LIST_SIZE), header, RTOS_THREAD_READY))
+				return false;
+		}
+	}
+
+	return freertos_list_read(rtos, target, FREERTOS_PENDING_READY_LIST, RTOS_THREAD_READY) &&
+		freertos_list_read(rtos, target, FREERTOS_DELAYED_LIST1, RTOS_THREAD_BLOCKED) &&
+		freertos_list_read(rtos, target, FREERTOS_DELAYED_LIST2, RTOS_THREAD_BLOCKED) &&
+		freertos_list_read(rtos, target, FREERTOS_SUSPENDED_LIST, RTOS_THREAD_SUSPENDED) &&
+		freertos_list_read(rtos, target, FREERTOS_TERMINATION_LIST, RTOS_THREAD_DELETED);
+}
+
+/*
+ * What the FreeRTOS ARMv6-M and ARMv7-M ports leave on a task's stack when it is switched out: r4-r11,
+ * followed on FPU-enabled ports by the EXC_RETURN value and s16-s31 if the task has FP context, and then the
+ * exception frame stacked by the hardware - r0-r3, r12, lr, pc, xpsr, and s0-s15 + fpscr for extended frames
+ */
+#define FREERTOS_CORTEXM_CALLEE_REGS 8U
+#define CORTEXM_EXC_RETURN_MASK      0xffffffe0U
+#define CORTEXM_EXC_RETURN_STD_FRAME (1U << 4U) /* Clear if the exception frame includes FP state */
+#define CORTEXM_XPSR_STACK_ALIGN     (1U << 9U) /* Set if the hardware padded the stack for alignment */
+#define CORTEXM_FRAME_REGS           8U
+#define CORTEXM_FRAME_EXTENDED_REGS  26U
+#define CORTEXM_FLOAT_CALLEE_REGS    16U
+
+static bool freertos_cortexm_supported(const target_s *const target)
+{
+	switch (target->cpuid & CORTEX_CPUID_PARTNO_MASK) {
+	case CORTEX_M0:
+	case CORTEX_M0P:
+	case CORTEX_M3:
+	case CORTEX_M4:
+	case CORTEX_M7:
+		return true;
+	default:
+		return false;
+	}
+}
+
+static bool freertos_cortexm_regs_read(
+	rtos_s *const rtos, target_s *const target, const rtos_thread_s *const thread, void *const data)
+{
+	(void)rtos;
+	const size_t regs_size = target_regs_size(target);
+	if (regs_size < sizeof(uint32_t) * CORTEXM_GENERAL_REG_COUNT)
+		return false;
+	uint32_t *const regs = (uint32_t *)data;
+	/* Start from the live registers, so those a task switch doesn't save (msp, control, etc) read sensibly */
+	target_regs_read(target, regs);
+
+	uint32_t stack = thread->stack_pointer;
+	uint8_t callee_regs[(FREERTOS_CORTEXM_CALLEE_REGS + 1U) * 4U];
+	if (target_mem32_read_cached(target, callee_regs, stack, sizeof(callee_regs)))
+		return false;
+	/* If the next word is an EXC_RETURN value, this is one of the ports that also saves FP context */
+	const bool has_fpu = target->target_options & CORTEXM_TOPT_FLAVOUR_FLOAT;
+	const uint32_t exc_return = read_le4(callee_regs, FREERTOS_CORTEXM_CALLEE_REGS * 4U);
+	const bool fpu_port = has_fpu && (exc_return & CORTEXM_EXC_RETURN_MASK) == CORTEXM_EXC_RETURN_MASK;
+	const bool extended_frame = fpu_port && !(exc_return & CORTEXM_EXC_RETURN_STD_FRAME);
+	stack += (FREERTOS_CORTEXM_CALLEE_REGS + (fpu_port ? 1U : 0U)) * 4U;
+
+	uint8_t float_callee_regs[CORTEXM_FLOAT_CALLEE_REGS * 4U];
+	if (extended_frame) {
+		if (target_mem32_read_cached(target, float_callee_regs, stack, sizeof(float_callee_regs)))
+			return false;
+		stack += sizeof(float_callee_regs);
+	}
+
+	uint8_t frame[CORTEXM_FRAME_EXTENDED_REGS * 4U];
+	const size_t frame_size = (extended_frame ? CORTEXM_FRAME_EXTENDED_REGS : CORTEXM_FRAME_REGS) * 4U;
+	if (target_mem32_read_cached(target, frame, stack, frame_size))
+		return false;
+
+	for (size_t idx = 0U; idx < 4U; ++idx)
+		regs[idx] = read_le4(frame, idx * 4U);
+	for (size_t idx = 0U; idx < FREERTOS_CORTEXM_CALLEE_REGS; ++idx)
+		regs[4U + idx] = read_le4(callee_regs, idx * 4U);
+	regs[12U] = read_le4(frame, 16U);
+	regs[CORTEX_REG_LR] = read_le4(frame, 20U);
+	regs[CORTEX_REG_PC] = read_le4(frame, 24U);
+	regs[CORTEX_REG_XPSR] = read_le4(frame, 28U);
+	/* The task's stack pointer is where it was before the exception frame was pushed */
+	stack += frame_size;
+	if (regs[CORTEX_REG_XPSR] & CORTEXM_XPSR_STACK_ALIGN)
+		stack += 4U;
+	regs[CORTEX_REG_SP] = stack;
+	regs[CORTEX_REG_PSP] = stack;
+
+	/* FP registers follow the general purpose ones (these cores have no TrustZone registers in between) */
+	if (has_fpu && regs_size >= sizeof(uint32_t) * (CORTEXM_GENERAL_REG_COUNT + CORTEX_FLOAT_REG_COUNT)) {
+		uint32_t *const float_regs = regs + CORTEXM_GENERAL_REG_COUNT;
+		memset(float_regs, 0, sizeof(uint32_t) * CORTEX_FLOAT_REG_COUNT);
+		if (extended_frame) {
+			/* fpscr, then s0-s15 from the exception frame, then s16-s31 from the callee saved set */
+			float_regs[0] = read_le4(frame, (CORTEXM_FRAME_REGS + 16U) * 4U);
+			for (size_t idx = 0U; idx < 16U; ++idx)
+				float_regs[1U + idx] = read_le4(frame, (CORTEXM_FRAME_REGS + idx) * 4U);
+			for (size_t idx = 0U; idx < CORTEXM_FLOAT_CALLEE_REGS; ++idx)
+				float_regs[17U + idx] = read_le4(float_callee_regs, idx * 4U);
+		}
+	}
+	return true;
+}
+
+static const rtos_driver_s rtos_drivers[] = {
+	{
+		.name = "FreeRTOS",
+		.symbols = freertos_symbols,
+		.symbol_count = FREERTOS_SYMBOL_COUNT,
+		.required_symbols = FREERTOS_SUSPENDED_LIST,
+		.supported = freertos_cortexm_supported,
+		.current_thread = freertos_current_thread,
+		.threads_read = freertos_threads_read,
+		.thread_regs_read = freertos_cortexm_regs_read,
+	},
+};
+
+static rtos_s *rtos_find(const target_s *const target)
+{
+	for (rtos_s *rtos = rtos_list; rtos; rtos = rtos->next) {
+		if (rtos->target == target)
+			return rtos;
+	}
+	return NULL;
+}
+
+/* Ask GDB for the next symbol we need, or tell it we're done once we've been through every driver */
+static void rtos_lookup_next(rtos_s *const rtos, const target_s *const target)
+{
+	while (rtos->lookup_driver < ARRAY_LENGTH(rtos_drivers)) {
+		const rtos_driver_s *const driver = &rtos_drivers[rtos->lookup_driver];
+		if (driver->supported(target)) {
+			if (rtos->lookup_symbol < driver->symbol_count) {
+				const char *const symbol = driver->symbols[rtos->lookup_symbol];
+				gdb_put_packet("qSymbol:", 8U, symbol, strlen(symbol), true);
+				return;
+			}
+			const uint32_t required = (1U << driver->required_symbols) - 1U;
+			if ((rtos->symbols_found & required) == required) {
+				DEBUG_INFO("%s detected\n", driver->name);
+				rtos->driver = driver;
+				break;
+			}
+		}
+		/* Move on to the next driver, starting its lookups afresh */
+		++rtos->lookup_driver;
+		rtos->lookup_symbol = 0U;
+		rtos->symbols_found = 0U;
+	}
+	gdb_put_packet_ok();
+}
+
+void rtos_symbol_lookup(target_s *const target, const char *const packet, const size_t length)
+{
+	rtos_s *rtos = rtos_find(target);
+	if (!rtos) {
+		rtos = calloc(1, sizeof(*rtos));
+		if (!rtos) { /* calloc failed: heap exhaustion */
+			DEBUG_ERROR("calloc: failed in %s\n", __func__);
+			gdb_put_packet_ok();
+			return;
+		}
+		rtos->target = target;
+		rtos->next = rtos_list;
+		rtos_list = rtos;
+	}
+
+	if (length == 1U && packet[0] == ':') {
+		/* "qSymbol::" - GDB is ready to look symbols up, so start from the beginning */
+		rtos->driver = NULL;
+		rtos->lookup_driver = 0U;
+		rtos->lookup_symbol = 0U;
+		rtos->symbols_found = 0U;
+		rtos->current_valid = false;
+		rtos->threads_valid = false;
+	} else if (rtos->driver || rtos->lookup_driver >= ARRAY_LENGTH(rtos_drivers) ||
+		rtos->lookup_symbol >= rtos_drivers[rtos->lookup_driver].symbol_count) {
+		/* The lookup is already over, so there's no request outstanding this can be the answer to */
+		gdb_put_packet_ok();
+		return;
+	} else {
+		/*
+		 * "qSymbol:value:name", or "qSymbol::name" if GDB doesn't know the symbol. We only ever have
+		 * one request outstanding, so this is the answer for the symbol we last asked about
+		 */
+		uint32_t value = 0U;
+		if (packet[0] != ':' && read_hex32(packet, NULL, &value, ':')) {
+			rtos->symbols[rtos->lookup_symbol] = value;
+			rtos->symbols_found |= 1U << rtos->lookup_symbol;
+		}
+		++rtos->lookup_symbol;
+	}
+	rtos_lookup_next(rtos, target);
+}
+
+void rtos_target_halted(target_s *const target)
+{
+	rtos_s *const rtos = rtos_find(target);
+	if (rtos) {
+		rtos->current_valid = false;
+		rtos->threads_valid = false;
+	}
+}
+
+void rtos_target_destroyed(const target_s *const target)
+{
+	for (rtos_s **rtos = &rtos_list; *rtos; rtos = &(*rtos)->next) {
+		if ((*rtos)->target == target) {
+			rtos_s *const next = (*rtos)->next;
+			free(*rtos);
+			*rtos = next;
+			return;
+		}
+	}
+}
+
+/* Get the RTOS running on the target, or NULL if there's no RTOS to speak of (yet) */
+static rtos_s *rtos_running(target_s *const target)
+{
+	rtos_s *const rtos = rtos_find(target);
+	if (!rtos || !rtos->driver)
+		return NULL;
+	if (!rtos->current_valid) {
+		rtos->current_valid = true;
+		if (!rtos->driver->current_thread(rtos, target, &rtos->current_thread))
+			rtos->current_thread = 0U;
+	}
+	/* Without a running thread, fall back to presenting the CPU as the only thread */
+	return rtos->current_thread ? rtos : NULL;
+}
+
+/* As rtos_running(), but also make sure the thread list is up to date */
+static rtos_s *rtos_active(target_s *const target)
+{
+	rtos_s *const rtos = rtos_running(target);
+	if (!rtos || rtos->threads_valid)
+		return rtos;
+	rtos->threads_valid = true;
+	rtos->thread_count = 0U;
+	if (!rtos->driver->threads_read(rtos, target)) {
+		DEBUG_WARN("%s: Failed to read the task lists\n", rtos->driver->name);
+		rtos->thread_count = 0U;
+	}
+	/* The running task can be on none of the lists while they're being updated, make sure it's there */
+	rtos_thread_add(rtos, rtos->current_thread, 0U, RTOS_THREAD_READY);
+	return rtos;
+}
+
+static const rtos_thread_s *rtos_thread_find(const rtos_s *const rtos, const uint32_t thread_id)
+{
+	for (size_t idx = 0U; idx < rtos->thread_count; ++idx) {
+		if (rtos->threads[idx].id == thread_id)
+			return &rtos->threads[idx];
+	}
+	return NULL;
+}
+
+uint32_t rtos_current_thread(target_s *const target)
+{
+	/* This is needed for every stop reply, so avoid walking the task lists for it */
+	const rtos_s *const rtos = rtos_running(target);
+	return rtos ? rtos->current_thread : RTOS_THREAD_ID_CPU;
+}
+
+bool rtos_thread_id(target_s *const target, const size_t index, uint32_t *const thread_id)
+{
+	const rtos_s *const rtos = rtos_active(target);
+	if (!rtos) {
+		*thread_id = RTOS_THREAD_ID_CPU;
+		return index == 0U;
+	}
+	if (index >= rtos->thread_count)
+		return false;
+	*thread_id = rtos->threads[index].id;
+	return true;
+}
+
+bool rtos_thread_exists(target_s *const target, const uint32_t thread_id)
+{
+	const rtos_s *const rtos = rtos_active(target);
+	if (!rtos)
+		return thread_id == RTOS_THREAD_ID_CPU;
+	return rtos_thread_find(rtos, thread_id) != NULL;
+}
+
+bool rtos_thread_describe(
+	target_s *const target, const uint32_t thread_id, char *const buffer, const size_t buffer_size)
+{
+	const rtos_s *const rtos = rtos_active(target);
+	const rtos_thread_s *const thread = rtos ? rtos_thread_find(rtos, thread_id) : NULL;
+	if (!thread)
+		return false;
+	if (thread->id == rtos->current_thread)
+		snprintf(buffer, buffer_size, "%s: Running", thread->name);
+	else
+		snprintf(buffer, buffer_size, "%s: %s", thread->name, rtos_thread_state_names[thread->state]);
+	return true;
+}
+
+bool rtos_thread_regs_read(target_s *const target, const uint32_t thread_id, void *const data)
+{
+	rtos_s *const rtos = rtos_active(target);
+	const rtos_thread_s *const thread = rtos ? rtos_thread_find(rtos, thread_id) : NULL;
+	/* The running thread's registers are the CPU's, so only switched out threads need unstacking */
+	if (!thread || thread->id == rtos->current_thread)
+		return false;
+	return rtos->driver->thread_regs_read(rtos, target, thread, data);
+}
@@ -702,6 +702,103 @@ void adiv5_mem_write(adiv5_access_port_s *const ap, const target_addr64_t dest,
 	adiv5_mem_write_aligned(ap, dest, src, len, align);
 }
 
+static void adiv5_batch_op_run(adiv5_debug_port_s *const dp, const adiv5_batch_op_s *const op)
+{
+	switch (op->type) {
+	case ADIV5_BATCH_DP_READ:
+		*op->result = adiv5_dp_read(dp, op->addr);
+		break;
+	case ADIV5_BATCH_DP_WRITE:
+		adiv5_dp_write(dp, op->addr, op->value);
+		break;
+	case ADIV5_BATCH_AP_READ:
+		*op->result = adiv5_ap_read(op->ap, op->addr);
+		break;
+	case ADIV5_BATCH_AP_WRITE:
+		adiv5_ap_write(op->ap, op->addr, op->value);
+		break;
+	case ADIV5_BATCH_AP_POLL: {
+		/* Re-read the register until the masked value matches, it times out, or the access faults */
+		platform_timeout_s timeout;
+		platform_timeout_set(&timeout, op->timeout);
+		uint32_t value = adiv5_ap_read(op->ap, op->addr);
+		while ((value & op->mask) != op->value && !dp->fault && !platform_timeout_is_expired(&timeout))
+			value = adiv5_ap_read(op->ap, op->addr);
+		*op->result = value;
+		break;
+	}
+	}
+}
+
+static void adiv5_batch_queue(adiv5_batch_s *const batch, const adiv5_batch_op_s *const op)
+{
+#if CONFIG_BMDA == 1
+	/* If the DP can run batches, queue the operation up, running what we have first if the batch is full */
+	if (batch->dp->batch_run) {
+		if (batch->count == ADIV5_BATCH_MAX_OPS)
+			adiv5_batch_run(batch);
+		/* As with a failed single access, results read as 0 if the batch fails before getting to them */
+		if (op->result)
+			*op->result = 0U;
+		batch->ops[batch->count++] = *op;
+		return;
+	}
+#endif
+	/* Otherwise, run the operation straight away */
+	adiv5_batch_op_run(batch->dp, op);
+}
+
+void adiv5_batch_dp_read(adiv5_batch_s *const batch, const uint16_t addr, uint32_t *const result)
+{
+	adiv5_batch_queue(batch, &(adiv5_batch_op_s){.type = ADIV5_BATCH_DP_READ, .addr = addr, .result = result});
+}
+
+void adiv5_batch_dp_write(adiv5_batch_s *const batch, const uint16_t addr, const uint32_t value)
+{
+	adiv5_batch_queue(batch, &(adiv5_batch_op_s){.type = ADIV5_BATCH_DP_WRITE, .addr = addr, .value = value});
+}
+
+void adiv5_batch_ap_read(
+	adiv5_batch_s *const batch, adiv5_access_port_s *const ap, const uint16_t addr, uint32_t *const result)
+{
+	adiv5_batch_queue(
+		batch, &(adiv5_batch_op_s){.type = ADIV5_BATCH_AP_READ, .ap = ap, .addr = addr, .result = result});
+}
+
+void adiv5_batch_ap_write(
+	adiv5_batch_s *const batch, adiv5_access_port_s *const ap, const uint16_t addr, const uint32_t value)
+{
+	adiv5_batch_queue(batch, &(adiv5_batch_op_s){.type = ADIV5_BATCH_AP_WRITE, .ap = ap, .addr = addr, .value = value});
+}
+
+void adiv5_batch_ap_poll(adiv5_batch_s *const batch, adiv5_access_port_s *const ap, const uint16_t addr,
+	const uint32_t mask, const uint32_t value, const uint16_t timeout, uint32_t *const result)
+{
+	adiv5_batch_queue(batch,
+		&(adiv5_batch_op_s){
+			.type = ADIV5_BATCH_AP_POLL,
+			.ap = ap,
+			.addr = addr,
+			.timeout = timeout,
+			.mask = mask,
+			.value = value,
+			.result = result,
+		});
+}
+
+void adiv5_batch_run(adiv5_batch_s *const batch)
+{
+#if CONFIG_BMDA == 1
+	/* Hand anything queued up to the DP to run, and empty the batch out ready for reuse */
+	if (batch->count)
+		batch->dp->batch_run(batch->dp, batch);
+	batch->count = 0U;
+#else
+	/* Everything has already run as it was added to the batch */
+	(void)batch;
+#endif
+}
+
 #ifndef DEBUG_PROTO_IS_NOOP
 static void decode_dp_access(const uint8_t addr, const uint8_t rnw, const uint32_t value)
 {
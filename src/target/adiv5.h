@@ -278,6 +278,18 @@ void adiv5_mem_read_bytes(adiv5_access_port_s *ap, void *dest, target_addr64_t s
 void adiv5_ap_reg_write(adiv5_access_port_s *ap, uint16_t addr, uint32_t value);
 uint32_t adiv5_ap_reg_read(adiv5_access_port_s *ap, uint16_t addr);
 
+/*
+ * ADIv5 batched DP/AP access functions. Reads and polls store their results through the given pointer,
+ * which is only valid to look at once adiv5_batch_run() has returned.
+ */
+void adiv5_batch_dp_read(adiv5_batch_s *batch, uint16_t addr, uint32_t *result);
+void adiv5_batch_dp_write(adiv5_batch_s *batch, uint16_t addr, uint32_t value);
+void adiv5_batch_ap_read(adiv5_batch_s *batch, adiv5_access_port_s *ap, uint16_t addr, uint32_t *result);
+void adiv5_batch_ap_write(adiv5_batch_s *batch, adiv5_access_port_s *ap, uint16_t addr, uint32_t value);
+void adiv5_batch_ap_poll(adiv5_batch_s *batch, adiv5_access_port_s *ap, uint16_t addr, uint32_t mask, uint32_t value,
+	uint16_t timeout, uint32_t *result);
+void adiv5_batch_run(adiv5_batch_s *batch);
+
 /* ADIv5 DP logical operation function for reading DPIDR safely */
 uint32_t adiv5_dp_read_dpidr(adiv5_debug_port_s *dp);
 
@@ -192,6 +192,7 @@
 
 typedef struct adiv5_access_port adiv5_access_port_s;
 typedef struct adiv5_debug_port adiv5_debug_port_s;
+typedef struct adiv5_batch adiv5_batch_s;
 
 struct adiv5_debug_port {
 	int refcnt;
@@ -208,6 +209,13 @@ struct adiv5_debug_port {
 	void (*ap_regs_read)(adiv5_access_port_s *ap, void *data);
 	uint32_t (*ap_reg_read)(adiv5_access_port_s *ap, uint8_t reg_num);
 	void (*ap_reg_write)(adiv5_access_port_s *ap, uint8_t num, uint32_t value);
+	/*
+	 * Optional probe-side halt detection: watch the word at addr for (word & mask) == value, returning false
+	 * while nothing has happened and true once the target needs polling properly
+	 */
+	bool (*halt_watch)(adiv5_access_port_s *ap, target_addr64_t addr, uint32_t mask, uint32_t value);
+	/* Optional batched access: run all the operations queued up in batch in one go, see adiv5_batch_run() */
+	void (*batch_run)(adiv5_debug_port_s *dp, const adiv5_batch_s *batch);
 #endif
 	uint32_t (*ap_read)(adiv5_access_port_s *ap, uint16_t addr);
 	void (*ap_write)(adiv5_access_port_s *ap, uint16_t addr, uint32_t value);
@@ -255,6 +263,41 @@ struct adiv5_access_port {
 	uint16_t partno;
 };
 
+/* How many operations a batch can hold before it has to be run to make room for more */
+#define ADIV5_BATCH_MAX_OPS 48U
+
+typedef enum adiv5_batch_op_type {
+	ADIV5_BATCH_DP_READ,
+	ADIV5_BATCH_DP_WRITE,
+	ADIV5_BATCH_AP_READ,
+	ADIV5_BATCH_AP_WRITE,
+	ADIV5_BATCH_AP_POLL,
+} adiv5_batch_op_type_e;
+
+typedef struct adiv5_batch_op {
+	adiv5_batch_op_type_e type;
+	adiv5_access_port_s *ap;
+	uint16_t addr;
+	/* How long in milliseconds a poll may take to see (register & mask) == value */
+	uint16_t timeout;
+	uint32_t mask;
+	uint32_t value;
+	/* Where the result of a read or poll goes once the batch has run */
+	uint32_t *result;
+} adiv5_batch_op_s;
+
+/*
+ * A batch of DP/AP accesses. Where the DP provides batch_run, the accesses are queued and run together
+ * by adiv5_batch_run(), otherwise they are run as they are added.
+ */
+struct adiv5_batch {
+	adiv5_debug_port_s *dp;
+#if CONFIG_BMDA == 1
+	size_t count;
+	adiv5_batch_op_s ops[ADIV5_BATCH_MAX_OPS];
+#endif
+};
+
 /* The following enum is based on the Component Class value table 13-3 of the ADIv5 specification. */
 typedef enum cid_class {
 	cidc_gvc = 0x0,     /* Generic verification component*/
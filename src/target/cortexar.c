@@ -400,6 +400,7 @@ static bool cortexar_halt_and_wait(target_s *target);
 
 static int cortexar_breakwatch_set(target_s *target, breakwatch_s *breakwatch);
 static int cortexar_breakwatch_clear(target_s *target, breakwatch_s *breakwatch);
+static size_t cortexar_breakpoint_kind(target_s *target, target_addr_t addr);
 static void cortexar_config_breakpoint(target_s *target, size_t slot, uint32_t mode, target_addr_t addr);
 
 bool cortexar_attach(target_s *target);
@@ -856,6 +857,7 @@ static target_s *cortexar_probe(
 	target->regs_write = cortexar_regs_write;
 	target->reg_read = cortexar_reg_read;
 	target->reg_write = cortexar_reg_write;
+	target->pc_regnum = CORTEX_REG_PC;
 	target->regs_size = sizeof(uint32_t) * CORTEXAR_GENERAL_REG_COUNT;
 
 	if (core_has_fpu) {
@@ -870,6 +872,7 @@ static target_s *cortexar_probe(
 
 	target->breakwatch_set = cortexar_breakwatch_set;
 	target->breakwatch_clear = cortexar_breakwatch_clear;
+	target->breakpoint_kind = cortexar_breakpoint_kind;
 
 	/* Check cache type */
 	const uint32_t cache_type = cortex_dbg_read32(target, CORTEXAR_CTR);
@@ -1700,6 +1703,14 @@ static int cortexar_breakwatch_set(target_s *const target, breakwatch_s *const b
 	}
 }
 
+static size_t cortexar_breakpoint_kind(target_s *const target, const target_addr_t addr)
+{
+	(void)addr;
+	const cortexar_priv_s *const priv = (cortexar_priv_s *)target->priv;
+	/* Go by the instruction set the core is currently executing, as the address alone doesn't tell us */
+	return (priv->core_regs.cpsr & CORTEXAR_CPSR_THUMB) ? 2U : 4U;
+}
+
 static int cortexar_breakwatch_clear(target_s *const target, breakwatch_s *const breakwatch)
 {
 	cortexar_priv_s *const priv = (cortexar_priv_s *)target->priv;
@@ -41,6 +41,7 @@
 #include "gdb_reg.h"
 #include "command.h"
 #include "gdb_packet.h"
+#include "gdb_if.h"
 #include "semihosting.h"
 #include "platform.h"
 #include "maths_utils.h"
@@ -76,6 +77,7 @@ static int cortexm_breakwatch_clear(target_s *target, breakwatch_s *breakwatch);
 static target_addr_t cortexm_check_watch(target_s *target);
 
 static bool cortexm_hostio_request(target_s *target);
+static bool cortexm_mem_crc32(target_s *target, uint32_t *result, target_addr_t base, size_t len);
 
 typedef struct cortexm_priv {
 	cortex_priv_s base;
@@ -87,8 +89,28 @@ typedef struct cortexm_priv {
 	uint8_t flash_patch_revision;
 	/* Copy of DEMCR for vector-catch */
 	uint32_t demcr;
+	/* Set if running the CRC32 stub on this core failed, so we don't keep trying */
+	bool crc32_stub_failed;
 } cortexm_priv_s;
 
+static const uint16_t cortexm_crc32_stub[] = {
+#include "flashstub/crc32.stub"
+};
+
+/* How much memory to have the CRC32 stub process per run, keeping each well inside the stub timeout */
+#define CORTEXM_CRC32_STUB_CHUNK 65536U
+/*
+ * How much RAM the CRC32 stub borrows - the stub itself, followed by a stack. The stub doesn't use the stack,
+ * but a fault or NMI while it runs would, and must not be allowed to stack over anything else
+ */
+#define CORTEXM_CRC32_STUB_STACK  128U
+#define CORTEXM_CRC32_STUB_WINDOW (((sizeof(cortexm_crc32_stub) + 7U) & ~7U) + CORTEXM_CRC32_STUB_STACK)
+/* PRIMASK lives in the bottom byte of the special register, setting it masks all configurable interrupts */
+#define CORTEXM_SPECIAL_PRIMASK 1U
+
+/* How long in milliseconds to give the core to halt when attaching */
+#define CORTEXM_ATTACH_HALT_TIMEOUT 250U
+
 /* Register number tables */
 static const uint8_t regnum_cortex_m[CORTEXM_GENERAL_REG_COUNT] = {
 	0U, 1U, 2U, 3U, 4U, 5U, 6U, 7U, 8U, 9U, 10U, 11U, 12U, 13U, 14U, 15U, /* r0-r15 */
@@ -111,6 +133,17 @@ static const uint8_t regnum_cortex_mf[CORTEX_FLOAT_REG_COUNT] = {
 	0x58U, 0x59U, 0x5aU, 0x5bU, 0x5cU, 0x5dU, 0x5eU, 0x5fU, /* s24-s31 */
 };
 
+/*
+ * Registers expedited in stop replies - sp, lr, pc and xpsr, which is what GDB needs to
+ * unwind the first frame. Note that xpsr is regnum 25 in the target description.
+ */
+static const target_expedite_reg_s cortexm_expedite_regs[] = {
+	{0x0dU, CORTEX_REG_SP},
+	{0x0eU, CORTEX_REG_LR},
+	{0x0fU, CORTEX_REG_PC},
+	{0x19U, CORTEX_REG_XPSR},
+};
+
 /*
  * Fields for Cortex-M special purpose registers, used in the generation of GDB's target description XML.
  * The general purpose registers r0-r12 and the vector floating point registers d0-d15 all follow a very
@@ -311,6 +344,12 @@ bool cortexm_probe(adiv5_access_port_s *ap)
 	target->regs_write = cortexm_regs_write;
 	target->reg_read = cortexm_reg_read;
 	target->reg_write = cortexm_reg_write;
+	/* All the registers in the blob are 32-bit and in reg_read() order, so they can be cached */
+	target->reg_cache_stride = sizeof(uint32_t);
+	target->expedite_regs = cortexm_expedite_regs;
+	target->expedite_regs_count = ARRAY_LENGTH(cortexm_expedite_regs);
+	target->pc_regnum = CORTEX_REG_PC;
+	target->mem_crc32 = cortexm_mem_crc32;
 
 	target->reset = cortexm_reset;
 	target->halt_request = cortexm_halt_request;
@@ -512,6 +551,13 @@ bool cortexm_probe(adiv5_access_port_s *ap)
 	return true;
 }
 
+enum {
+	DB_DHCSR,
+	DB_DCRSR,
+	DB_DCRDR,
+	DB_DEMCR
+};
+
 bool cortexm_attach(target_s *target)
 {
 	adiv5_access_port_s *ap = cortex_ap(target);
@@ -522,8 +568,15 @@ bool cortexm_attach(target_s *target)
 	/* Clear any pending fault condition (and switch to this core) */
 	target_check_error(target);
 
-	/* Try to halt the core, and then check that it worked (which also resets the halt reason) */
+	/* Try to halt the core, giving it a moment to do so - a probe that can run batches does the waiting itself */
 	target_halt_request(target);
+	adi_ap_mem_access_setup(ap, CORTEXM_DHCSR, ALIGN_32BIT);
+	adiv5_batch_s batch = {.dp = ap->dp};
+	uint32_t dhcsr = 0U;
+	adiv5_batch_ap_poll(&batch, ap, ADIV5_AP_DB(DB_DHCSR), CORTEXM_DHCSR_S_HALT, CORTEXM_DHCSR_S_HALT,
+		CORTEXM_ATTACH_HALT_TIMEOUT, &dhcsr);
+	adiv5_batch_run(&batch);
+	/* Then check that it worked (which also resets the halt reason) */
 	const target_halt_reason_e halt_result = target_halt_poll(target, NULL);
 	/* If we failed to halt the target somehow, bail */
 	if (halt_result == TARGET_HALT_ERROR || halt_result == TARGET_HALT_RUNNING)
@@ -606,13 +659,6 @@ void cortexm_detach(target_s *target)
 	target_mem32_write32(target, CORTEXM_DHCSR, CORTEXM_DHCSR_DBGKEY);
 }
 
-enum {
-	DB_DHCSR,
-	DB_DCRSR,
-	DB_DCRDR,
-	DB_DEMCR
-};
-
 static void cortexm_regs_read(target_s *const target, void *const data)
 {
 	uint32_t *const regs = data;
@@ -639,27 +685,30 @@ static void cortexm_regs_read(target_s *const target, void *const data)
 		adi_ap_mem_access_setup(ap, CORTEXM_DHCSR, ALIGN_32BIT);
 		adi_ap_banked_access_setup(ap);
 
+		/* Batch the register accesses up so probes that can run them together get to do so */
+		adiv5_batch_s batch = {.dp = ap->dp};
 		/* Walk the regnum_cortex_m array, reading the registers it specifies */
 		for (size_t i = 0U; i < CORTEXM_GENERAL_REG_COUNT; ++i) {
-			adiv5_dp_write(ap->dp, ADIV5_AP_DB(DB_DCRSR), regnum_cortex_m[i]);
-			regs[i] = adiv5_dp_read(ap->dp, ADIV5_AP_DB(DB_DCRDR));
+			adiv5_batch_dp_write(&batch, ADIV5_AP_DB(DB_DCRSR), regnum_cortex_m[i]);
+			adiv5_batch_dp_read(&batch, ADIV5_AP_DB(DB_DCRDR), &regs[i]);
 		}
 		size_t offset = CORTEXM_GENERAL_REG_COUNT;
 		/* If the core implements TrustZone, pull out the extra stack pointers */
 		if (target->target_options & CORTEXM_TOPT_TRUSTZONE) {
 			for (size_t i = 0U; i < CORTEXM_TRUSTZONE_REG_COUNT; ++i) {
-				adiv5_dp_write(ap->dp, ADIV5_AP_DB(DB_DCRSR), regnum_cortex_m_trustzone[i]);
-				regs[offset + i] = adiv5_dp_read(ap->dp, ADIV5_AP_DB(DB_DCRDR));
+				adiv5_batch_dp_write(&batch, ADIV5_AP_DB(DB_DCRSR), regnum_cortex_m_trustzone[i]);
+				adiv5_batch_dp_read(&batch, ADIV5_AP_DB(DB_DCRDR), &regs[offset + i]);
 			}
 			offset += CORTEXM_TRUSTZONE_REG_COUNT;
 		}
 		/* If the core has a FPU, also walk the regnum_cortex_mf array */
 		if (target->target_options & CORTEXM_TOPT_FLAVOUR_FLOAT) {
 			for (size_t i = 0U; i < CORTEX_FLOAT_REG_COUNT; ++i) {
-				adiv5_dp_write(ap->dp, ADIV5_AP_DB(DB_DCRSR), regnum_cortex_mf[i]);
-				regs[offset + i] = adiv5_dp_read(ap->dp, ADIV5_AP_DB(DB_DCRDR));
+				adiv5_batch_dp_write(&batch, ADIV5_AP_DB(DB_DCRSR), regnum_cortex_mf[i]);
+				adiv5_batch_dp_read(&batch, ADIV5_AP_DB(DB_DCRDR), &regs[offset + i]);
 			}
 		}
+		adiv5_batch_run(&batch);
 #if CONFIG_BMDA == 1
 	}
 #endif
@@ -689,27 +738,31 @@ static void cortexm_regs_write(target_s *const target, const void *const data)
 		adi_ap_mem_access_setup(ap, CORTEXM_DHCSR, ALIGN_32BIT);
 		adi_ap_banked_access_setup(ap);
 
+		/* Batch the register accesses up so probes that can run them together get to do so */
+		adiv5_batch_s batch = {.dp = ap->dp};
 		/* Walk the regnum_cortex_m array, writing the registers it specifies */
 		for (size_t i = 0U; i < CORTEXM_GENERAL_REG_COUNT; ++i) {
-			adiv5_dp_write(ap->dp, ADIV5_AP_DB(DB_DCRDR), regs[i]);
-			adiv5_dp_write(ap->dp, ADIV5_AP_DB(DB_DCRSR), CORTEXM_DCRSR_REG_WRITE | regnum_cortex_m[i]);
+			adiv5_batch_dp_write(&batch, ADIV5_AP_DB(DB_DCRDR), regs[i]);
+			adiv5_batch_dp_write(&batch, ADIV5_AP_DB(DB_DCRSR), CORTEXM_DCRSR_REG_WRITE | regnum_cortex_m[i]);
 		}
 		size_t offset = CORTEXM_GENERAL_REG_COUNT;
 		/* If the core implements TrustZone, write in the extra stack pointers */
 		if (target->target_options & CORTEXM_TOPT_TRUSTZONE) {
 			for (size_t i = 0U; i < CORTEXM_TRUSTZONE_REG_COUNT; ++i) {
-				adiv5_dp_write(ap->dp, ADIV5_AP_DB(DB_DCRDR), regs[offset + i]);
-				adiv5_dp_write(ap->dp, ADIV5_AP_DB(DB_DCRSR), CORTEXM_DCRSR_REG_WRITE | regnum_cortex_m_trustzone[i]);
+				adiv5_batch_dp_write(&batch, ADIV5_AP_DB(DB_DCRDR), regs[offset + i]);
+				adiv5_batch_dp_write(
+					&batch, ADIV5_AP_DB(DB_DCRSR), CORTEXM_DCRSR_REG_WRITE | regnum_cortex_m_trustzone[i]);
 			}
 			offset += CORTEXM_TRUSTZONE_REG_COUNT;
 		}
 		/* If the core has a FPU, also walk the regnum_cortex_mf array */
 		if (target->target_options & CORTEXM_TOPT_FLAVOUR_FLOAT) {
 			for (size_t i = 0U; i < CORTEX_FLOAT_REG_COUNT; ++i) {
-				adiv5_dp_write(ap->dp, ADIV5_AP_DB(DB_DCRDR), regs[offset + i]);
-				adiv5_dp_write(ap->dp, ADIV5_AP_DB(DB_DCRSR), CORTEXM_DCRSR_REG_WRITE | regnum_cortex_mf[i]);
+				adiv5_batch_dp_write(&batch, ADIV5_AP_DB(DB_DCRDR), regs[offset + i]);
+				adiv5_batch_dp_write(&batch, ADIV5_AP_DB(DB_DCRSR), CORTEXM_DCRSR_REG_WRITE | regnum_cortex_mf[i]);
 			}
 		}
+		adiv5_batch_run(&batch);
 #if CONFIG_BMDA == 1
 	}
 #endif
@@ -835,6 +888,13 @@ static target_halt_reason_e cortexm_halt_poll(target_s *target, target_addr64_t
 {
 	cortexm_priv_s *priv = target->priv;
 
+#if CONFIG_BMDA == 1
+	/* If the probe can watch DHCSR for us, leave the target alone until it says the core has halted */
+	adiv5_access_port_s *const ap = cortex_ap(target);
+	if (ap->dp->halt_watch && !ap->dp->halt_watch(ap, CORTEXM_DHCSR, CORTEXM_DHCSR_S_HALT, CORTEXM_DHCSR_S_HALT))
+		return TARGET_HALT_RUNNING;
+#endif
+
 	volatile uint32_t dhcsr = 0;
 	TRY (EXCEPTION_ALL) {
 		/* If this times out because the target is in WFI then the target is still running. */
@@ -993,18 +1053,11 @@ static int cortexm_fault_unwind(target_s *target)
 	return 0;
 }
 
-bool cortexm_run_stub(target_s *target, uint32_t loadaddr, uint32_t r0, uint32_t r1, uint32_t r2, uint32_t r3)
+/* Run a stub on the core with the given register state, returning its exit code as cortexm_run_stub() does */
+static bool cortexm_run_stub_regs(target_s *const target, const uint32_t *const regs)
 {
-	uint32_t regs[CORTEXM_MAX_REG_COUNT] = {0};
-
-	regs[0] = r0;
-	regs[1] = r1;
-	regs[2] = r2;
-	regs[3] = r3;
-	regs[15] = loadaddr;
-	regs[CORTEX_REG_XPSR] = CORTEXM_XPSR_THUMB;
-	regs[19] = 0;
-
+	/* The stub clobbers the registers behind the register cache's back, so drop it */
+	target_reg_cache_invalidate(target);
 	cortexm_regs_write(target, regs);
 
 	if (target_check_error(target))
@@ -1017,6 +1070,7 @@ bool cortexm_run_stub(target_s *target, uint32_t loadaddr, uint32_t r0, uint32_t
 	target_regs_read(target, arm_regs_start);
 #endif
 	cortexm_halt_resume(target, 0);
+	target_reg_cache_invalidate(target);
 	platform_timeout_s timeout;
 	platform_timeout_set(&timeout, 5000);
 	while (reason == TARGET_HALT_RUNNING) {
@@ -1050,6 +1104,103 @@ bool cortexm_run_stub(target_s *target, uint32_t loadaddr, uint32_t r0, uint32_t
 	return bkpt_instr & 0xffU;
 }
 
+bool cortexm_run_stub(target_s *target, uint32_t loadaddr, uint32_t r0, uint32_t r1, uint32_t r2, uint32_t r3)
+{
+	uint32_t regs[CORTEXM_MAX_REG_COUNT] = {0};
+
+	regs[0] = r0;
+	regs[1] = r1;
+	regs[2] = r2;
+	regs[3] = r3;
+	regs[15] = loadaddr;
+	regs[CORTEX_REG_XPSR] = CORTEXM_XPSR_THUMB;
+	regs[19] = 0;
+
+	return cortexm_run_stub_regs(target, regs);
+}
+
+/* Pick a RAM region the CRC32 stub can be run from, with room for it and its stack */
+static const target_ram_s *cortexm_crc32_stub_ram(const target_s *const target)
+{
+	for (const target_ram_s *ram = target->ram; ram; ram = ram->next) {
+		if (!ram->data_only && ram->length >= CORTEXM_CRC32_STUB_WINDOW)
+			return ram;
+	}
+	return NULL;
+}
+
+/*
+ * Calculate the CRC32 of a region of memory on the core itself using a small stub run from RAM,
+ * rather than pulling the whole region across the link just to hash it. The RAM the stub occupies
+ * and the core registers are saved and restored around this, and the stub runs with interrupts
+ * masked on a stack of its own, so the program on the target is left as it was found.
+ */
+static bool cortexm_mem_crc32(
+	target_s *const target, uint32_t *const result, const target_addr_t base, const size_t len)
+{
+	cortexm_priv_s *const priv = (cortexm_priv_s *)target->priv;
+	/* Only borrow RAM while the core is halted, and only if there's RAM the stub can run from */
+	const target_ram_s *const ram = cortexm_crc32_stub_ram(target);
+	if (priv->crc32_stub_failed || !ram || !(target_mem32_read32(target, CORTEXM_DHCSR) & CORTEXM_DHCSR_S_HALT))
+		return false;
+	/* If the borrowed RAM is inside the region being checked, let the generic path read it instead */
+	const target_addr_t window_end = ram->start + CORTEXM_CRC32_STUB_WINDOW;
+	if (base < window_end && (ram->start < base || ram->start - base < len))
+		return false;
+
+	uint32_t regs[CORTEXM_MAX_REG_COUNT];
+	uint8_t saved_ram[CORTEXM_CRC32_STUB_WINDOW];
+	target_regs_read(target, regs);
+	if (target_mem32_read(target, saved_ram, ram->start, sizeof(saved_ram)))
+		return false;
+
+	/* Run with interrupts masked so none of the application's handlers run, and a stack at the top of the window */
+	uint32_t stub_regs[CORTEXM_MAX_REG_COUNT] = {0};
+	stub_regs[CORTEX_REG_PC] = ram->start;
+	stub_regs[CORTEX_REG_XPSR] = CORTEXM_XPSR_THUMB;
+	stub_regs[CORTEX_REG_SP] = window_end;
+	stub_regs[CORTEX_REG_MSP] = window_end;
+	stub_regs[CORTEX_REG_PSP] = window_end;
+	stub_regs[CORTEX_REG_SPECIAL] = CORTEXM_SPECIAL_PRIMASK;
+
+	bool success = !target_mem32_write(target, ram->start, cortexm_crc32_stub, sizeof(cortexm_crc32_stub));
+	uint32_t crc = 0xffffffffU;
+	uint32_t last_time = platform_time_ms();
+	/* Running the stub can raise if the core gets lost, so catch that here to be able to clean up */
+	TRY (EXCEPTION_ALL) {
+		for (size_t offset = 0; success && offset < len; offset += CORTEXM_CRC32_STUB_CHUNK) {
+			const uint32_t actual_time = platform_time_ms();
+			if (actual_time > last_time + 1000U) {
+				last_time = actual_time;
+				gdb_if_putchar(0, true);
+			}
+			stub_regs[0] = base + offset;
+			stub_regs[1] = MIN(CORTEXM_CRC32_STUB_CHUNK, len - offset);
+			stub_regs[2] = crc;
+			/* The stub exits with code 1 when done, leaving the CRC so far in r2 */
+			success = cortexm_run_stub_regs(target, stub_regs) &&
+				target_reg_read(target, 2U, &crc, sizeof(crc)) == sizeof(crc);
+		}
+	}
+	CATCH () {
+	default:
+		success = false;
+	}
+
+	/* Put back everything the stub disturbed, whichever way we got here */
+	target_mem32_write(target, ram->start, saved_ram, sizeof(saved_ram));
+	target_regs_write(target, regs);
+	success &= !target_check_error(target);
+
+	if (!success) {
+		DEBUG_WARN("CRC32 stub failed, falling back to reading the memory\n");
+		priv->crc32_stub_failed = true;
+		return false;
+	}
+	*result = crc;
+	return true;
+}
+
 /*
  * The following routines implement hardware breakpoints and watchpoints.
  * The Flash Patch and Breakpoint (FPB) and Data Watch and Trace (DWT)
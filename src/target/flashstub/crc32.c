@@ -0,0 +1,45 @@
+/*
+ * This file is part of the Black Magic Debug project.
+ *
+ * Copyright (C) 2026 1BitSquared <info@1bitsquared.com>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include <stdint.h>
+#include "stub.h"
+
+#define CRC32_POLYNOMIAL 0x04c11db7U
+
+/*
+ * Calculates the MSb-first (MPEG-2 style) CRC32 GDB uses for `compare-sections` over a region
+ * of memory, continuing on from the CRC value given. Rather than returning an error code, this
+ * exits with code 1 to indicate completion and leaves the resulting CRC in r2 for the debugger
+ * to read back.
+ */
+void __attribute__((naked)) crc32_stub(const uint8_t *data, uint32_t len, uint32_t crc)
+{
+	while (len) {
+		crc ^= (uint32_t)*data++ << 24U;
+		for (uint32_t bit = 0; bit < 8U; ++bit) {
+			if (crc & 0x80000000U)
+				crc = (crc << 1U) ^ CRC32_POLYNOMIAL;
+			else
+				crc <<= 1U;
+		}
+		--len;
+	}
+
+	register uint32_t result __asm__("r2") = crc;
+	__asm__("bkpt %0" ::"i"(1), "r"(result));
+}
@@ -53,40 +53,11 @@ static bool onboard_flash_check_error(target_s *target);
 static void onboard_flash_read(target_s *target, void *dest, target_addr64_t src, size_t len);
 static const char *onboard_flash_target_description(target_s *target);
 
-static void onboard_spi_setup_xfer(const uint16_t command, const target_addr32_t address)
-{
-	platform_spi_chip_select(SPI_DEVICE_INT_FLASH | 0x80U);
-
-	/* Set up the instruction */
-	const uint8_t opcode = command & SPI_FLASH_OPCODE_MASK;
-	platform_spi_xfer(SPI_BUS_INTERNAL, opcode);
-
-	if ((command & SPI_FLASH_OPCODE_MODE_MASK) == SPI_FLASH_OPCODE_3B_ADDR) {
-		/* For each byte sent here, we have to manually clean up from the controller with a read */
-		platform_spi_xfer(SPI_BUS_INTERNAL, (address >> 16U) & 0xffU);
-		platform_spi_xfer(SPI_BUS_INTERNAL, (address >> 8U) & 0xffU);
-		platform_spi_xfer(SPI_BUS_INTERNAL, address & 0xffU);
-	}
-
-	const size_t dummy_length = (command & SPI_FLASH_DUMMY_MASK) >> SPI_FLASH_DUMMY_SHIFT;
-	for (size_t i = 0; i < dummy_length; ++i)
-		/* For each byte sent here, we have to manually clean up from the controller with a read */
-		platform_spi_xfer(SPI_BUS_INTERNAL, 0);
-}
-
 void onboard_spi_read(target_s *const target, const uint16_t command, const target_addr32_t address, void *const buffer,
 	const size_t length)
 {
 	onboard_flash_s *const priv = target->priv;
-	/* Setup the transaction */
-	onboard_spi_setup_xfer(command, address);
-	/* Now read back the data that elicited */
-	uint8_t *const data = (uint8_t *const)buffer;
-	for (size_t i = 0; i < length; ++i)
-		/* Do a write to read */
-		data[i] = platform_spi_xfer(SPI_BUS_INTERNAL, 0);
-	/* Deselect the Flash */
-	platform_spi_chip_select(SPI_DEVICE_INT_FLASH);
+	bmp_spi_read(SPI_BUS_INTERNAL, SPI_DEVICE_INT_FLASH, command, address, buffer, length);
 	priv->error_state = flash_ok;
 }
 
@@ -94,24 +65,21 @@ void onboard_spi_write(target_s *const target, const uint16_t command, const tar
 	const void *const buffer, const size_t length)
 {
 	(void)target;
-	/* Setup the transaction */
-	onboard_spi_setup_xfer(command, address);
-	/* Now write out back the data requested */
-	const uint8_t *const data = (const uint8_t *)buffer;
-	for (size_t i = 0; i < length; ++i)
-		/* Do a write to read */
-		platform_spi_xfer(SPI_BUS_INTERNAL, data[i]);
-	/* Deselect the Flash */
-	platform_spi_chip_select(SPI_DEVICE_INT_FLASH);
+	bmp_spi_write(SPI_BUS_INTERNAL, SPI_DEVICE_INT_FLASH, command, address, buffer, length);
 }
 
 void onboard_spi_run_command(target_s *const target, const uint16_t command, const target_addr32_t address)
 {
 	(void)target;
-	/* Setup the transaction */
-	onboard_spi_setup_xfer(command, address);
-	/* Deselect the Flash */
-	platform_spi_chip_select(SPI_DEVICE_INT_FLASH);
+	bmp_spi_run_command(SPI_BUS_INTERNAL, SPI_DEVICE_INT_FLASH, command, address);
+}
+
+static bool onboard_spi_program_page(
+	target_s *const target, const target_addr32_t address, const void *const buffer, const size_t length)
+{
+	(void)target;
+	return bmp_spi_program_page(
+		SPI_BUS_INTERNAL, SPI_DEVICE_INT_FLASH, SPI_FLASH_CMD_PAGE_PROGRAM, address, buffer, length);
 }
 
 static bool onboard_flash_add(target_s *const target)
@@ -132,8 +100,12 @@ static bool onboard_flash_add(target_s *const target)
 		"Found Flash chip w/ ID: 0x%02x 0x%02x 0x%02x\n", flash_id.manufacturer, flash_id.type, flash_id.capacity);
 	target->core = "Windbond";
 	/* Otherwise add it to the providied target */
-	bmp_spi_add_flash(
+	spi_flash_s *const flash = bmp_spi_add_flash(
 		target, 0U, 1U << flash_id.capacity, onboard_spi_read, onboard_spi_write, onboard_spi_run_command);
+	if (!flash)
+		return false;
+	/* The probe can run whole page program cycles itself, so have it do so */
+	flash->program_page = onboard_spi_program_page;
 	return true;
 }
 
@@ -82,6 +82,8 @@ bool riscv32_probe(target_s *const target)
 	target->regs_write = riscv32_regs_write;
 	target->reg_write = riscv32_reg_write;
 	target->reg_read = riscv32_reg_read;
+	/* GDB numbers the program counter after all 32 GPRs, even on 'E' base ISA harts */
+	target->pc_regnum = 32U;
 	target->mem_read = riscv32_mem_read;
 	target->mem_write = riscv32_mem_write;
 
@@ -114,19 +116,32 @@ bool riscv32_probe(target_s *const target)
 	return false;
 }
 
+bool riscv32_hart_regs_read(riscv_hart_s *const hart, uint32_t *const regs, const size_t gprs_count)
+{
+	bool result = true;
+	/* Loop through reading out the GPRs */
+	for (size_t gpr = 0; gpr < gprs_count; ++gpr)
+		result &= riscv_csr_read(hart, RV_GPR_BASE + gpr, &regs[gpr]);
+	/* Special access to grab the program counter that would be executed on resuming the hart */
+	result &= riscv_csr_read(hart, RV_DPC, &regs[gprs_count]);
+	return result;
+}
+
 static void riscv32_regs_read(target_s *const target, void *const data)
 {
 	/* Grab the hart structure and figure out how many registers need reading out */
 	riscv_hart_s *const hart = riscv_hart_struct(target);
 	uint32_t *const regs = (uint32_t *)data;
 	const size_t gprs_count = hart->extensions & RV_ISA_EXT_EMBEDDED ? 16U : 32U;
-	/* Loop through reading out the GPRs */
-	for (size_t gpr = 0; gpr < gprs_count; ++gpr) {
-		// TODO: handle when this fails..
-		riscv_csr_read(hart, RV_GPR_BASE + gpr, &regs[gpr]);
+	/* If the DMI can read them all out in one go, try that first, falling back to doing it here if it fails */
+	riscv_dmi_s *const dmi = hart->dbg_module->dmi_bus;
+	if (dmi->regs_read && dmi->regs_read(hart, regs, gprs_count))
+		return;
+	if (!riscv32_hart_regs_read(hart, regs, gprs_count)) {
+		/* Rather than hand back whatever was left in the buffer, zero the registers out */
+		DEBUG_ERROR("Failed to read the registers of hart %" PRIu32 "\n", hart->hartid);
+		memset(regs, 0, (gprs_count + 1U) * sizeof(*regs));
 	}
-	/* Special access to grab the program counter that would be executed on resuming the hart */
-	riscv_csr_read(hart, RV_DPC, &regs[gprs_count]);
 }
 
 static void riscv32_regs_write(target_s *const target, const void *const data)
@@ -567,6 +582,22 @@ static void riscv32_sysbus_mem_write(
 		riscv32_sysbus_mem_adjusted_write(hart, address, data, remainder, native_access_width, native_access_length);
 }
 
+void riscv32_hart_mem_read(riscv_hart_s *const hart, void *const dest, const target_addr_t src, const size_t len)
+{
+	if (hart->flags & RV_HART_FLAG_MEMORY_SYSBUS)
+		riscv32_sysbus_mem_read(hart, dest, src, len);
+	else
+		riscv32_abstract_mem_read(hart, dest, src, len);
+}
+
+void riscv32_hart_mem_write(riscv_hart_s *const hart, const target_addr_t dest, const void *const src, const size_t len)
+{
+	if (hart->flags & RV_HART_FLAG_MEMORY_SYSBUS)
+		riscv32_sysbus_mem_write(hart, dest, src, len);
+	else
+		riscv32_abstract_mem_write(hart, dest, src, len);
+}
+
 void riscv32_mem_read(target_s *const target, void *const dest, const target_addr64_t src, const size_t len)
 {
 	/* If we're asked to do a 0-byte read, do nothing */
@@ -576,10 +607,12 @@ void riscv32_mem_read(target_s *const target, void *const dest, const target_add
 	}
 
 	riscv_hart_s *const hart = riscv_hart_struct(target);
-	if (hart->flags & RV_HART_FLAG_MEMORY_SYSBUS)
-		riscv32_sysbus_mem_read(hart, dest, src, len);
+	/* If the DMI can run the whole access itself, have it do so */
+	riscv_dmi_s *const dmi = hart->dbg_module->dmi_bus;
+	if (dmi->mem_read)
+		dmi->mem_read(hart, dest, src, len);
 	else
-		riscv32_abstract_mem_read(hart, dest, src, len);
+		riscv32_hart_mem_read(hart, dest, src, len);
 
 #if ENABLE_DEBUG
 	DEBUG_PROTO("%s: @ %08" PRIx32 " len %zu:", __func__, (uint32_t)src, len);
@@ -618,10 +651,12 @@ void riscv32_mem_write(target_s *const target, const target_addr64_t dest, const
 		return;
 
 	riscv_hart_s *const hart = riscv_hart_struct(target);
-	if (hart->flags & RV_HART_FLAG_MEMORY_SYSBUS)
-		riscv32_sysbus_mem_write(hart, dest, src, len);
+	/* If the DMI can run the whole access itself, have it do so */
+	riscv_dmi_s *const dmi = hart->dbg_module->dmi_bus;
+	if (dmi->mem_write)
+		dmi->mem_write(hart, dest, src, len);
 	else
-		riscv32_abstract_mem_write(hart, dest, src, len);
+		riscv32_hart_mem_write(hart, dest, src, len);
 }
 
 /*
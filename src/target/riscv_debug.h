@@ -103,6 +103,7 @@ typedef enum riscv_match_size {
 #define RV_HART_FLAG_DATA_GPR_ONLY      (1U << 5U) /* Hart supports Abstract Data commands for GPRs only */
 
 typedef struct riscv_dmi riscv_dmi_s;
+typedef struct riscv_hart riscv_hart_s;
 
 /* This structure represents a version-agnostic Debug Module Interface on a RISC-V device */
 struct riscv_dmi {
@@ -120,6 +121,13 @@ struct riscv_dmi {
 	void (*quiesce)(target_s *target);
 	bool (*read)(riscv_dmi_s *dmi, uint32_t address, uint32_t *value);
 	bool (*write)(riscv_dmi_s *dmi, uint32_t address, uint32_t value);
+	/*
+	 * Optional whole-operation accesses on 32-bit Harts, used in place of running the access loops
+	 * over read and write when the DMI can do better (such as having the probe run them for BMDA)
+	 */
+	void (*mem_read)(riscv_hart_s *hart, void *dest, target_addr_t src, size_t len);
+	void (*mem_write)(riscv_hart_s *hart, target_addr_t dest, const void *src, size_t len);
+	bool (*regs_read)(riscv_hart_s *hart, uint32_t *regs, size_t gprs_count);
 };
 
 /* This structure represent a DMI bus that is accessed via an ADI AP */
@@ -140,7 +148,7 @@ typedef struct riscv_dm {
 #define RV_TRIGGERS_MAX 8U
 
 /* This represents a specific Hart on a DM */
-typedef struct riscv_hart {
+struct riscv_hart {
 	riscv_dm_s *dbg_module;
 	uint32_t hart_idx;
 	uint32_t hartsel;
@@ -160,7 +168,7 @@ typedef struct riscv_hart {
 
 	uint32_t triggers;
 	uint32_t trigger_uses[RV_TRIGGERS_MAX];
-} riscv_hart_s;
+};
 
 #define RV_STATUS_VERSION_MASK 0x0000000fU
 
@@ -327,5 +335,9 @@ uint32_t riscv32_pack_data(const void *src, uint8_t access_width);
 
 void riscv32_mem_read(target_s *target, void *dest, target_addr64_t src, size_t len);
 void riscv32_mem_write(target_s *target, target_addr64_t dest, const void *src, size_t len);
+/* Hart-level accesses behind the above and riscv32 register reads, also used by the probe to run remote requests */
+void riscv32_hart_mem_read(riscv_hart_s *hart, void *dest, target_addr_t src, size_t len);
+void riscv32_hart_mem_write(riscv_hart_s *hart, target_addr_t dest, const void *src, size_t len);
+bool riscv32_hart_regs_read(riscv_hart_s *hart, uint32_t *regs, size_t gprs_count);
 
 #endif /*TARGET_RISCV_DEBUG_H*/
@@ -96,6 +96,29 @@ void bmp_spi_run_command(
 	/* Deselect the Flash */
 	platform_spi_chip_select(device);
 }
+
+static uint8_t bmp_spi_bus_read_status(const spi_bus_e bus, const uint8_t device)
+{
+	uint8_t status = 0;
+	/* Read the main status register of the Flash */
+	bmp_spi_read(bus, device, SPI_FLASH_CMD_READ_STATUS, 0U, &status, sizeof(status));
+	return status;
+}
+
+bool bmp_spi_program_page(const spi_bus_e bus, const uint8_t device, const uint16_t command,
+	const target_addr32_t address, const void *const buffer, const size_t length)
+{
+	/* Tell the Flash to enable writing, and check that it did */
+	bmp_spi_run_command(bus, device, SPI_FLASH_CMD_WRITE_ENABLE, 0U);
+	if (!(bmp_spi_bus_read_status(bus, device) & SPI_FLASH_STATUS_WRITE_ENABLED))
+		return false;
+
+	/* Program the page and wait for the Flash to finish with it */
+	bmp_spi_write(bus, device, command, address, buffer, length);
+	while (bmp_spi_bus_read_status(bus, device) & SPI_FLASH_STATUS_BUSY)
+		continue;
+	return true;
+}
 #endif
 
 static inline uint8_t bmp_spi_read_status(target_s *const target, const spi_flash_s *const flash)
@@ -191,11 +214,18 @@ static bool bmp_spi_flash_write(
 	const target_addr_t begin = dest - flash->start;
 	const char *const buffer = (const char *)src;
 	for (size_t offset = 0; offset < length; offset += spi_flash->page_size) {
+		const size_t amount = MIN(length - offset, spi_flash->page_size);
+		/* If the Flash can take care of the whole page program cycle in one go, let it */
+		if (spi_flash->program_page) {
+			if (!spi_flash->program_page(target, begin + offset, buffer + offset, amount))
+				return false;
+			continue;
+		}
+
 		spi_flash->run_command(target, SPI_FLASH_CMD_WRITE_ENABLE, 0U);
 		if (!(bmp_spi_read_status(target, spi_flash) & SPI_FLASH_STATUS_WRITE_ENABLED))
 			return false;
 
-		const size_t amount = MIN(length - offset, spi_flash->page_size);
 		spi_flash->write(target, SPI_FLASH_CMD_PAGE_PROGRAM, begin + offset, buffer + offset, amount);
 		while (bmp_spi_read_status(target, spi_flash) & SPI_FLASH_STATUS_BUSY)
 			continue;
@@ -76,6 +76,7 @@ typedef void (*spi_read_func)(target_s *target, uint16_t command, target_addr32_
 typedef void (*spi_write_func)(
 	target_s *target, uint16_t command, target_addr32_t address, const void *buffer, size_t length);
 typedef void (*spi_run_command_func)(target_s *target, uint16_t command, target_addr32_t address);
+typedef bool (*spi_program_page_func)(target_s *target, target_addr32_t address, const void *buffer, size_t length);
 
 typedef struct spi_flash {
 	target_flash_s flash;
@@ -85,6 +86,8 @@ typedef struct spi_flash {
 	spi_read_func read;
 	spi_write_func write;
 	spi_run_command_func run_command;
+	/* Optional, enables writes then programs and waits out a whole page in one go when provided */
+	spi_program_page_func program_page;
 } spi_flash_s;
 
 void bmp_spi_read(
@@ -92,6 +95,8 @@ void bmp_spi_read(
 void bmp_spi_write(
 	spi_bus_e bus, uint8_t device, uint16_t command, target_addr32_t address, const void *buffer, size_t length);
 void bmp_spi_run_command(spi_bus_e bus, uint8_t device, uint16_t command, target_addr32_t address);
+bool bmp_spi_program_page(
+	spi_bus_e bus, uint8_t device, uint16_t command, target_addr32_t address, const void *buffer, size_t length);
 
 spi_flash_s *bmp_spi_add_flash(target_s *target, target_addr_t begin, size_t length, spi_read_func spi_read,
 	spi_write_func spi_write, spi_run_command_func spi_run_command);
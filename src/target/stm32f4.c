@@ -451,7 +451,7 @@ static bool stm32f4_attach(target_s *const target)
 		}
 		target_add_ram32(target, STM32F7_ITCM_RAM_BASE, 0x4000U); /* 16kiB ITCM RAM */
 		/* On STM32F7, DTCM and AHB SRAM are contiguous */
-		target_add_ram32(target, STM32F7_DTCM_RAM_BASE, dtcm_size);
+		target_add_data_ram32(target, STM32F7_DTCM_RAM_BASE, dtcm_size);
 		target_add_ram32(target, STM32F7_DTCM_RAM_BASE + dtcm_size, ahbsram_size);
 
 		if (dual_bank) {
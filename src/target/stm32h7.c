@@ -327,8 +327,8 @@ bool stm32h7_probe(target_s *const target)
 	stm32h7_configure_wdts(target);
 
 	/* Build the RAM map */
-	target_add_ram32(target, 0x00000000, 0x10000); /* ITCM RAM,   64 KiB */
-	target_add_ram32(target, 0x20000000, 0x20000); /* DTCM RAM,  128 KiB */
+	target_add_ram32(target, 0x00000000, 0x10000);      /* ITCM RAM,   64 KiB */
+	target_add_data_ram32(target, 0x20000000, 0x20000); /* DTCM RAM,  128 KiB */
 	switch (target->part_id) {
 	case ID_STM32H72x: {
 		/* Table 6. Memory map and default device memory area attributes RM0468, pg133 */
@@ -22,6 +22,7 @@
 #include "target_internal.h"
 #include "gdb_packet.h"
 #include "command.h"
+#include "hex_utils.h"
 
 #include <stdarg.h>
 #include <assert.h>
@@ -40,8 +41,16 @@
 #endif
 
 target_s *target_list = NULL;
+/* Called once the target list has been freed so higher layers can drop their references to the targets */
+static void (*target_list_free_callback)(void) = NULL;
 
 #define FLASH_WRITE_BUFFER_CEILING 1024U
+/* How much target memory target_mem32_search() reads at a time - BMDA can afford (and benefits from) bigger reads */
+#if CONFIG_BMDA == 1
+#define TARGET_SEARCH_BLOCK_SIZE 16384U
+#else
+#define TARGET_SEARCH_BLOCK_SIZE 1024U
+#endif
 
 static bool target_cmd_mass_erase(target_s *target, int argc, const char **argv);
 static bool target_cmd_range_erase(target_s *target, int argc, const char **argv);
@@ -95,8 +104,25 @@ size_t target_foreach(void (*callback)(size_t index, target_s *target, void *con
 	return idx;
 }
 
+static void target_xml_free(target_xml_s *const xml)
+{
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wcast-qual"
+	free((void *)xml->data);
+#pragma GCC diagnostic pop
+	xml->data = NULL;
+	xml->length = 0U;
+}
+
+void target_xml_release(target_s *const target)
+{
+	target_xml_free(&target->mem_map_xml);
+	target_xml_free(&target->regs_description_xml);
+}
+
 void target_ram_map_free(target_s *target)
 {
+	target_xml_free(&target->mem_map_xml);
 	while (target->ram) {
 		target_ram_s *next = target->ram->next;
 		free(target->ram);
@@ -106,6 +132,7 @@ void target_ram_map_free(target_s *target)
 
 void target_flash_map_free(target_s *target)
 {
+	target_xml_free(&target->mem_map_xml);
 	while (target->flash) {
 		target_flash_s *next = target->flash->next;
 		if (target->flash->buf)
@@ -123,6 +150,8 @@ void target_mem_map_free(target_s *target)
 
 void target_list_free(void)
 {
+	/* The cache refers to targets by pointer, so must not outlive them */
+	target_mem_cache_invalidate();
 	target_s *volatile target = target_list;
 	while (target) {
 		target_s *next_target = target->next;
@@ -146,6 +175,8 @@ void target_list_free(void)
 			target->commands = tc;
 		}
 		free(target->target_storage);
+		free(target->reg_cache);
+		target_xml_free(&target->regs_description_xml);
 		target_mem_map_free(target);
 		while (target->bw_list) {
 			void *next = target->bw_list->next;
@@ -156,6 +187,13 @@ void target_list_free(void)
 		target = next_target;
 	}
 	target_list = NULL;
+	if (target_list_free_callback)
+		target_list_free_callback();
+}
+
+void target_list_set_free_callback(void (*const callback)(void))
+{
+	target_list_free_callback = callback;
 }
 
 void target_add_commands(target_s *target, const command_s *cmds, const char *name)
@@ -195,6 +233,10 @@ target_s *target_attach(target_s *target, target_controller_s *controller)
 		target->tc->destroy_callback(target->tc, target);
 
 	target->tc = controller;
+	target_reg_cache_invalidate(target);
+	target_mem_cache_invalidate();
+	/* The register description can depend on what attaching finds out about the target, so rebuild it */
+	target_xml_free(&target->regs_description_xml);
 	platform_target_clk_output_enable(true);
 	DEBUG_TARGET("Attaching to target..\n");
 
@@ -224,8 +266,18 @@ void target_add_ram64(target_s *const target, const target_addr64_t start, const
 
 	ram->start = start;
 	ram->length = len;
+	ram->data_only = false;
 	ram->next = target->ram;
 	target->ram = ram;
+	target_xml_free(&target->mem_map_xml);
+}
+
+void target_add_data_ram32(target_s *const target, const target_addr32_t start, const uint32_t len)
+{
+	target_add_ram64(target, start, len);
+	/* target_add_ram64() prepends the new region, so if it succeeded it's at the head of the list */
+	if (target->ram && target->ram->start == start && target->ram->length == len)
+		target->ram->data_only = true;
 }
 
 void target_add_flash(target_s *target, target_flash_s *flash)
@@ -245,6 +297,7 @@ void target_add_flash(target_s *target, target_flash_s *flash)
 	flash->t = target;
 	flash->next = target->flash;
 	target->flash = flash;
+	target_xml_free(&target->mem_map_xml);
 }
 
 bool target_enter_flash_mode_stub(target_s *target)
@@ -253,35 +306,56 @@ bool target_enter_flash_mode_stub(target_s *target)
 	return true;
 }
 
-static ssize_t map_ram(char *buf, size_t len, target_ram_s *ram)
+/* The map_* functions append to buf at offset, returning how much they would add even if it doesn't all fit */
+static size_t map_ram(char *const buf, const size_t len, const size_t offset, const target_ram_s *const ram)
 {
-	return snprintf(buf, len, "<memory type=\"ram\" start=\"0x%08" PRIx32 "\" length=\"0x%" PRIx32 "\"/>", ram->start,
-		(uint32_t)ram->length);
+	return snprintf(offset < len ? buf + offset : NULL, offset < len ? len - offset : 0U,
+		"<memory type=\"ram\" start=\"0x%08" PRIx32 "\" length=\"0x%" PRIx32 "\"/>", ram->start, (uint32_t)ram->length);
 }
 
-static ssize_t map_flash(char *buf, size_t len, target_flash_s *flash)
+static size_t map_flash(char *const buf, const size_t len, const size_t offset, const target_flash_s *const flash)
 {
-	ssize_t offset = 0;
-	offset += snprintf(&buf[offset], len - offset,
-		"<memory type=\"flash\" start=\"0x%08" PRIx32 "\" length=\"0x%" PRIx32 "\">", flash->start,
-		(uint32_t)flash->length);
-	offset += snprintf(buf + offset, len - offset, "<property name=\"blocksize\">0x%" PRIx32 "</property></memory>",
-		(uint32_t)flash->blocksize);
-	return offset;
+	return snprintf(offset < len ? buf + offset : NULL, offset < len ? len - offset : 0U,
+		"<memory type=\"flash\" start=\"0x%08" PRIx32 "\" length=\"0x%" PRIx32 "\">"
+		"<property name=\"blocksize\">0x%" PRIx32 "</property></memory>",
+		flash->start, (uint32_t)flash->length, (uint32_t)flash->blocksize);
 }
 
-bool target_mem_map(target_s *target, char *tmp, size_t len)
+static size_t map_text(char *const buf, const size_t len, const size_t offset, const char *const text)
 {
-	size_t offset = 0;
-	offset = snprintf(tmp + offset, len - offset, "<memory-map>");
+	return snprintf(offset < len ? buf + offset : NULL, offset < len ? len - offset : 0U, "%s", text);
+}
+
+/* Build the memory map into buf, returning its full length so a first call with no buffer can size it */
+static size_t target_mem_map_build(target_s *const target, char *const buf, const size_t len)
+{
+	size_t offset = map_text(buf, len, 0U, "<memory-map>");
 	/* Map each defined RAM */
-	for (target_ram_s *ram = target->ram; ram; ram = ram->next)
-		offset += map_ram(tmp + offset, len - offset, ram);
+	for (const target_ram_s *ram = target->ram; ram; ram = ram->next)
+		offset += map_ram(buf, len, offset, ram);
 	/* Map each defined Flash */
-	for (target_flash_s *flash = target->flash; flash; flash = flash->next)
-		offset += map_flash(tmp + offset, len - offset, flash);
-	offset += snprintf(tmp + offset, len - offset, "</memory-map>");
-	return offset < len - 1U;
+	for (const target_flash_s *flash = target->flash; flash; flash = flash->next)
+		offset += map_flash(buf, len, offset, flash);
+	offset += map_text(buf, len, offset, "</memory-map>");
+	return offset;
+}
+
+const char *target_mem_map(target_s *const target, size_t *const length)
+{
+	target_xml_s *const xml = &target->mem_map_xml;
+	if (!xml->data) {
+		const size_t map_length = target_mem_map_build(target, NULL, 0U);
+		char *const map = malloc(map_length + 1U);
+		if (!map) { /* malloc failed: heap exhaustion */
+			DEBUG_ERROR("malloc: failed in %s\n", __func__);
+			return NULL;
+		}
+		target_mem_map_build(target, map, map_length + 1U);
+		xml->data = map;
+		xml->length = map_length;
+	}
+	*length = xml->length;
+	return xml->data;
 }
 
 void target_print_progress(platform_timeout_s *const timeout)
@@ -296,6 +370,10 @@ void target_print_progress(platform_timeout_s *const timeout)
 void target_detach(target_s *target)
 {
 	DEBUG_TARGET("Detaching from target\n");
+	target_reg_cache_invalidate(target);
+	target_mem_cache_invalidate();
+	/* GDB asks for these again on the next attach, so there is no point holding on to them */
+	target_xml_release(target);
 	if (target->detach)
 		target->detach(target);
 	platform_target_clk_output_enable(false);
@@ -350,11 +428,190 @@ bool target_mem64_write(target_s *const target, const target_addr64_t dest, cons
 		return false;
 	}
 	/* Otherwise if the target defines a memory write function, call that instead and check for errors */
-	if (target->mem_write)
+	if (target->mem_write) {
+		/* The write may land in memory mapped core registers, or in a stack frame the registers get unwound from */
+		target_reg_cache_invalidate(target);
+		target_mem_cache_invalidate();
 		target->mem_write(target, dest, src, len);
+	}
 	return target_check_error(target);
 }
 
+/*
+ * GDB reads memory in lots of small, mostly adjacent chunks when it walks the stack, prints structures
+ * or disassembles, and each of those would otherwise cost a full round trip to the target. To avoid that,
+ * reads made on GDB's behalf are served from a small cache of aligned blocks. Only memory the target
+ * describes as RAM or Flash is cached so reads of peripherals always go to the target, and the cache is
+ * dropped whenever memory might change behind our back - on resume, reset, memory writes and Flash operations.
+ */
+#if CONFIG_BMDA == 1
+#define TARGET_MEM_CACHE_BLOCK_SIZE  1024U
+#define TARGET_MEM_CACHE_BLOCK_COUNT 8U
+#else
+#define TARGET_MEM_CACHE_BLOCK_SIZE  256U
+#define TARGET_MEM_CACHE_BLOCK_COUNT 2U
+#endif
+
+typedef struct target_mem_cache_block {
+	const target_s *target; /* Target the block was read from, NULL if the block is unused */
+	target_addr32_t base;
+	size_t length;
+	uint32_t last_used;
+	uint8_t data[TARGET_MEM_CACHE_BLOCK_SIZE];
+} target_mem_cache_block_s;
+
+static target_mem_cache_block_s target_mem_cache[TARGET_MEM_CACHE_BLOCK_COUNT];
+static uint32_t target_mem_cache_clock;
+
+void target_mem_cache_invalidate(void)
+{
+	for (size_t idx = 0; idx < TARGET_MEM_CACHE_BLOCK_COUNT; ++idx)
+		target_mem_cache[idx].target = NULL;
+}
+
+/* Find the RAM or Flash region the address lies in, returning false if it's in neither */
+static bool target_mem_cache_region(
+	const target_s *const target, const target_addr32_t addr, target_addr32_t *const start, size_t *const length)
+{
+	for (const target_ram_s *ram = target->ram; ram; ram = ram->next) {
+		if (addr >= ram->start && addr - ram->start < ram->length) {
+			*start = ram->start;
+			*length = ram->length;
+			return true;
+		}
+	}
+	for (const target_flash_s *flash = target->flash; flash; flash = flash->next) {
+		if (addr >= flash->start && addr - flash->start < flash->length) {
+			*start = flash->start;
+			*length = flash->length;
+			return true;
+		}
+	}
+	return false;
+}
+
+/* Get the cache block holding the address, reading it in from the target if necessary */
+static target_mem_cache_block_s *target_mem_cache_block(target_s *const target, const target_addr32_t addr)
+{
+	target_mem_cache_block_s *victim = &target_mem_cache[0];
+	for (size_t idx = 0; idx < TARGET_MEM_CACHE_BLOCK_COUNT; ++idx) {
+		target_mem_cache_block_s *const block = &target_mem_cache[idx];
+		if (block->target == target && addr >= block->base && addr - block->base < block->length) {
+			block->last_used = ++target_mem_cache_clock;
+			return block;
+		}
+		/* Keep track of the best block to evict - an unused one, else the least recently used */
+		if (victim->target && (!block->target || block->last_used < victim->last_used))
+			victim = block;
+	}
+
+	target_addr32_t region_start = 0U;
+	size_t region_length = 0U;
+	if (!target_mem_cache_region(target, addr, &region_start, &region_length))
+		return NULL;
+
+	/* Read the aligned block the address lies in, clipped to the bounds of the region */
+	const target_addr32_t block_base = addr & ~(TARGET_MEM_CACHE_BLOCK_SIZE - 1U);
+	const target_addr32_t base = MAX(block_base, region_start);
+	const uint64_t end =
+		MIN((uint64_t)block_base + TARGET_MEM_CACHE_BLOCK_SIZE, (uint64_t)region_start + region_length);
+
+	victim->target = NULL;
+	if (target_mem32_read(target, victim->data, base, (size_t)(end - base)))
+		return NULL;
+	victim->target = target;
+	victim->base = base;
+	victim->length = (size_t)(end - base);
+	victim->last_used = ++target_mem_cache_clock;
+	return victim;
+}
+
+bool target_mem32_read_cached(target_s *const target, void *const dest, const target_addr_t src, const size_t len)
+{
+	/*
+	 * Large reads gain nothing from going via the cache, and reads made during a semihosting
+	 * syscall are redirected and so must not be cached either
+	 */
+	if (len > TARGET_MEM_CACHE_BLOCK_SIZE / 2U || (target->target_options & TOPT_IN_SEMIHOSTING_SYSCALL))
+		return target_mem32_read(target, dest, src, len);
+
+	uint8_t *data = (uint8_t *)dest;
+	target_addr32_t addr = src;
+	size_t remaining = len;
+	while (remaining) {
+		const target_mem_cache_block_s *const block = target_mem_cache_block(target, addr);
+		/* If the memory is not cacheable (or could not be read as a block), go straight to the target */
+		if (!block)
+			return target_mem32_read(target, data, addr, remaining);
+		const size_t offset = addr - block->base;
+		const size_t amount = MIN(remaining, block->length - offset);
+		memcpy(data, block->data + offset, amount);
+		data += amount;
+		addr += amount;
+		remaining -= amount;
+	}
+	return false;
+}
+
+/* Have the target calculate the CRC32 of a region of its memory itself, if it is able */
+bool target_mem32_crc32(target_s *const target, uint32_t *const result, const target_addr_t base, const size_t len)
+{
+	if (target->mem_crc32)
+		return target->mem_crc32(target, result, base, len);
+	return false;
+}
+
+/*
+ * Search target memory for a pattern with a Rabin-Karp rolling hash, reading the range a block at a time.
+ * Each block is preceded in the buffer by the tail of the one before, so the hash can roll on across the
+ * boundary, and every hash match is checked against the pattern to weed out false positives.
+ * See https://yurichev.com/news/20210205_rolling_hash/ for more on the rolling hash.
+ */
+int target_mem32_search(target_s *const target, const target_addr_t start, const uint32_t length,
+	const uint8_t *const pattern, const size_t pattern_len, target_addr_t *const found)
+{
+	static const uint64_t q = 0x797a9691U; /* prime */
+	uint8_t *const buffer = alloca(pattern_len + TARGET_SEARCH_BLOCK_SIZE);
+
+	/* Hash the pattern, and precompute 256^(pattern_len - 1) % q for removing the leading byte of the window */
+	uint64_t pattern_hash = 0U;
+	uint64_t remainder = 1U;
+	for (size_t idx = 0U; idx < pattern_len; ++idx) {
+		pattern_hash = ((pattern_hash << 8U) + pattern[idx]) % q;
+		if (idx)
+			remainder = (remainder << 8U) % q;
+	}
+
+	uint64_t hash = 0U;
+	size_t carried = 0U;
+	for (uint32_t offset = 0U; offset < length;) {
+		const size_t block_len = MIN(length - offset, TARGET_SEARCH_BLOCK_SIZE);
+		if (target_mem32_read(target, buffer + pattern_len, start + offset, block_len))
+			return -1;
+		const uint8_t *const data = buffer + pattern_len - carried;
+
+		for (size_t idx = 0U; idx < block_len; ++idx) {
+			const size_t position = carried + idx;
+			/* Once the window is full, drop the byte that's falling out of it */
+			if (offset + idx >= pattern_len)
+				hash = (hash + q - (remainder * data[position - pattern_len]) % q) % q;
+			hash = ((hash << 8U) + data[position]) % q;
+			if (offset + idx + 1U >= pattern_len && hash == pattern_hash &&
+				memcmp(data + position + 1U - pattern_len, pattern, pattern_len) == 0) {
+				*found = start + offset + idx + 1U - pattern_len;
+				return 1;
+			}
+		}
+
+		/* Keep the tail of what was just searched to go in front of the next block */
+		const size_t searched = carried + block_len;
+		carried = MIN(searched, pattern_len);
+		memmove(buffer + pattern_len - carried, data + searched - carried, carried);
+		offset += block_len;
+	}
+	return 0;
+}
+
 /* Returns true if the target needs halting to access memory on it */
 bool target_mem_access_needs_halt(target_s *target)
 {
@@ -362,8 +619,59 @@ bool target_mem_access_needs_halt(target_s *target)
 }
 
 /* Register access functions */
+void target_reg_cache_invalidate(target_s *const target)
+{
+	target->reg_cache_valid = false;
+}
+
+static void target_regs_read_uncached(target_s *const target, void *const data)
+{
+	if (target->regs_read)
+		target->regs_read(target, data);
+	else {
+		for (size_t offset = 0, i = 0; offset < target->regs_size;) {
+			const size_t reg_size = target->reg_read ?
+				target->reg_read(target, i++, (uint8_t *)data + offset, target->regs_size - offset) :
+				0U;
+			/* If the target stops giving us registers, don't spin forever */
+			if (!reg_size)
+				break;
+			offset += reg_size;
+		}
+	}
+}
+
+/*
+ * Make sure the register cache holds the current register values, reading them all in one go
+ * from the target if need be. Returns false if the cache can't be used.
+ */
+static bool target_reg_cache_fill(target_s *const target)
+{
+	if (target->reg_cache_valid)
+		return true;
+	if (!target->reg_cache_stride || !target->regs_size)
+		return false;
+	if (!target->reg_cache) {
+		target->reg_cache = malloc(target->regs_size);
+		if (!target->reg_cache) { /* malloc failed: heap exhaustion */
+			DEBUG_ERROR("malloc: failed in %s\n", __func__);
+			return false;
+		}
+	}
+	target_regs_read_uncached(target, target->reg_cache);
+	/* Only trust what we just read if the target didn't report any errors doing so */
+	target->reg_cache_valid = !target_check_error(target);
+	return target->reg_cache_valid;
+}
+
 size_t target_reg_read(target_s *target, uint32_t reg, void *data, size_t max)
 {
+	const size_t stride = target->reg_cache_stride;
+	/* If the register lives in the cache, serve it from there */
+	if (stride && max >= stride && reg < target->regs_size / stride && target_reg_cache_fill(target)) {
+		memcpy(data, target->reg_cache + (reg * stride), stride);
+		return stride;
+	}
 	if (target->reg_read)
 		return target->reg_read(target, reg, data, max);
 	return 0;
@@ -371,6 +679,7 @@ size_t target_reg_read(target_s *target, uint32_t reg, void *data, size_t max)
 
 size_t target_reg_write(target_s *target, uint32_t reg, const void *data, size_t size)
 {
+	target_reg_cache_invalidate(target);
 	if (target->reg_write)
 		return target->reg_write(target, reg, data, size);
 	return 0;
@@ -378,16 +687,15 @@ size_t target_reg_write(target_s *target, uint32_t reg, const void *data, size_t
 
 void target_regs_read(target_s *target, void *data)
 {
-	if (target->regs_read)
-		target->regs_read(target, data);
-	else {
-		for (size_t offset = 0, i = 0; offset < target->regs_size;)
-			offset += target_reg_read(target, i++, (uint8_t *)data + offset, target->regs_size - offset);
-	}
+	if (target_reg_cache_fill(target))
+		memcpy(data, target->reg_cache, target->regs_size);
+	else
+		target_regs_read_uncached(target, data);
 }
 
 void target_regs_write(target_s *target, const void *data)
 {
+	target_reg_cache_invalidate(target);
 	if (target->regs_write)
 		target->regs_write(target, data);
 	else {
@@ -396,10 +704,58 @@ void target_regs_write(target_s *target, const void *data)
 	}
 }
 
+/*
+ * Build the expedited register list for a stop reply ("nn:value;" for each register the target
+ * asks to have expedited) into the buffer given. Returns how many characters were written, not
+ * counting the terminating nul, which is 0 if the target has nothing to expedite.
+ */
+size_t target_regs_expedite(target_s *const target, char *const buffer, const size_t buffer_size)
+{
+	size_t offset = 0U;
+	if (buffer_size)
+		buffer[0] = '\0';
+	const size_t stride = target->reg_cache_stride;
+	if (!target->expedite_regs_count || !target_reg_cache_fill(target))
+		return 0U;
+
+	for (size_t idx = 0; idx < target->expedite_regs_count; ++idx) {
+		const target_expedite_reg_s *const reg = &target->expedite_regs[idx];
+		/* Each entry takes 2 characters for the number, ':', 2 per byte of value and ';' */
+		const size_t entry_length = 4U + (stride * 2U);
+		if ((reg->index + 1U) * stride > target->regs_size || offset + entry_length >= buffer_size)
+			break;
+		buffer[offset++] = hex_digit(reg->gdb_regnum >> 4U);
+		buffer[offset++] = hex_digit(reg->gdb_regnum & 0xfU);
+		buffer[offset++] = ':';
+		hexify(buffer + offset, target->reg_cache + (reg->index * stride), stride);
+		offset += stride * 2U;
+		buffer[offset++] = ';';
+	}
+	buffer[offset] = '\0';
+	return offset;
+}
+
+/* Read the program counter, returns false if the target doesn't say which register that is */
+bool target_pc_read(target_s *const target, target_addr64_t *const pc)
+{
+	if (!target->pc_regnum)
+		return false;
+	uint8_t value[8U] = {0};
+	const size_t width = target_reg_read(target, target->pc_regnum, value, sizeof(value));
+	if (!width)
+		return false;
+	*pc = 0U;
+	for (size_t idx = width; idx > 0U; --idx)
+		*pc = (*pc << 8U) | value[idx - 1U];
+	return true;
+}
+
 /* Halt/resume functions */
 void target_reset(target_s *target)
 {
 	DEBUG_TARGET("Resetting target\n");
+	target_reg_cache_invalidate(target);
+	target_mem_cache_invalidate();
 	if (target->reset)
 		target->reset(target);
 }
@@ -407,6 +763,8 @@ void target_reset(target_s *target)
 void target_halt_request(target_s *target)
 {
 	DEBUG_TARGET("Halting target\n");
+	target_reg_cache_invalidate(target);
+	target_mem_cache_invalidate();
 	if (target->halt_request)
 		target->halt_request(target);
 }
@@ -439,6 +797,11 @@ target_halt_reason_e target_halt_poll(target_s *target, target_addr64_t *watch)
 {
 	if (target->halt_poll) {
 		const target_halt_reason_e reason = target->halt_poll(target, watch);
+		/* Anything cached while the target was still running is stale */
+		if (reason == TARGET_HALT_RUNNING) {
+			target_reg_cache_invalidate(target);
+			target_mem_cache_invalidate();
+		}
 #ifndef DEBUG_TARGET_IS_NOOP
 		if (reason != TARGET_HALT_RUNNING)
 			DEBUG_TARGET("Target halted: %s\n", target_halt_reason_str(reason));
@@ -452,6 +815,8 @@ target_halt_reason_e target_halt_poll(target_s *target, target_addr64_t *watch)
 void target_halt_resume(target_s *target, bool step)
 {
 	DEBUG_TARGET("%s target\n", step ? "Single stepping" : "Resuming");
+	target_reg_cache_invalidate(target);
+	target_mem_cache_invalidate();
 	if (target->halt_resume)
 		target->halt_resume(target, step);
 }
@@ -510,6 +875,14 @@ int target_breakwatch_set(target_s *target, target_breakwatch_e type, target_add
 	return ret;
 }
 
+size_t target_breakpoint_kind(target_s *const target, const target_addr_t addr)
+{
+	if (target->breakpoint_kind)
+		return target->breakpoint_kind(target, addr);
+	/* Otherwise assume a 16-bit instruction, which covers Thumb and RVC, and is ignored by the FPB */
+	return 2U;
+}
+
 int target_breakwatch_clear(target_s *target, target_breakwatch_e type, target_addr_t addr, size_t len)
 {
 	breakwatch_s *bwp = NULL;
@@ -582,14 +955,18 @@ size_t target_regs_size(target_s *target)
 
 /*
  * Get an XML description of the target's registers. Called during the attach phase when
- * GDB supplies request `qXfer:features:read:target.xml:`. The pointer returned by this call
- * must be passed to `free()` on conclusion of its use.
+ * GDB supplies request `qXfer:features:read:target.xml:`. The description is built on the
+ * first call after attaching and owned by the target, so must not be freed by the caller.
  */
-const char *target_regs_description(target_s *target)
+const char *target_regs_description(target_s *const target, size_t *const length)
 {
-	if (target->regs_description)
-		return target->regs_description(target);
-	return NULL;
+	target_xml_s *const xml = &target->regs_description_xml;
+	if (!xml->data && target->regs_description) {
+		xml->data = target->regs_description(target);
+		xml->length = xml->data ? strlen(xml->data) : 0U;
+	}
+	*length = xml->length;
+	return xml->data;
 }
 
 uint32_t target_mem32_read32(target_s *target, target_addr32_t addr)
@@ -51,6 +51,8 @@ target_flash_s *target_flash_for_addr(target_s *target, uint32_t addr)
 
 static bool target_enter_flash_mode(target_s *target)
 {
+	/* Every Flash operation comes through here, and they all change what any cached reads saw */
+	target_mem_cache_invalidate();
 	if (target->flash_mode)
 		return true;
 
@@ -69,6 +71,7 @@ static bool target_enter_flash_mode(target_s *target)
 
 static bool target_exit_flash_mode(target_s *target)
 {
+	target_mem_cache_invalidate();
 	if (!target->flash_mode)
 		return true;
 
@@ -304,6 +307,7 @@ static bool flash_buffered_write(target_flash_s *flash, target_addr_t dest, cons
 
 			/* Setup buffer */
 			flash->buf_addr_base = base_addr;
+			flash->buf_contiguous = true;
 			memset(flash->buf, flash->erased, flash->writebufsize);
 		}
 
@@ -313,10 +317,23 @@ static bool flash_buffered_write(target_flash_s *flash, target_addr_t dest, cons
 		/* Copy chunk into sector buffer */
 		memcpy(flash->buf + offset, src, local_len);
 
+		/* A write that neither touches nor overlaps what's already buffered leaves a gap of unwritten bytes */
+		if (flash->buf_addr_low < flash->buf_addr_high &&
+			(dest > flash->buf_addr_high || dest + local_len < flash->buf_addr_low))
+			flash->buf_contiguous = false;
+
 		/* This allows for writes smaller than writebufsize when flushing in the future */
 		flash->buf_addr_low = MIN(flash->buf_addr_low, dest);
 		flash->buf_addr_high = MAX(flash->buf_addr_high, dest + local_len);
 
+		/*
+		 * If the buffer has been written in full, there's no point holding on to it until the next write
+		 * comes in, so program it now
+		 */
+		if (flash->buf_contiguous && flash->buf_addr_low == base_addr &&
+			flash->buf_addr_high == base_addr + flash->writebufsize)
+			result &= flash_buffered_flush(flash);
+
 		dest += local_len;
 		src += local_len;
 		len -= local_len;
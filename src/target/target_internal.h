@@ -46,6 +46,8 @@ struct target_ram {
 	/* XXX: This needs adjusting for 64-bit operations */
 	target_addr32_t start;
 	size_t length;
+	/* Whether the core can only access this RAM as data, and not execute from it (eg, DTCM) */
+	bool data_only;
 	target_ram_s *next;
 };
 
@@ -76,6 +78,7 @@ struct target_flash {
 	target_addr32_t buf_addr_base;    /* Address of block this buffer is for */
 	target_addr32_t buf_addr_low;     /* Address of lowest byte written */
 	target_addr32_t buf_addr_high;    /* Address of highest byte written */
+	bool buf_contiguous;              /* Whether the bytes from lowest to highest were all written */
 	target_flash_s *next;             /* Next flash in list */
 };
 
@@ -121,6 +124,21 @@ struct breakwatch {
 
 typedef void (*priv_free_func)(void *flash);
 
+/*
+ * Describes a register to expedite in stop replies, mapping the register number GDB knows it by
+ * (from the target description) to its index in the regs_read() register blob
+ */
+typedef struct target_expedite_reg {
+	uint8_t gdb_regnum;
+	uint8_t index;
+} target_expedite_reg_s;
+
+/* An XML document built for GDB, kept around so it can be served in chunks without being rebuilt each time */
+typedef struct target_xml {
+	const char *data;
+	size_t length;
+} target_xml_s;
+
 struct target {
 	target_controller_s *tc;
 
@@ -132,6 +150,8 @@ struct target {
 	/* Memory access functions */
 	void (*mem_read)(target_s *target, void *dest, target_addr64_t src, size_t len);
 	void (*mem_write)(target_s *target, target_addr64_t dest, const void *src, size_t len);
+	/* Optional on-target CRC32 calculation, returns false if it could not be done so the caller can fall back */
+	bool (*mem_crc32)(target_s *target, uint32_t *result, target_addr_t base, size_t len);
 
 	/* Register access functions */
 	size_t regs_size;
@@ -140,6 +160,27 @@ struct target {
 	void (*regs_write)(target_s *target, const void *data);
 	size_t (*reg_read)(target_s *target, uint32_t reg, void *data, size_t max);
 	size_t (*reg_write)(target_s *target, uint32_t reg, const void *data, size_t size);
+	/*
+	 * Cached XML documents for GDB, built on first request. The memory map is dropped whenever a memory
+	 * region is added or removed, and both are dropped when the target is (re)attached or detached.
+	 */
+	target_xml_s mem_map_xml;
+	target_xml_s regs_description_xml;
+
+	/*
+	 * Register cache, filled from regs_read() the first time registers are asked for after a halt and
+	 * invalidated whenever the target is resumed, reset, or written to. Targets opt in by setting
+	 * reg_cache_stride to the size of each register in the regs_read() blob, which must all be the
+	 * same size and in reg_read() numbering order.
+	 */
+	uint8_t *reg_cache;
+	bool reg_cache_valid;
+	uint8_t reg_cache_stride;
+	/* Registers to send along with stop replies so GDB need not ask for them, indexes must use reg_cache_stride */
+	const target_expedite_reg_s *expedite_regs;
+	size_t expedite_regs_count;
+	/* reg_read() number of the program counter, so the generic code can tell where the target stopped (0 if unknown) */
+	uint8_t pc_regnum;
 
 	/* Halt/resume functions */
 	void (*reset)(target_s *target);
@@ -151,6 +192,7 @@ struct target {
 	/* Break-/watchpoint functions */
 	int (*breakwatch_set)(target_s *target, breakwatch_s *);
 	int (*breakwatch_clear)(target_s *target, breakwatch_s *);
+	size_t (*breakpoint_kind)(target_s *target, target_addr_t addr);
 	breakwatch_s *bw_list;
 
 	/* Recovery functions */
@@ -206,7 +248,9 @@ void target_mem_map_free(target_s *target);
 void target_add_commands(target_s *target, const command_s *cmds, const char *name);
 void target_add_ram32(target_s *target, target_addr32_t start, uint32_t len);
 void target_add_ram64(target_s *target, target_addr64_t start, uint64_t len);
+void target_add_data_ram32(target_s *target, target_addr32_t start, uint32_t len);
 void target_add_flash(target_s *target, target_flash_s *flash);
+void target_reg_cache_invalidate(target_s *target);
 
 /* No-op stub for enter flash mode */
 bool target_enter_flash_mode_stub(target_s *target);
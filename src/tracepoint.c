@@ -0,0 +1,950 @@
+/*
+ * This file is part of the Black Magic Debug project.
+ *
+ * Copyright (C) 2026 1BitSquared <info@1bitsquared.com>
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived from
+ *    this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/*
+ * This file implements GDB tracepoints. GDB defines tracepoints (with QTDP) as an address, an optional
+ * condition, and a list of registers, memory and agent expressions to collect. While the trace experiment
+ * runs, each tracepoint is a breakpoint - when one is hit, what it asks for is collected into a trace frame
+ * and the target is sent straight on its way again without GDB hearing about it. Afterwards GDB can select
+ * frames (with QTFrame, as 'tfind' does) and while one is selected register and memory reads are served
+ * from what was collected in it.
+ *
+ * Frames are kept back to back in a ring buffer. When it fills up the experiment either stops, or if GDB
+ * asked for a circular buffer, the oldest frames are dropped to make room. While-stepping actions, fast and
+ * static tracepoints and trace state variables are not supported.
+ */
+
+#include "general.h"
+#include "target.h"
+#include "target_internal.h"
+#include "gdb_packet.h"
+#include "hex_utils.h"
+#include "buffer_utils.h"
+#include "agent_expr.h"
+#include "tracepoint.h"
+
+#include <stdlib.h>
+
+/* Number of read-only memory ranges kept from QTro, these get read live when looking at a frame */
+#define TRACEPOINT_RO_RANGES 8U
+
+/* Base register number given in a memory collection action for an absolute address (-1) */
+#define TRACEPOINT_ABSOLUTE_ADDR 0xffffffffU
+
+/* Largest amount of memory recorded in a single block of a frame, as the length is 16-bit */
+#define TRACEPOINT_MAX_BLOCK 0xffffU
+
+/* Trace frame block types - the target's register blob, and a block of memory */
+#define TRACEPOINT_BLOCK_REGS   'R'
+#define TRACEPOINT_BLOCK_MEMORY 'M'
+
+/* Size of a memory block's header - the type, the 8 byte address, then the 2 byte length */
+#define TRACEPOINT_MEMORY_HEADER 11U
+
+typedef struct tracepoint_mem tracepoint_mem_s;
+
+/* A block of memory to collect, at an absolute address or relative to the value of a register */
+struct tracepoint_mem {
+	tracepoint_mem_s *next;
+	uint32_t base_reg;
+	uint64_t offset;
+	uint32_t len;
+};
+
+typedef struct tracepoint tracepoint_s;
+
+struct tracepoint {
+	tracepoint_s *next;
+	uint32_t number;
+	target_addr_t addr;
+	bool enabled;
+	/* Whether this tracepoint has a breakpoint planted for it, several at one address share one */
+	bool planted;
+	bool collect_regs;
+	/* GDB doesn't send a breakpoint kind for tracepoints, so this is what the target says to use */
+	size_t kind;
+	uint32_t pass_count;
+	uint32_t hit_count;
+	uint32_t bytes_used;
+	agent_expr_s *condition;
+	tracepoint_mem_s *mem;
+	agent_expr_s *actions;
+};
+
+typedef enum tracepoint_stop_reason {
+	TRACEPOINT_NOT_RUN,
+	TRACEPOINT_STOP_REQUEST,
+	TRACEPOINT_STOP_FULL,
+	TRACEPOINT_STOP_PASS_COUNT,
+} tracepoint_stop_reason_e;
+
+typedef struct tracepoint_range {
+	target_addr_t start;
+	target_addr_t end;
+} tracepoint_range_s;
+
+/* Each trace frame starts with this header, giving which tracepoint collected it and how long its blocks are */
+typedef struct tracepoint_frame_header {
+	uint32_t tracepoint;
+	uint32_t length;
+} tracepoint_frame_header_s;
+
+typedef struct tracepoint_experiment {
+	target_s *target;
+	tracepoint_s *tracepoints;
+	bool running;
+	tracepoint_stop_reason_e stop_reason;
+	uint32_t stop_tracepoint;
+
+	/* Ring buffer of frames - the oldest starts at head, and the frames run on for used bytes from there */
+	uint8_t *buffer;
+	size_t buffer_size;
+	size_t requested_size;
+	bool circular;
+	size_t head;
+	size_t used;
+	size_t frame_count;
+	/* How many frames a circular buffer has dropped, which is the number of the oldest frame kept */
+	uint32_t frames_dropped;
+	uint32_t frames_created;
+
+	/* The frame being collected */
+	size_t collect_start;
+	uint32_t collect_length;
+	bool collect_failed;
+
+	/* The frame GDB has selected */
+	bool frame_selected;
+	uint32_t frame_number;
+	size_t frame_offset;
+	tracepoint_frame_header_s frame_header;
+
+	tracepoint_range_s ro_ranges[TRACEPOINT_RO_RANGES];
+	size_t ro_range_count;
+} tracepoint_experiment_s;
+
+static tracepoint_experiment_s tracepoint_experiment;
+
+typedef struct tracepoint_packet_handler {
+	const char *prefix;
+	void (*func)(target_s *target, const char *packet);
+} tracepoint_packet_handler_s;
+
+/* Read a hex number of up to 64 bits, as offsets in collection actions can be wider than read_hex32() copes with */
+static bool tracepoint_read_hex64(const char *input, const char **const rest, uint64_t *const value)
+{
+	*value = 0U;
+	const char *const start = input;
+	for (; is_hex(*input) && input - start < 16; ++input)
+		*value = (*value << 4U) | unhex_digit(*input);
+	*rest = input;
+	return input != start;
+}
+
+static void tracepoint_buffer_write(size_t offset, const void *const data, size_t len)
+{
+	const uint8_t *src = (const uint8_t *)data;
+	while (len) {
+		offset %= tracepoint_experiment.buffer_size;
+		const size_t amount = MIN(len, tracepoint_experiment.buffer_size - offset);
+		memcpy(tracepoint_experiment.buffer + offset, src, amount);
+		offset += amount;
+		src += amount;
+		len -= amount;
+	}
+}
+
+static void tracepoint_buffer_read(size_t offset, void *const data, size_t len)
+{
+	uint8_t *dest = (uint8_t *)data;
+	while (len) {
+		offset %= tracepoint_experiment.buffer_size;
+		const size_t amount = MIN(len, tracepoint_experiment.buffer_size - offset);
+		memcpy(dest, tracepoint_experiment.buffer + offset, amount);
+		offset += amount;
+		dest += amount;
+		len -= amount;
+	}
+}
+
+/* Make room for len more bytes in the buffer, dropping the oldest frames if it is circular */
+static bool tracepoint_buffer_reserve(const size_t len)
+{
+	tracepoint_experiment_s *const experiment = &tracepoint_experiment;
+	while (experiment->buffer_size - experiment->used < len) {
+		if (!experiment->circular || !experiment->frame_count)
+			return false;
+		tracepoint_frame_header_s header;
+		tracepoint_buffer_read(experiment->head, &header, sizeof(header));
+		const size_t frame_size = sizeof(header) + header.length;
+		experiment->head = (experiment->head + frame_size) % experiment->buffer_size;
+		experiment->used -= frame_size;
+		--experiment->frame_count;
+		++experiment->frames_dropped;
+		/* If GDB was looking at the frame, it's gone now */
+		if (experiment->frame_selected && experiment->frame_number < experiment->frames_dropped)
+			experiment->frame_selected = false;
+	}
+	return true;
+}
+
+/* Add data to the frame being collected, marking the frame as failed if there's no room for it */
+static void tracepoint_collect_data(const void *const data, const size_t len)
+{
+	tracepoint_experiment_s *const experiment = &tracepoint_experiment;
+	if (experiment->collect_failed || !tracepoint_buffer_reserve(len)) {
+		experiment->collect_failed = true;
+		return;
+	}
+	tracepoint_buffer_write(experiment->collect_start + sizeof(tracepoint_frame_header_s) + experiment->collect_length,
+		data, len);
+	experiment->used += len;
+	experiment->collect_length += len;
+}
+
+static bool tracepoint_collect_memory(void *const context, const target_addr64_t addr, const size_t len)
+{
+	target_s *const target = (target_s *)context;
+	for (size_t offset = 0U; offset < len;) {
+		const size_t block_len = MIN(len - offset, TRACEPOINT_MAX_BLOCK);
+		uint8_t header[TRACEPOINT_MEMORY_HEADER];
+		header[0] = TRACEPOINT_BLOCK_MEMORY;
+		write_le4(header, 1U, (uint32_t)(addr + offset));
+		write_le4(header, 5U, (uint32_t)((addr + offset) >> 32U));
+		write_le2(header, 9U, (uint16_t)block_len);
+		tracepoint_collect_data(header, sizeof(header));
+
+		/* Copy the memory over in chunks, as there's nowhere to put it all at once */
+		uint8_t data[64U];
+		for (size_t chunk = 0U; chunk < block_len; chunk += sizeof(data)) {
+			const size_t amount = MIN(block_len - chunk, sizeof(data));
+			if (target_mem32_read(target, data, (target_addr_t)(addr + offset + chunk), amount))
+				memset(data, 0, amount);
+			tracepoint_collect_data(data, amount);
+		}
+		offset += block_len;
+	}
+	return !tracepoint_experiment.collect_failed;
+}
+
+static uint64_t tracepoint_reg_value(target_s *const target, const uint32_t reg)
+{
+	uint8_t data[8U] = {0};
+	const size_t width = target_reg_read(target, reg, data, sizeof(data));
+	uint64_t value = 0U;
+	for (size_t idx = width; idx > 0U; --idx)
+		value = (value << 8U) | data[idx - 1U];
+	return value;
+}
+
+static void tracepoint_stop(const tracepoint_stop_reason_e reason, const uint32_t tracepoint)
+{
+	tracepoint_experiment_s *const experiment = &tracepoint_experiment;
+	if (!experiment->running)
+		return;
+	experiment->running = false;
+	experiment->stop_reason = reason;
+	experiment->stop_tracepoint = tracepoint;
+	/* Unless the target went away, take all the tracepoints' breakpoints back out */
+	for (tracepoint_s *tp = experiment->tracepoints; tp; tp = tp->next) {
+		if (tp->planted && experiment->target)
+			target_breakwatch_clear(experiment->target, TARGET_BREAK_HARD, tp->addr, tp->kind);
+		tp->planted = false;
+	}
+	DEBUG_INFO("Trace experiment stopped after %" PRIu32 " frames\n", experiment->frames_created);
+}
+
+/* Collect a frame for a tracepoint that was just hit */
+static void tracepoint_collect(target_s *const target, tracepoint_s *const tp)
+{
+	tracepoint_experiment_s *const experiment = &tracepoint_experiment;
+	/* A tracepoint with a condition only collects anything when it's true */
+	if (tp->condition) {
+		uint64_t result = 0U;
+		if (!agent_expr_eval(target, tp->condition, &result) || !result)
+			return;
+	}
+	++tp->hit_count;
+
+	/* Start the frame off, leaving space for the header to be filled in once we know how big it is */
+	experiment->collect_failed = false;
+	experiment->collect_length = 0U;
+	if (!tracepoint_buffer_reserve(sizeof(tracepoint_frame_header_s))) {
+		tracepoint_stop(TRACEPOINT_STOP_FULL, tp->number);
+		return;
+	}
+	experiment->collect_start = (experiment->head + experiment->used) % experiment->buffer_size;
+	experiment->used += sizeof(tracepoint_frame_header_s);
+
+	if (tp->collect_regs) {
+		const size_t regs_size = target_regs_size(target);
+		uint8_t *const regs = alloca(regs_size);
+		target_regs_read(target, regs);
+		const uint8_t type = TRACEPOINT_BLOCK_REGS;
+		tracepoint_collect_data(&type, 1U);
+		tracepoint_collect_data(regs, regs_size);
+	}
+	for (const tracepoint_mem_s *mem = tp->mem; mem; mem = mem->next) {
+		target_addr64_t addr = mem->offset;
+		if (mem->base_reg != TRACEPOINT_ABSOLUTE_ADDR)
+			addr += tracepoint_reg_value(target, mem->base_reg);
+		tracepoint_collect_memory(target, addr, mem->len);
+	}
+	for (const agent_expr_s *action = tp->actions; action; action = action->next) {
+		if (!agent_expr_collect(target, action, tracepoint_collect_memory, target) && !experiment->collect_failed)
+			DEBUG_WARN("Tracepoint %" PRIu32 " action failed to run\n", tp->number);
+	}
+
+	if (experiment->collect_failed) {
+		/* The frame didn't fit, so throw away what there is of it and stop the experiment */
+		experiment->used -= sizeof(tracepoint_frame_header_s) + experiment->collect_length;
+		tracepoint_stop(TRACEPOINT_STOP_FULL, tp->number);
+		return;
+	}
+	const tracepoint_frame_header_s header = {
+		.tracepoint = tp->number,
+		.length = experiment->collect_length,
+	};
+	tracepoint_buffer_write(experiment->collect_start, &header, sizeof(header));
+	++experiment->frame_count;
+	++experiment->frames_created;
+	tp->bytes_used += sizeof(header) + header.length;
+
+	if (tp->pass_count && tp->hit_count >= tp->pass_count)
+		tracepoint_stop(TRACEPOINT_STOP_PASS_COUNT, tp->number);
+}
+
+bool tracepoint_hit(target_s *const target, target_addr_t *const addr, size_t *const kind, bool *const resume_over)
+{
+	tracepoint_experiment_s *const experiment = &tracepoint_experiment;
+	target_addr64_t pc = 0U;
+	if (!experiment->running || experiment->target != target || !target_pc_read(target, &pc))
+		return false;
+
+	bool hit = false;
+	for (tracepoint_s *tp = experiment->tracepoints; tp && experiment->running; tp = tp->next) {
+		if (tp->planted && tp->addr == pc) {
+			hit = true;
+			*kind = tp->kind;
+			tracepoint_collect(target, tp);
+		}
+	}
+	if (!hit)
+		return false;
+	*addr = (target_addr_t)pc;
+	*resume_over = experiment->running;
+	return true;
+}
+
+static void tracepoint_free(tracepoint_s *const tp)
+{
+	agent_expr_free(tp->condition);
+	agent_expr_free(tp->actions);
+	while (tp->mem) {
+		tracepoint_mem_s *const next = tp->mem->next;
+		free(tp->mem);
+		tp->mem = next;
+	}
+	free(tp);
+}
+
+/* Throw away the tracepoints and any frames collected, ready for a new experiment */
+static void tracepoint_reset(void)
+{
+	tracepoint_experiment_s *const experiment = &tracepoint_experiment;
+	tracepoint_stop(TRACEPOINT_STOP_REQUEST, 0U);
+	while (experiment->tracepoints) {
+		tracepoint_s *const next = experiment->tracepoints->next;
+		tracepoint_free(experiment->tracepoints);
+		experiment->tracepoints = next;
+	}
+	free(experiment->buffer);
+	const size_t requested_size = experiment->requested_size;
+	const bool circular = experiment->circular;
+	memset(experiment, 0, sizeof(*experiment));
+	/* The buffer settings outlive the experiment, as GDB only sends them when they change */
+	experiment->requested_size = requested_size;
+	experiment->circular = circular;
+}
+
+void tracepoint_target_destroyed(const target_s *const target)
+{
+	if (tracepoint_experiment.target != target)
+		return;
+	/* The breakpoints went with the target, so make sure nothing tries to take them out */
+	tracepoint_experiment.target = NULL;
+	tracepoint_reset();
+}
+
+static tracepoint_s *tracepoint_find(const uint32_t number, const target_addr_t addr)
+{
+	for (tracepoint_s *tp = tracepoint_experiment.tracepoints; tp; tp = tp->next) {
+		if (tp->number == number && tp->addr == addr)
+			return tp;
+	}
+	return NULL;
+}
+
+/* Parse the actions in a "QTDP:-n:addr:actions" packet, these come concatenated together */
+static bool tracepoint_parse_actions(tracepoint_s *const tp, const char *actions)
+{
+	/* While-stepping actions are marked with a leading 'S', and need single-stepping we don't do */
+	if (*actions == 'S')
+		return false;
+	while (*actions && *actions != '-') {
+		switch (*actions) {
+		case 'R':
+			/* We always collect the whole register set, so the mask of which ones doesn't matter */
+			tp->collect_regs = true;
+			for (++actions; is_hex(*actions); ++actions)
+				continue;
+			break;
+		case 'M': {
+			/* 'M basereg,offset,len' */
+			uint32_t base_reg = 0U;
+			uint64_t offset = 0U;
+			uint32_t len = 0U;
+			if (!read_hex32(actions + 1U, &actions, &base_reg, ',') ||
+				!tracepoint_read_hex64(actions, &actions, &offset) || *actions++ != ',' ||
+				!read_hex32(actions, &actions, &len, READ_HEX_NO_FOLLOW))
+				return false;
+			tracepoint_mem_s *const mem = malloc(sizeof(*mem));
+			if (!mem) { /* malloc failed: heap exhaustion */
+				DEBUG_ERROR("malloc: failed in %s\n", __func__);
+				return false;
+			}
+			mem->next = tp->mem;
+			mem->base_reg = base_reg;
+			mem->offset = offset;
+			mem->len = len;
+			tp->mem = mem;
+			break;
+		}
+		case 'X': {
+			/* 'X len,expr' */
+			agent_expr_s *const action = agent_expr_parse(actions + 1U, &actions);
+			if (!action)
+				return false;
+			agent_expr_s **tail = &tp->actions;
+			while (*tail)
+				tail = &(*tail)->next;
+			*tail = action;
+			break;
+		}
+		default:
+			return false;
+		}
+	}
+	return true;
+}
+
+/* 'QTDP:n:addr:ena:step:pass[:Xlen,cond][-]' defines a tracepoint, 'QTDP:-n:addr:actions[-]' adds actions to it */
+static void tracepoint_define(target_s *const target, const char *packet)
+{
+	tracepoint_experiment_s *const experiment = &tracepoint_experiment;
+	const bool add_actions = *packet == '-';
+	if (add_actions)
+		++packet;
+	uint32_t number = 0U;
+	uint32_t addr = 0U;
+	if (!target || !read_hex32(packet, &packet, &number, ':') || !read_hex32(packet, &packet, &addr, ':')) {
+		gdb_put_packet_error(1U);
+		return;
+	}
+
+	if (add_actions) {
+		tracepoint_s *const tp = tracepoint_find(number, addr);
+		if (tp && tracepoint_parse_actions(tp, packet))
+			gdb_put_packet_ok();
+		else
+			gdb_put_packet_error(1U);
+		return;
+	}
+
+	const char enable = *packet;
+	uint32_t step_count = 0U;
+	uint32_t pass_count = 0U;
+	if ((enable != 'E' && enable != 'D') || packet[1] != ':' || !read_hex32(packet + 2U, &packet, &step_count, ':') ||
+		!read_hex32(packet, &packet, &pass_count, READ_HEX_NO_FOLLOW) || step_count) {
+		gdb_put_packet_error(1U);
+		return;
+	}
+	agent_expr_s *condition = NULL;
+	/* The only optional part we understand is a condition, fast and static tracepoints aren't supported */
+	if (packet[0] == ':') {
+		if (packet[1] != 'X' || !(condition = agent_expr_parse(packet + 2U, &packet))) {
+			gdb_put_packet_error(1U);
+			return;
+		}
+	}
+	if (*packet && *packet != '-') {
+		agent_expr_free(condition);
+		gdb_put_packet_error(1U);
+		return;
+	}
+
+	tracepoint_s *const tp = calloc(1U, sizeof(*tp));
+	if (!tp) { /* calloc failed: heap exhaustion */
+		DEBUG_ERROR("calloc: failed in %s\n", __func__);
+		agent_expr_free(condition);
+		gdb_put_packet_error(1U);
+		return;
+	}
+	tp->number = number;
+	tp->addr = addr;
+	tp->enabled = enable == 'E';
+	tp->pass_count = pass_count;
+	tp->condition = condition;
+	/* Keep the tracepoints in the order GDB defines them in, so they collect in that order too */
+	tracepoint_s **tail = &experiment->tracepoints;
+	while (*tail)
+		tail = &(*tail)->next;
+	*tail = tp;
+	experiment->target = target;
+	gdb_put_packet_ok();
+}
+
+static void tracepoint_init(target_s *const target, const char *const packet)
+{
+	(void)packet;
+	tracepoint_reset();
+	tracepoint_experiment.target = target;
+	gdb_put_packet_ok();
+}
+
+static void tracepoint_start(target_s *const target, const char *const packet)
+{
+	(void)packet;
+	tracepoint_experiment_s *const experiment = &tracepoint_experiment;
+	if (!target || experiment->target != target) {
+		gdb_put_packet_error(1U);
+		return;
+	}
+	tracepoint_stop(TRACEPOINT_STOP_REQUEST, 0U);
+
+	/* Set up a fresh buffer for the frames */
+	const size_t buffer_size = experiment->requested_size ? experiment->requested_size : TRACEPOINT_BUFFER_SIZE;
+	if (experiment->buffer_size != buffer_size) {
+		free(experiment->buffer);
+		experiment->buffer_size = 0U;
+		experiment->buffer = malloc(buffer_size);
+		if (!experiment->buffer) { /* malloc failed: heap exhaustion */
+			DEBUG_ERROR("malloc: failed in %s\n", __func__);
+			gdb_put_packet_error(1U);
+			return;
+		}
+		experiment->buffer_size = buffer_size;
+	}
+	experiment->head = 0U;
+	experiment->used = 0U;
+	experiment->frame_count = 0U;
+	experiment->frames_dropped = 0U;
+	experiment->frames_created = 0U;
+	experiment->frame_selected = false;
+
+	/* Plant a breakpoint for every enabled tracepoint, sharing them between tracepoints on the same address */
+	experiment->running = true;
+	for (tracepoint_s *tp = experiment->tracepoints; tp; tp = tp->next) {
+		tp->hit_count = 0U;
+		tp->bytes_used = 0U;
+		if (!tp->enabled)
+			continue;
+		tp->kind = target_breakpoint_kind(target, tp->addr);
+		bool shared = false;
+		for (const tracepoint_s *other = experiment->tracepoints; other != tp; other = other->next)
+			shared |= other->planted && other->addr == tp->addr;
+		if (!shared && target_breakwatch_set(target, TARGET_BREAK_HARD, tp->addr, tp->kind) != 0) {
+			DEBUG_ERROR("Could not plant tracepoint %" PRIu32 " at 0x%08" PRIx32 "\n", tp->number, tp->addr);
+			tracepoint_stop(TRACEPOINT_STOP_REQUEST, 0U);
+			gdb_put_packet_error(1U);
+			return;
+		}
+		tp->planted = true;
+	}
+	gdb_put_packet_ok();
+}
+
+static void tracepoint_stop_request(target_s *const target, const char *const packet)
+{
+	(void)target;
+	(void)packet;
+	tracepoint_stop(TRACEPOINT_STOP_REQUEST, 0U);
+	gdb_put_packet_ok();
+}
+
+/* Find the frame with the given index into the buffer, returning false if there aren't that many */
+static bool tracepoint_frame_find(const size_t index, size_t *const offset, tracepoint_frame_header_s *const header)
+{
+	const tracepoint_experiment_s *const experiment = &tracepoint_experiment;
+	if (index >= experiment->frame_count)
+		return false;
+	*offset = experiment->head;
+	for (size_t frame = 0U;; ++frame) {
+		tracepoint_buffer_read(*offset, header, sizeof(*header));
+		if (frame == index)
+			return true;
+		*offset = (*offset + sizeof(*header) + header->length) % experiment->buffer_size;
+	}
+}
+
+static target_addr_t tracepoint_frame_pc(const tracepoint_frame_header_s *const header)
+{
+	for (const tracepoint_s *tp = tracepoint_experiment.tracepoints; tp; tp = tp->next) {
+		if (tp->number == header->tracepoint)
+			return tp->addr;
+	}
+	return 0U;
+}
+
+/*
+ * 'QTFrame:n' selects frame n, while 'QTFrame:pc:addr', 'QTFrame:tdp:t', 'QTFrame:range:start:end' and
+ * 'QTFrame:outside:start:end' select the next frame after the current one that matches
+ */
+static void tracepoint_frame_select(target_s *const target, const char *const packet)
+{
+	(void)target;
+	tracepoint_experiment_s *const experiment = &tracepoint_experiment;
+	enum {
+		FRAME_NUMBER,
+		FRAME_PC,
+		FRAME_TRACEPOINT,
+		FRAME_RANGE,
+		FRAME_OUTSIDE,
+	} search = FRAME_NUMBER;
+	const char *rest = packet;
+	if (!strncmp(packet, "pc:", 3U)) {
+		search = FRAME_PC;
+		rest += 3U;
+	} else if (!strncmp(packet, "tdp:", 4U)) {
+		search = FRAME_TRACEPOINT;
+		rest += 4U;
+	} else if (!strncmp(packet, "range:", 6U)) {
+		search = FRAME_RANGE;
+		rest += 6U;
+	} else if (!strncmp(packet, "outside:", 8U)) {
+		search = FRAME_OUTSIDE;
+		rest += 8U;
+	}
+
+	uint32_t start = 0U;
+	uint32_t end = 0U;
+	const bool parsed = search == FRAME_RANGE || search == FRAME_OUTSIDE ?
+		read_hex32(rest, &rest, &start, ':') && read_hex32(rest, NULL, &end, READ_HEX_NO_FOLLOW) :
+		read_hex32(rest, NULL, &start, READ_HEX_NO_FOLLOW);
+	if (!parsed || !experiment->buffer) {
+		gdb_put_packet_error(1U);
+		return;
+	}
+
+	size_t index = 0U;
+	if (search == FRAME_NUMBER) {
+		/* Frame -1 is GDB going back to looking at the target */
+		index = start - experiment->frames_dropped;
+		if (start < experiment->frames_dropped)
+			index = SIZE_MAX;
+	} else if (experiment->frame_selected)
+		index = (experiment->frame_number - experiment->frames_dropped) + 1U;
+
+	size_t offset = 0U;
+	tracepoint_frame_header_s header;
+	for (; tracepoint_frame_find(index, &offset, &header); ++index) {
+		const target_addr_t pc = tracepoint_frame_pc(&header);
+		if (search == FRAME_NUMBER || (search == FRAME_PC && pc == start) ||
+			(search == FRAME_TRACEPOINT && header.tracepoint == start) ||
+			(search == FRAME_RANGE && pc >= start && pc <= end) ||
+			(search == FRAME_OUTSIDE && (pc < start || pc > end))) {
+			experiment->frame_selected = true;
+			experiment->frame_number = experiment->frames_dropped + (uint32_t)index;
+			experiment->frame_offset = offset;
+			experiment->frame_header = header;
+			gdb_putpacket_str_f("F%" PRIx32 "T%" PRIx32, experiment->frame_number, header.tracepoint);
+			return;
+		}
+	}
+	experiment->frame_selected = false;
+	gdb_put_packet_str("F-1");
+}
+
+/* 'QTro:start,end[:start,end...]' gives the read-only ranges, which can be read live when looking at a frame */
+static void tracepoint_read_only(target_s *const target, const char *packet)
+{
+	(void)target;
+	tracepoint_experiment_s *const experiment = &tracepoint_experiment;
+	experiment->ro_range_count = 0U;
+	while (*packet == ':' && experiment->ro_range_count < TRACEPOINT_RO_RANGES) {
+		tracepoint_range_s *const range = &experiment->ro_ranges[experiment->ro_range_count];
+		if (!read_hex32(packet + 1U, &packet, &range->start, ',') ||
+			!read_hex32(packet, &packet, &range->end, READ_HEX_NO_FOLLOW))
+			break;
+		++experiment->ro_range_count;
+	}
+	gdb_put_packet_ok();
+}
+
+/* 'QTBuffer:circular:n' and 'QTBuffer:size:n' configure the buffer, a size of -1 meaning the default */
+static void tracepoint_buffer_config(target_s *const target, const char *const packet)
+{
+	(void)target;
+	tracepoint_experiment_s *const experiment = &tracepoint_experiment;
+	uint32_t value = 0U;
+	if (!strncmp(packet, "circular:", 9U) && read_hex32(packet + 9U, NULL, &value, READ_HEX_NO_FOLLOW)) {
+		experiment->circular = value != 0U;
+		gdb_put_packet_ok();
+	} else if (!strncmp(packet, "size:", 5U)) {
+		if (packet[5] == '-')
+			experiment->requested_size = 0U;
+		else if (read_hex32(packet + 5U, NULL, &value, READ_HEX_NO_FOLLOW) && value &&
+			value <= TRACEPOINT_BUFFER_SIZE)
+			experiment->requested_size = value;
+		else {
+			gdb_put_packet_error(1U);
+			return;
+		}
+		gdb_put_packet_ok();
+	} else
+		gdb_put_packet_empty();
+}
+
+/* Settings we accept but that make no difference to us */
+static void tracepoint_ignored(target_s *const target, const char *const packet)
+{
+	(void)target;
+	(void)packet;
+	gdb_put_packet_ok();
+}
+
+static const tracepoint_packet_handler_s tracepoint_set_handlers[] = {
+	{"init", tracepoint_init},
+	{"DP:", tracepoint_define},
+	{"Start", tracepoint_start},
+	{"Stop", tracepoint_stop_request},
+	{"Frame:", tracepoint_frame_select},
+	{"ro", tracepoint_read_only},
+	{"Buffer:", tracepoint_buffer_config},
+	{"Disconnected:", tracepoint_ignored},
+	{"Notes:", tracepoint_ignored},
+	{NULL, NULL},
+};
+
+static void tracepoint_status(target_s *const target, const char *const packet)
+{
+	(void)target;
+	(void)packet;
+	const tracepoint_experiment_s *const experiment = &tracepoint_experiment;
+	char reason[24U];
+	switch (experiment->running ? TRACEPOINT_NOT_RUN : experiment->stop_reason) {
+	case TRACEPOINT_STOP_REQUEST:
+		snprintf(reason, sizeof(reason), "tstop:0");
+		break;
+	case TRACEPOINT_STOP_FULL:
+		snprintf(reason, sizeof(reason), "tfull:0");
+		break;
+	case TRACEPOINT_STOP_PASS_COUNT:
+		snprintf(reason, sizeof(reason), "tpasscount:%" PRIx32, experiment->stop_tracepoint);
+		break;
+	default:
+		snprintf(reason, sizeof(reason), "tnotrun:0");
+		break;
+	}
+	const size_t buffer_size = experiment->buffer ? experiment->buffer_size :
+		experiment->requested_size                ? experiment->requested_size :
+													TRACEPOINT_BUFFER_SIZE;
+	gdb_putpacket_str_f("T%u;%s;tframes:%zx;tcreated:%" PRIx32 ";tfree:%zx;tsize:%zx;circular:%u;disconn:0",
+		experiment->running ? 1U : 0U, reason, experiment->frame_count, experiment->frames_created,
+		buffer_size - experiment->used, buffer_size, experiment->circular ? 1U : 0U);
+}
+
+/* 'qTP:t:addr' asks after a tracepoint, which we answer with its hit count and how much buffer it has used */
+static void tracepoint_info(target_s *const target, const char *packet)
+{
+	(void)target;
+	uint32_t number = 0U;
+	uint32_t addr = 0U;
+	const tracepoint_s *tp = NULL;
+	if (read_hex32(packet, &packet, &number, ':') && read_hex32(packet, NULL, &addr, READ_HEX_NO_FOLLOW))
+		tp = tracepoint_find(number, addr);
+	if (tp)
+		gdb_putpacket_str_f("V%" PRIx32 ":%" PRIx32, tp->hit_count, tp->bytes_used);
+	else
+		gdb_put_packet_empty();
+}
+
+/* GDB asks for any tracepoints and trace state variables to upload, there are never any it doesn't know about */
+static void tracepoint_upload(target_s *const target, const char *const packet)
+{
+	(void)target;
+	(void)packet;
+	gdb_put_packet_str("l");
+}
+
+static const tracepoint_packet_handler_s tracepoint_query_handlers[] = {
+	{"Status", tracepoint_status},
+	{"P:", tracepoint_info},
+	{"fP", tracepoint_upload},
+	{"sP", tracepoint_upload},
+	{"fV", tracepoint_upload},
+	{"sV", tracepoint_upload},
+	{NULL, NULL},
+};
+
+static void tracepoint_dispatch(
+	const tracepoint_packet_handler_s *handler, target_s *const target, const char *const packet)
+{
+	for (; handler->prefix; ++handler) {
+		const size_t prefix_length = strlen(handler->prefix);
+		if (!strncmp(packet, handler->prefix, prefix_length)) {
+			handler->func(target, packet + prefix_length);
+			return;
+		}
+	}
+	DEBUG_GDB("*** Unsupported tracepoint packet: %s\n", packet);
+	gdb_put_packet_empty();
+}
+
+void tracepoint_set_packet(target_s *const target, const char *const packet, const size_t length)
+{
+	(void)length;
+	tracepoint_dispatch(tracepoint_set_handlers, target, packet);
+}
+
+void tracepoint_query_packet(target_s *const target, const char *const packet, const size_t length)
+{
+	(void)length;
+	tracepoint_dispatch(tracepoint_query_handlers, target, packet);
+}
+
+bool tracepoint_frame_selected(void)
+{
+	return tracepoint_experiment.frame_selected;
+}
+
+/* Find a block of the given type in the selected frame, returning the offset of its data */
+static bool tracepoint_frame_block(const uint8_t type, size_t *const data_offset, size_t index)
+{
+	const tracepoint_experiment_s *const experiment = &tracepoint_experiment;
+	const size_t regs_size = experiment->target ? target_regs_size(experiment->target) : 0U;
+	size_t position = 0U;
+	while (position < experiment->frame_header.length) {
+		const size_t offset = experiment->frame_offset + sizeof(tracepoint_frame_header_s) + position;
+		uint8_t header[TRACEPOINT_MEMORY_HEADER];
+		tracepoint_buffer_read(offset, header, 1U);
+		size_t length = 1U;
+		if (header[0] == TRACEPOINT_BLOCK_REGS)
+			length += regs_size;
+		else {
+			tracepoint_buffer_read(offset, header, sizeof(header));
+			length = sizeof(header) + read_le2(header, 9U);
+		}
+		if (header[0] == type && !index--) {
+			*data_offset = offset;
+			return true;
+		}
+		position += length;
+	}
+	return false;
+}
+
+void tracepoint_frame_regs_read(target_s *const target, char *const hex)
+{
+	const size_t regs_size = target_regs_size(target);
+	size_t offset = 0U;
+	if (tracepoint_frame_block(TRACEPOINT_BLOCK_REGS, &offset, 0U)) {
+		uint8_t *const regs = alloca(regs_size);
+		tracepoint_buffer_read(offset + 1U, regs, regs_size);
+		hexify(hex, regs, regs_size);
+		hex[regs_size * 2U] = '\0';
+		return;
+	}
+	/* No registers were collected, but we do know the PC is at the tracepoint */
+	memset(hex, 'x', regs_size * 2U);
+	hex[regs_size * 2U] = '\0';
+	const size_t stride = target->reg_cache_stride;
+	if (stride == sizeof(uint32_t) && target->pc_regnum && (target->pc_regnum + 1U) * stride <= regs_size) {
+		const uint32_t pc = tracepoint_frame_pc(&tracepoint_experiment.frame_header);
+		hexify(hex + (target->pc_regnum * stride * 2U), &pc, stride);
+	}
+}
+
+void tracepoint_frame_reg_read(target_s *const target, const uint32_t reg, char *const hex, const size_t hex_size)
+{
+	const size_t regs_size = target_regs_size(target);
+	const size_t stride = target->reg_cache_stride ? target->reg_cache_stride : sizeof(uint32_t);
+	const size_t width = MIN(stride, (hex_size - 1U) / 2U);
+	/* Only targets that keep their register blob in register number order can have one picked out of it */
+	size_t offset = 0U;
+	if (target->reg_cache_stride && (reg + 1U) * stride <= regs_size &&
+		tracepoint_frame_block(TRACEPOINT_BLOCK_REGS, &offset, 0U)) {
+		uint8_t value[8U];
+		tracepoint_buffer_read(offset + 1U + (reg * stride), value, width);
+		hexify(hex, value, width);
+	} else if (reg == target->pc_regnum && width == sizeof(uint32_t)) {
+		const uint32_t pc = tracepoint_frame_pc(&tracepoint_experiment.frame_header);
+		hexify(hex, &pc, width);
+	} else
+		memset(hex, 'x', width * 2U);
+	hex[width * 2U] = '\0';
+}
+
+bool tracepoint_frame_mem_read(target_s *const target, void *const dest, const target_addr_t src, const size_t len)
+{
+	const tracepoint_experiment_s *const experiment = &tracepoint_experiment;
+	uint8_t *const data = (uint8_t *)dest;
+	/* Work through the range, piecing it together from the memory blocks collected */
+	for (size_t position = 0U; position < len;) {
+		const target_addr64_t addr = src + position;
+		size_t amount = 0U;
+		size_t offset = 0U;
+		for (size_t index = 0U; !amount && tracepoint_frame_block(TRACEPOINT_BLOCK_MEMORY, &offset, index); ++index) {
+			uint8_t header[TRACEPOINT_MEMORY_HEADER];
+			tracepoint_buffer_read(offset, header, sizeof(header));
+			const target_addr64_t block_addr = read_le4(header, 1U) | ((target_addr64_t)read_le4(header, 5U) << 32U);
+			const size_t block_len = read_le2(header, 9U);
+			if (addr < block_addr || addr >= block_addr + block_len)
+				continue;
+			amount = MIN(len - position, (size_t)(block_addr + block_len - addr));
+			tracepoint_buffer_read(offset + sizeof(header) + (size_t)(addr - block_addr), data + position, amount);
+		}
+		/* Anything not collected can still be read from the target if it's read-only, as it can't have changed */
+		for (size_t idx = 0U; !amount && idx < experiment->ro_range_count; ++idx) {
+			const tracepoint_range_s *const range = &experiment->ro_ranges[idx];
+			if (addr < range->start || addr >= range->end)
+				continue;
+			amount = MIN(len - position, (size_t)(range->end - addr));
+			if (target_mem32_read(target, data + position, (target_addr_t)addr, amount))
+				return true;
+		}
+		if (!amount)
+			return true;
+		position += amount;
+	}
+	return false;
+}